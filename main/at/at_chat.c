@@ -26,6 +26,10 @@
 #include "at_chat.h"
 #include "at_port.h"
 #include "linux_list.h"
+#if AT_POOL_EN
+#include "at_pool.h"
+#endif
+#include <ctype.h>
 #include <stdarg.h>
 #include <string.h>
 #include <stdio.h>
@@ -47,6 +51,13 @@
 
 #define AT_IS_TIMEOUT(start, time) (at_get_ms() - (start) > (time))
 
+// URC end mark test ('\0' is data, not an end mark).
+#define IS_URC_END_MARK(ch) (memchr(AT_URC_END_MARKS, (ch), sizeof(AT_URC_END_MARKS) - 1) != NULL)
+
+// Wait time before resending a command that responded with an error (ms), until its 
+// response time has been estimated.
+#define AT_RETRY_DELAY 100
+
 /**AT work type (corresponding to different state machine polling handler.) */
 typedef enum
 {
@@ -56,6 +67,8 @@ typedef enum
     WORK_TYPE_CMD,         /* Standard command */
     WORK_TYPE_CUSTOM,      /* Custom command */
     WORK_TYPE_BUF,         /* Buffer */
+    WORK_TYPE_COROUTINE,   /* Coroutine work */
+    WORK_TYPE_PAYLOAD,     /* Prompt command followed by a payload */
     WORK_TYPE_MAX
 } work_type;
 
@@ -67,6 +80,9 @@ typedef enum
     AT_STAT_SEND = 0,
     AT_STAT_RECV,
     AT_STAT_RETRY,
+    AT_STAT_URC,     /* Waiting for the result URC*/
+    AT_STAT_PROMPT,  /* Waiting for the payload prompt*/
+    AT_STAT_PAYLOAD, /* Writing the payload*/
 } at_cmd_state;
 
 /**
@@ -76,6 +92,17 @@ typedef enum
 #define MATCH_MASK_SUFFIX 0x02
 #define MATCH_MASK_ERROR 0x04
 
+/**
+ * @brief Resumable substring matcher (the matching state is kept across received chunks).
+ */
+typedef struct
+{
+    const char *pat;    /* Pattern to be matched*/
+    unsigned short len; /* Pattern length*/
+    unsigned short cnt; /* Number of pattern characters currently matched*/
+    unsigned short *fail; /* KMP failure function, fail[q - 1]: border of pat[0..q) (in match_table)*/
+} str_matcher_t;
+
 /**
  * @brief AT work item object
  */
@@ -85,10 +112,18 @@ typedef struct
     at_attr_t attr;          /* AT attributes */
     unsigned int magic : 16; /* AT magic*/
     unsigned int state : 3;  /* State of work */
-    unsigned int type : 3;   /* Type of work */
+    unsigned int type : 4;   /* Type of work */
     unsigned int code : 3;   /* Response code*/
-    unsigned int life : 6;   /* Life cycle countdown(s)*/
+    unsigned int life : 5;   /* Life cycle countdown(s)*/
     unsigned int dirty : 1;  /* Dirty flag*/
+    unsigned int enqueue_time; /* Submission time (ms)*/
+    unsigned short seq;      /* Submission sequence number*/
+#if AT_CACHE_EN
+    unsigned short cache;    /* Index + 1 of the cache entry of the query (0: not cached)*/
+#endif
+#if AT_SYNC_EN
+    struct at_sync *sync;    /* Blocking request waiting for the result, NULL if none*/
+#endif
     union
     {
         const void *info;
@@ -104,6 +139,142 @@ typedef struct
     };
 } work_item_t;
 
+#if AT_PAYLOAD_EN
+/**
+ * @brief Payload of a prompt command, stored at the start of the buffer of its work item and
+ *        followed by the command line (and by the payload when it is copied).
+ */
+typedef struct
+{
+    const void *data;              /* Borrowed payload, NULL: copied after the command line*/
+    unsigned int len;              /* Payload length*/
+    unsigned short prompt_timeout; /* Prompt timeout (ms)*/
+} payload_info_t;
+
+/**
+ * @brief  Get the payload information of a prompt command (the buffer is not aligned).
+ */
+static inline void payload_info(const work_item_t *wi, payload_info_t *pi)
+{
+    memcpy(pi, wi->buf, sizeof(*pi));
+}
+
+/**
+ * @brief  Get the command line of a prompt command.
+ */
+static inline const char *payload_line(const work_item_t *wi)
+{
+    return wi->buf + sizeof(payload_info_t);
+}
+
+/**
+ * @brief  Get the payload of a prompt command.
+ */
+static inline const char *payload_data(const work_item_t *wi, const payload_info_t *pi)
+{
+    const char *line = payload_line(wi);
+    return pi->data != NULL ? (const char *)pi->data : line + strlen(line) + 1;
+}
+#endif
+
+#if AT_RAW_TRANSPARENT_EN
+/**
+ * @brief Data pending in one direction of the transparent transmission.
+ */
+typedef struct
+{
+    unsigned char *buf;
+    unsigned int off, len;
+} raw_pipe_t;
+
+// Exit command matching state: the current line no longer matches.
+#define RAW_EXIT_MISMATCH 0xFFFF
+#endif
+
+#if AT_URC_WARCH_EN && AT_URC_MATCHER_EN
+/**
+ * @brief URC matcher automaton node (Aho-Corasick trie node).
+ */
+typedef struct
+{
+    unsigned short child;   /* First child node (0: none)*/
+    unsigned short sibling; /* Next sibling node (0: none)*/
+    unsigned short fail;    /* Failure link*/
+    unsigned short out;     /* Index + 1 of the first URC item matched in this state (0: none)*/
+    unsigned char ch;       /* Input character leading to this node*/
+} urc_node_t;
+#endif
+
+#if AT_STATS_EN
+/**
+ * @brief Statistics entry of a command name.
+ */
+typedef struct
+{
+    at_cmd_stats_t info;
+    unsigned int hist[AT_STATS_KIND_MAX][AT_STATS_BUCKETS];
+} stats_entry_t;
+
+// Log-linear histogram: 2^STATS_SUB_BITS linear buckets per power of two.
+#define STATS_SUB_BITS 2
+#define STATS_SUB_COUNT (1u << STATS_SUB_BITS)
+#endif
+
+#if AT_RTO_EN
+/**
+ * @brief Response time estimator of a command name.
+ */
+typedef struct
+{
+    at_rto_info_t info;
+    unsigned int srtt8;   /* Smoothed response time, scaled by 8*/
+    unsigned int rttvar4; /* Response time variation, scaled by 4*/
+} rto_entry_t;
+
+/**
+ * @brief Response time estimators of an AT object.
+ */
+typedef struct
+{
+    unsigned int min;    /* Bounds of the adaptive timeouts (ms)*/
+    unsigned int max;    /* (0: static timeouts)*/
+    unsigned short used; /* Number of estimators in use*/
+    rto_entry_t entry[AT_RTO_CMD_COUNT];
+} rto_table_t;
+#endif
+
+#if AT_CACHE_EN
+/**
+ * @brief Cache entry of a query command (one per rule).
+ */
+typedef struct
+{
+    const at_cache_rule_t *rule;
+    const char *prefix;      /* Response prefix of the query in flight*/
+    const char *suffix;      /* Response suffix of the query in flight*/
+    struct list_head joins;  /* Work joined to the query in flight*/
+    unsigned int time;       /* Time the response was stored (ms)*/
+    unsigned short len;      /* Length of the stored response*/
+    unsigned char code;      /* Response code of the stored response*/
+    unsigned char fresh : 1; /* The stored response can answer queries (within its TTL)*/
+    unsigned char pending : 1; /* The query is in flight*/
+    unsigned char shared : 1;  /* The last response was stored, it is shared with the joined work*/
+    char buf[AT_CACHE_RESP_SIZE];
+} cache_entry_t;
+
+/**
+ * @brief Response cache (allocated by at_obj_set_cache, so that it takes no room in the AT 
+ *        objects without a cache).
+ */
+typedef struct
+{
+    struct list_head hits; /* Work answered from the cache, delivered on the next cycle*/
+    at_cache_stat_t stat;
+    int count;             /* Number of entries*/
+    cache_entry_t entry[0];
+} cache_t;
+#endif
+
 /**
  * @brief AT Object infomation.
  */
@@ -112,8 +283,9 @@ typedef struct
     at_obj_t obj;                  /* Inherit at_obj*/
     at_env_t env;                  /* Public work environment*/
     work_item_t *cursor;           /* Currently running work*/
-    struct list_head hlist, llist; /* High and low priority queue*/
-    struct list_head *clist;       /* Queue currently in use*/
+    struct list_head queues[AT_PRIORITY_LEVELS]; /* Work queue of each priority level (AT task only)*/
+    struct list_head *inbox;       /* Submitted work not queued yet (lock-free stack, newest first)*/
+    unsigned int aging;            /* Priority aging interval (ms, 0: no aging)*/
     unsigned int timer;            /* General purpose timer*/
     unsigned int next_delay;       /* Next cycle delay time*/
     unsigned int delay_timer;      /* Delay timer*/
@@ -128,20 +300,83 @@ typedef struct
     unsigned short urc_bufsize;
     unsigned short urc_cnt;
     unsigned short urc_target; /* The target data length of the current URC frame*/
+    unsigned int urc_remain;   /* Payload bytes still to be streamed to the data handler*/
+    unsigned int urc_skip;     /* Bytes to discard before the streamed payload*/
     unsigned short urc_tbl_size;
     unsigned short urc_disable_time;
+#if AT_URC_MATCHER_EN
+    urc_node_t *urc_nodes;     /* URC matcher automaton (NULL: linear scan)*/
+    unsigned short urc_state;  /* Current automaton state*/
+    unsigned short urc_hit;    /* Index + 1 of the first URC item matched in the current frame*/
+#endif
+#endif
+#if AT_COROUTINE_EN
+    unsigned int co_start;     /* Time the awaited command was first sent (ms)*/
 #endif
-    unsigned short list_cnt;
+#if AT_RAW_TRANSPARENT_EN
+    unsigned char *raw_buf;     /* Transparent transmission buffer (one half per direction)*/
+    unsigned int raw_half;      /* Size of each half*/
+    unsigned short raw_exit_cnt;/* Exit command characters matched in the current line*/
+    raw_pipe_t raw_rx, raw_tx;  /* Modem -> host and host -> modem pending data*/
+#endif
+    char *rxbuf;               /* Caller-provided ingest buffer (NULL: AT_RX_CHUNK_SIZE on the stack)*/
+    unsigned int rxbuf_size;
+    unsigned short list_cnt;  /* Work submitted and not recycled yet*/
+    unsigned short submit_seq;/* Next submission sequence number*/
+    unsigned short abort_seq; /* Work submitted before this number is to be aborted*/
+    unsigned short abort_done;/* abort_seq applied by the AT task*/
     unsigned short recv_bufsize;
     unsigned short recv_cnt;  /* Command response receives counter*/
-    unsigned short match_len; /* Response information matching length*/
+    unsigned short match_len; /* Response information matching length (resume offset)*/
+    unsigned short resp_timeout; /* Response timeout of the command line sent last (ms)*/
+    unsigned short retry_delay;  /* Wait before resending it after an error response (ms)*/
+    unsigned int recv_dropped; /* Response bytes discarded on receive buffer overflow*/
     unsigned char match_mask; /* Response information matching mask*/
+#if AT_RTO_EN
+    unsigned char rto_cur;    /* Index + 1 of the estimator of the command line sent last (0: not timed)*/
+#endif
+#if AT_COROUTINE_EN
+    unsigned char co_resends; /* Resends of the awaited command*/
+#endif
+    str_matcher_t prefix_matcher;
+    str_matcher_t suffix_matcher;
+    str_matcher_t error_matcher;
+    unsigned short *match_table;     /* Failure functions of the matchers (prefix, suffix, error)*/
+    unsigned short match_table_size; /* Number of entries of the failure function table*/
+#if AT_STATS_EN
+    stats_entry_t *stats;      /* Statistics table (AT_STATS_CMD_COUNT entries)*/
+    unsigned short stats_used; /* Number of statistics entries in use*/
+    unsigned short stats_retry;/* Resends of the running work*/
+    unsigned int stats_start;  /* Execution start time of the running work*/
+    unsigned int stats_send;   /* Time the last command was sent*/
+    unsigned int stats_first;  /* Time the first response byte was received*/
+#endif
+#if AT_RTO_EN
+    rto_table_t *rto;          /* Response time estimators (NULL: no memory)*/
+#endif
+#if AT_CACHE_EN
+    cache_t *cache;            /* Response cache (NULL: no cache)*/
+#endif
     unsigned urc_enable : 1;
     unsigned urc_match : 1;
+    unsigned urc_stream : 1; /* The payload of the current URC is being streamed*/
     unsigned enable : 1; /* Enable the work */
     unsigned disposing : 1;
     unsigned err_occur : 1;
     unsigned raw_trans : 1;
+    unsigned rx_pending : 1; /* The ingest budget was used up before the driver was drained*/
+#if AT_RTO_EN
+    unsigned rto_resend : 1; /* The command line sent last is a resend (its response time is ambiguous)*/
+#endif
+#if AT_STATS_EN
+    unsigned stats_recv : 1; /* The first response byte since the last send has been received*/
+#endif
+#if AT_COROUTINE_EN
+    unsigned co_wait : 2;    /* Await state of the coroutine work (CO_XXX)*/
+    unsigned co_result : 2;  /* Response code of the last await*/
+    unsigned co_resend : 1;  /* The awaited command is resent once the retry delay expires*/
+    unsigned co_urc : 1;     /* A URC is awaited (not a command response)*/
+#endif
 } at_info_t;
 
 /**
@@ -154,17 +389,43 @@ static const at_attr_t at_def_attr = {
     .cb = NULL,
     .timeout = AT_DEF_TIMEOUT,
     .retry = AT_DEF_RETRY,
-    .priority = AT_PRIORITY_LOW};
+    .priority = AT_PRIORITY_LOW,
+#if AT_RESULT_URC_EN
+    .urc_timeout = AT_DEF_URC_TIMEOUT,
+    .urc = NULL,
+#endif
+};
 /*Private static function declarations------------------------------------*/
 static void at_send_line(at_info_t *ai, const char *fmt, va_list args);
 static void *at_core_malloc(unsigned int nbytes);
 static void at_core_free(void *ptr);
+#if AT_CACHE_EN
+static void cache_store(at_info_t *ai, work_item_t *wi, at_resp_code code);
+#endif
+#if AT_RESULT_URC_EN
+static char *result_urc_find(at_info_t *ai, const char *urc);
+#endif
 
 #if AT_MEM_WATCH_EN
 static unsigned int at_max_mem; /* Maximum memory used*/
 static unsigned int at_cur_mem; /* Currently used memory*/
 #endif
 
+#if AT_POOL_EN
+/**
+ * @brief Pool size classes (small work items and command buffers).
+ */
+#define POOL_SMALL_BLKSIZE AT_POOL_ALIGN(sizeof(work_item_t) + AT_POOL_SMALL_SIZE)
+#define POOL_LARGE_BLKSIZE AT_POOL_ALIGN(sizeof(work_item_t) + AT_MAX_CMD_LEN)
+#define POOL_CLASS_COUNT 2
+
+static unsigned long long pool_small_mem[POOL_SMALL_BLKSIZE * AT_POOL_SMALL_COUNT / 8];
+static unsigned long long pool_large_mem[POOL_LARGE_BLKSIZE * AT_POOL_LARGE_COUNT / 8];
+static at_pool_t at_pools[POOL_CLASS_COUNT];
+static unsigned int at_pool_fallback[POOL_CLASS_COUNT];
+static bool at_pool_ready;
+#endif
+
 /**
  * @brief  at_obj_t * -> at_info_t *
  */
@@ -190,9 +451,39 @@ static inline void at_unlock(at_info_t *ai)
         __get_adapter(ai)->unlock();
 }
 
-static inline void send_data(at_info_t *at, const void *buf, unsigned int len)
+static inline void at_notify(at_info_t *ai)
+{
+    if (__get_adapter(ai)->notify != NULL)
+        __get_adapter(ai)->notify();
+}
+
+static inline unsigned int send_data(at_info_t *at, const void *buf, unsigned int len)
+{
+    return __get_adapter(at)->write(buf, len);
+}
+
+/**
+ * @brief   Send a frame made up of several segments (vectored write if the adapter supports it).
+ */
+static void send_frame(at_info_t *at, const at_iovec_t *iov, int iovcnt)
+{
+    int i;
+    if (__get_adapter(at)->writev != NULL)
+    {
+        __get_adapter(at)->writev(iov, iovcnt);
+        return;
+    }
+    for (i = 0; i < iovcnt; i++)
+        __get_adapter(at)->write(iov[i].base, iov[i].len);
+}
+
+/**
+ * @brief   Send a line with newline.
+ */
+static void send_line(at_info_t *at, const char *line, unsigned int len)
 {
-    __get_adapter(at)->write(buf, len);
+    at_iovec_t iov[2] = {{line, len}, {"\r\n", 2}};
+    send_frame(at, iov, 2);
 }
 
 /**
@@ -200,12 +491,9 @@ static inline void send_data(at_info_t *at, const void *buf, unsigned int len)
  */
 static void send_cmdline(at_info_t *at, const char *cmd)
 {
-    int len;
     if (cmd == NULL)
         return;
-    len = strlen(cmd);
-    __get_adapter(at)->write(cmd, len);
-    __get_adapter(at)->write("\r\n", 2);
+    send_line(at, cmd, strlen(cmd));
     AT_DEBUG(at, "->\r\n%s\r\n", cmd);
 }
 
@@ -233,11 +521,30 @@ static char *get_recvbuf(at_env_t *env)
 static void recvbuf_clear(at_env_t *env)
 {
     obj_map(env->obj)->recv_cnt = 0;
+    obj_map(env->obj)->recv_dropped = 0;
+}
+
+/**
+ * @brief  Find the first occurrence of a string in a memory block (the block may contain '\0').
+ */
+static char *mem_find(const char *buf, unsigned int size, const char *str)
+{
+    const char *p = buf, *end = buf + size;
+    unsigned int len = strlen(str);
+    if (len == 0)
+        return (char *)buf;
+    while ((unsigned int)(end - p) >= len && (p = memchr(p, str[0], end - p - len + 1)) != NULL)
+    {
+        if (memcmp(p, str, len) == 0)
+            return (char *)p;
+        p++;
+    }
+    return NULL;
 }
 
 static char *find_substr(at_env_t *env, const char *str)
 {
-    return strstr(obj_map(env->obj)->recvbuf, str);
+    return mem_find(obj_map(env->obj)->recvbuf, obj_map(env->obj)->recv_cnt, str);
 }
 
 /**
@@ -272,6 +579,7 @@ static void at_reset_timer(at_env_t *env)
 static void at_next_wait(struct at_env *env, unsigned int ms)
 {
     obj_map(env->obj)->next_delay = ms;
+    obj_map(env->obj)->delay_timer = at_get_ms();
     AT_DEBUG(obj_map(env->obj), "Next wait:%d\r\n", ms);
 }
 
@@ -298,905 +606,3324 @@ static void at_finish(struct at_env *env, at_resp_code code)
     update_work_state(it, AT_WORK_STAT_FINISH, code);
 }
 
+#if AT_STATS_EN || AT_RTO_EN
 /**
- * @brief  AT execution callback handler.
+ * @brief  Get the name of a command line (the command text up to the first '=' or '?').
  */
-static void do_at_callback(at_info_t *ai, work_item_t *wi, at_resp_code code)
+static void cmd_name(const char *cmd, char *name)
 {
-    at_response_t r;
-    AT_DEBUG(ai, "<-\r\n%s\r\n", ai->recvbuf);
-    // Exception notification
-    if ((code == AT_RESP_ERROR || code == AT_RESP_TIMEOUT) && __get_adapter(ai)->error != NULL)
-    {
-        __get_adapter(ai)->error(&r);
-        ai->err_occur = 1;
-        AT_DEBUG(ai, "AT Respose :%s\r\n", code == AT_RESP_TIMEOUT ? "timeout" : "error");
-    }
-    else
-    {
-        ai->err_occur = 0;
-    }
-#if AT_WORK_CONTEXT_EN
-    at_context_t *ctx = wi->attr.ctx;
-    if (ctx != NULL)
-    {
-        if (ctx->respbuf != NULL /* && ctx->bufsize */)
-        {
-            ctx->resplen = ai->recv_cnt >= ctx->bufsize ? ctx->bufsize - 1 : ai->recv_cnt;
-            memcpy(ctx->respbuf, ai->recvbuf, ctx->resplen);
-        }
-    }
-#endif
-    update_work_state(wi, AT_WORK_STAT_FINISH, code);
-    // Submit response data and status.
-    if (wi->attr.cb)
-    {
-        r.obj = &ai->obj;
-        r.params = wi->attr.params;
-        r.recvbuf = ai->recvbuf;
-        r.recvcnt = ai->recv_cnt;
-        r.code = code;
-        r.prefix = ai->prefix != NULL ? ai->prefix : ai->recvbuf;
-        r.suffix = ai->suffix != NULL ? ai->suffix : ai->recvbuf;
-        wi->attr.cb(&r);
-    }
+    int i;
+    for (i = 0; i < AT_STATS_NAME_LEN - 1 && cmd[i] != '\0' && cmd[i] != '=' && cmd[i] != '?' && cmd[i] != '\r'; i++)
+        name[i] = cmd[i];
+    name[i] = '\0';
 }
+#endif
 
+#if AT_STATS_EN
 /**
- * @brief  Create a basic work item.
+ * @brief  Get the histogram bucket of a time value (ms).
  */
-static work_item_t *work_item_create(int extend_size)
+static unsigned int stats_bucket(unsigned int ms)
 {
-    work_item_t *it;
-    it = at_core_malloc(sizeof(work_item_t) + extend_size);
-    if (it != NULL)
-        memset(it, 0, sizeof(work_item_t) + extend_size);
-    return it;
+    unsigned int msb, index;
+    if (ms < STATS_SUB_COUNT)
+        return ms;
+    msb = 31 - __builtin_clz(ms);
+    index = (msb - STATS_SUB_BITS + 1) * STATS_SUB_COUNT + ((ms >> (msb - STATS_SUB_BITS)) & (STATS_SUB_COUNT - 1));
+    return index < AT_STATS_BUCKETS ? index : AT_STATS_BUCKETS - 1;
 }
 
 /**
- * @brief  Destroy work item.
- * @param  it Pointer to an item to destroy.
+ * @brief  Get the statistics name of a work item (the command text up to the first '=' or '?').
  */
-static void work_item_destroy(work_item_t *it)
+static void stats_name(const work_item_t *wi, char *name)
 {
-    if (it != NULL)
+    const char *cmd;
+    switch (wi->type)
     {
-        it->magic = 0;
-        at_core_free(it);
+    case WORK_TYPE_CMD:
+        cmd = wi->buf;
+        break;
+    case WORK_TYPE_SINGLLINE:
+        cmd = wi->singlline;
+        break;
+    case WORK_TYPE_MULTILINE: // A multiline work is accounted to its first command.
+        cmd = wi->multiline[0];
+        break;
+    case WORK_TYPE_BUF:
+        cmd = "<data>";
+        break;
+#if AT_PAYLOAD_EN
+    case WORK_TYPE_PAYLOAD:
+        cmd = payload_line(wi);
+        break;
+#endif
+    default:
+        cmd = "<custom>";
+        break;
     }
+    cmd_name(cmd != NULL ? cmd : "", name);
 }
 
 /**
- * @brief Destroys all work items in the specified queue.
+ * @brief  Find the statistics entry of a name, a new entry is added when the name is not 
+ *         tracked yet (the last entry collects the names that no longer fit).
  */
-static void work_item_destroy_all(at_info_t *ai, struct list_head *head)
+static stats_entry_t *stats_lookup(at_info_t *ai, const char *name)
 {
-    struct list_head *pos, *n;
-    work_item_t *it;
-    at_lock(ai);
-    list_for_each_safe(pos, n, head)
+    stats_entry_t *e;
+    int i;
+    for (i = 0; i < ai->stats_used; i++)
     {
-        it = list_entry(pos, work_item_t, node);
-        list_del(&it->node);
-        work_item_destroy(it);
+        if (strcmp(ai->stats[i].info.name, name) == 0)
+            return &ai->stats[i];
     }
-    at_unlock(ai);
+    if (ai->stats_used < AT_STATS_CMD_COUNT - 1)
+    {
+        e = &ai->stats[ai->stats_used++];
+        strcpy(e->info.name, name);
+        return e;
+    }
+    e = &ai->stats[AT_STATS_CMD_COUNT - 1];
+    if (ai->stats_used < AT_STATS_CMD_COUNT)
+    {
+        ai->stats_used = AT_STATS_CMD_COUNT;
+        strcpy(e->info.name, "*");
+    }
+    return e;
+}
+
+static void stats_add(stats_entry_t *e, at_stats_kind kind, unsigned int ms)
+{
+    e->hist[kind][stats_bucket(ms)]++;
+    if (ms > e->info.max[kind])
+        e->info.max[kind] = ms;
 }
 
 /**
- * @brief  Work item recycling.
+ * @brief  Record the timing of a completed command.
  */
-static void work_item_recycle(at_info_t *ai, work_item_t *it)
+static void stats_record(at_info_t *ai, work_item_t *wi, at_resp_code code)
 {
+    char name[AT_STATS_NAME_LEN];
+    unsigned int now = at_get_ms();
+    stats_entry_t *e;
+    if (ai->stats == NULL)
+        return;
+    stats_name(wi, name);
     at_lock(ai);
-    if (ai->list_cnt)
-        ai->list_cnt--;
-
-    list_del(&it->node);
-    work_item_destroy(it);
+    e = stats_lookup(ai, name);
+    e->info.count++;
+    e->info.retries += ai->stats_retry;
+    if (code == AT_RESP_ERROR)
+        e->info.errors++;
+    else if (code == AT_RESP_TIMEOUT)
+        e->info.timeouts++;
+    stats_add(e, AT_STATS_QUEUE, ai->stats_start - wi->enqueue_time);
+    if (ai->stats_recv)
+        stats_add(e, AT_STATS_MODEM, ai->stats_first - ai->stats_send);
+    stats_add(e, AT_STATS_TOTAL, now - wi->enqueue_time);
     at_unlock(ai);
 }
+#endif
+
+#if AT_RTO_EN
 /**
- * @brief  Create and initialize a work item.
- * @param  type  Type of work item.
- * @param  attr  Item attributes
- * @param  info  additional information.
- * @param  size  the extended size.
+ * @brief  Find the estimator of a command name, or take a free one.
  */
-static work_item_t *create_work_item(at_info_t *ai, int type, const at_attr_t *attr, const void *info, int extend_size)
+static rto_entry_t *rto_lookup(rto_table_t *t, const char *name)
 {
-    work_item_t *it = work_item_create(extend_size);
-    if (it == NULL)
-    {
-        AT_DEBUG(ai, "Insufficient memory, list count:%d\r\n", ai->list_cnt);
-        return NULL;
-    }
-    if (ai->list_cnt > AT_LIST_WORK_COUNT)
-    {
-        AT_DEBUG(ai, "Work queue full\r\n");
-        work_item_destroy(it);
-        return NULL;
-    }
-    if (attr == NULL)
-        attr = &at_def_attr;
-
-    if (type == WORK_TYPE_CMD || type == WORK_TYPE_BUF)
+    rto_entry_t *e;
+    int i;
+    for (i = 0; i < t->used; i++)
     {
-        memcpy(it->buf, info, extend_size);
-        it->bufsize = extend_size;
+        if (strcmp(t->entry[i].info.name, name) == 0)
+            return &t->entry[i];
     }
-    else
+    if (t->used < AT_RTO_CMD_COUNT - 1)
     {
-        it->info = info;
+        e = &t->entry[t->used++];
+        strcpy(e->info.name, name);
+        return e;
     }
-    it->magic = WORK_ITEM_TAG;
-    it->attr = *attr;
-    it->type = type;
-    it->state = AT_WORK_STAT_READY;
-#if AT_WORK_CONTEXT_EN
-    if (attr->ctx)
+    e = &t->entry[AT_RTO_CMD_COUNT - 1];
+    if (t->used < AT_RTO_CMD_COUNT)
     {
-        attr->ctx->code = AT_RESP_OK;
-        attr->ctx->work_state = AT_WORK_STAT_READY;
+        t->used = AT_RTO_CMD_COUNT;
+        strcpy(e->info.name, "*");
     }
-#endif
-    return it;
+    return e;
 }
 
-static work_item_t *sumit_work_item(at_info_t *ai, work_item_t *it)
+static unsigned int rto_bound(const rto_table_t *t, unsigned int ms)
 {
-    if (it != NULL)
-    {
-        at_lock(ai);
-        list_add_tail(&it->node, it->attr.priority == AT_PRIORITY_HIGH ? &ai->hlist : &ai->llist);
-        ai->list_cnt++; // Statistics
-        at_unlock(ai);
-    }
-    return it;
+    return ms < t->min ? t->min : ms > t->max ? t->max : ms;
 }
 
 /**
- * @brief  Create work and put it in the queue
- * @param  type  work of type
- * @param  attr  AT attributes
- * @param  info  Extra info
- * @param  size  Extra info size
+ * @brief  Add a response time sample (Jacobson's algorithm, RFC 6298).
  */
-static work_item_t *add_work_item(at_info_t *ai, int type, const at_attr_t *attr, const void *info, int extend_size)
+static void rto_update(const rto_table_t *t, rto_entry_t *e, unsigned int rtt)
 {
-    work_item_t *it = create_work_item(ai, type, attr, info, extend_size);
-    if (it == NULL)
-        return NULL;
-    return sumit_work_item(ai, it);
+    int err;
+    if (e->info.samples++ == 0)
+    {
+        e->srtt8 = rtt << 3;
+        e->rttvar4 = rtt << 1;
+    }
+    else
+    {
+        err = (int)rtt - (int)(e->srtt8 >> 3);
+        e->srtt8 += err;
+        if (err < 0)
+            err = -err;
+        e->rttvar4 += err - (int)(e->rttvar4 >> 2);
+    }
+    e->info.srtt = e->srtt8 >> 3;
+    e->info.rttvar = e->rttvar4 >> 2;
+    e->info.rto = rto_bound(t, e->info.srtt + e->rttvar4);
 }
+#endif
 
 /**
- * @brief  Initialize matching info
+ * @brief  Start timing a command line (it is timed from the work timer, which is reset when 
+ *         it is sent), and get its response timeout and retry delay (the estimated ones 
+ *         when they are known, the static ones otherwise).
+ * @param  cmd     Command line, NULL if it is not timed (data and custom commands).
+ * @param  timeout Static response timeout of the work.
+ * @param  resend  The command line is a resend.
  */
-static void match_info_init(at_info_t *ai, at_attr_t *attr)
+static void rto_begin(at_info_t *ai, const char *cmd, unsigned int timeout, bool resend)
 {
-    ai->prefix = ai->suffix = NULL;
-    ai->match_len = 0;
-    ai->match_mask = 0;
-    if (attr->prefix == NULL || strlen(attr->prefix) == 0)
-        ai->match_mask |= MATCH_MASK_PREFIX;
-    if (attr->suffix == NULL || strlen(attr->suffix) == 0)
-        ai->match_mask |= MATCH_MASK_SUFFIX;
+#if AT_RTO_EN
+    char name[AT_STATS_NAME_LEN];
+    rto_table_t *t = ai->rto;
+    rto_entry_t *e;
+#endif
+    ai->resp_timeout = timeout;
+    ai->retry_delay = AT_RETRY_DELAY;
+#if AT_RTO_EN
+    ai->rto_cur = 0;
+    if (cmd == NULL || t == NULL || t->max == 0 || timeout > t->max)
+        return;
+    cmd_name(cmd, name);
+    at_lock(ai);
+    e = rto_lookup(t, name);
+    at_unlock(ai);
+    if (e == &t->entry[AT_RTO_CMD_COUNT - 1]) // Mixed commands, it is not estimated.
+        return;
+    if (e->info.rto != 0)
+        ai->resp_timeout = e->info.rto;
+    if (e->info.samples != 0)
+        ai->retry_delay = rto_bound(t, e->info.srtt);
+    ai->rto_cur = e - t->entry + 1;
+    ai->rto_resend = resend;
+#endif
 }
 
 /**
- * @brief Custom work processing
+ * @brief  A response (or an error response) to the command line sent last has been received, 
+ *         its time is sampled unless it was a resend (Karn's algorithm).
  */
-static int do_work_handler(at_info_t *ai)
+static void rto_sample(at_info_t *ai)
 {
-    work_item_t *i = ai->cursor;
-    if (ai->next_delay > 0)
-    {
-        if (!AT_IS_TIMEOUT(ai->delay_timer, ai->next_delay))
-            return 0;
-        ai->next_delay = 0;
-    }
-    return ((int (*)(at_env_t *e))i->work)(&ai->env);
+#if AT_RTO_EN
+    if (ai->rto_cur == 0)
+        return;
+    at_lock(ai);
+    if (!ai->rto_resend)
+        rto_update(ai->rto, &ai->rto->entry[ai->rto_cur - 1], at_get_ms() - ai->timer);
+    at_unlock(ai);
+    ai->rto_cur = 0;
+#endif
 }
 
 /**
- * @brief  Generic commands processing
+ * @brief  The command line sent last has timed out, its timeout is doubled (exponential 
+ *         backoff) until the next sample.
  */
-static int do_cmd_handler(at_info_t *ai)
+static void rto_timeout(at_info_t *ai)
 {
-    work_item_t *wi = ai->cursor;
-    at_env_t *env = &ai->env;
-    at_attr_t *attr = &wi->attr;
-    switch (env->state)
-    {
-    case AT_STAT_SEND:
-        if (wi->type == WORK_TYPE_CUSTOM && wi->sender != NULL)
-        {
-            wi->sender(env);
-        }
-        else if (wi->type == WORK_TYPE_BUF)
-        {
-            __get_adapter(ai)->write(wi->buf, wi->bufsize);
-        }
-        else if (wi->type == WORK_TYPE_SINGLLINE)
-        {
-            send_cmdline(ai, wi->singlline);
-        }
-        else
-        {
-            send_cmdline(ai, wi->buf);
-        }
-        env->state = AT_STAT_RECV;
-        env->reset_timer(env);
-        env->recvclr(env);
-        match_info_init(ai, attr);
-        break;
-    case AT_STAT_RECV: /*Receive information and matching processing.*/
-        if (ai->match_len != ai->recv_cnt)
-        {
-            ai->match_len = ai->recv_cnt;
-            // Matching response content prefix.
-            if (!(ai->match_mask & MATCH_MASK_PREFIX))
-            {
-                ai->prefix = strstr(ai->recvbuf, attr->prefix);
-                ai->match_mask |= ai->prefix ? MATCH_MASK_PREFIX : 0x00;
-            }
-            // Matching response content suffix.
-            if (ai->match_mask & MATCH_MASK_PREFIX)
-            {
-                ai->suffix = strstr(ai->prefix ? ai->prefix : ai->recvbuf, attr->suffix);
-                ai->match_mask |= ai->suffix ? MATCH_MASK_SUFFIX : 0x00;
-            }
-            ai->match_mask |= strstr(ai->recvbuf, AT_DEF_RESP_ERR) ? MATCH_MASK_ERROR : 0x00;
-        }
-        if (ai->match_mask & MATCH_MASK_ERROR)
-        {
-            AT_DEBUG(ai, "<-\r\n%s\r\n", ai->recvbuf);
-            if (env->i++ >= attr->retry)
-            {
-                do_at_callback(ai, wi, AT_RESP_ERROR);
-                return true;
-            }
-
-            env->state = AT_STAT_RETRY; // If the command responds incorrectly, it will wait for a while and try again.
-            env->reset_timer(env);
-        }
-        if (ai->match_mask & MATCH_MASK_SUFFIX)
-        {
-            do_at_callback(ai, wi, AT_RESP_OK);
-            return true;
-        }
-        else if (env->is_timeout(env, attr->timeout))
-        {
-            AT_DEBUG(ai, "Command response timeout, retry:%d\r\n", env->i);
-            if (env->i++ >= attr->retry)
-            {
-                do_at_callback(ai, wi, AT_RESP_TIMEOUT);
-                return true;
-            }
-            env->state = AT_STAT_SEND;
-        }
-        break;
-    case AT_STAT_RETRY:
-        if (env->is_timeout(env, 100))
-            env->state = AT_STAT_SEND; /*Go back to the send state*/
-        break;
-    default:
-        env->state = AT_STAT_SEND;
-    }
-    return false;
+#if AT_RTO_EN
+    rto_entry_t *e;
+    if (ai->rto_cur == 0)
+        return;
+    e = &ai->rto->entry[ai->rto_cur - 1];
+    at_lock(ai);
+    e->info.rto = rto_bound(ai->rto, ai->resp_timeout * 2);
+    e->info.backoffs++;
+    at_unlock(ai);
+    ai->rto_cur = 0;
+#endif
 }
 
 /**
- * @brief  Multi-line command sending processing.
+ * @brief  Classify an error response.
+ * @param  cls  Returns the error class.
+ * @param  code Returns the +CME/+CMS ERROR code (-1: plain "ERROR" or a verbose error text).
+ * @return false if the line of the error code has not been completely received yet.
  */
-static int send_multiline_handler(at_info_t *ai)
+static bool error_parse(const char *buf, unsigned int size, at_fail_class *cls, int *code)
 {
-    work_item_t *wi = ai->cursor;
-    at_env_t *env = &ai->env;
-    at_attr_t *attr = &wi->attr;
-    const char **cmds = wi->multiline;
+    const char *p, *end = buf + size;
+    *cls = AT_FAIL_ERROR;
+    *code = -1;
+    if ((p = mem_find(buf, size, "+CME ERROR:")) != NULL)
+        *cls = AT_FAIL_CME;
+    else if ((p = mem_find(buf, size, "+CMS ERROR:")) != NULL)
+        *cls = AT_FAIL_CMS;
+    else
+        return true;
+    for (p += sizeof("+CME ERROR:") - 1; p < end && *p == ' '; p++)
+        ;
+    if (memchr(p, '\n', end - p) == NULL)
+        return false;
+    for (; *p >= '0' && *p <= '9' && *code < 100000; p++)
+        *code = (*code < 0 ? 0 : *code * 10) + *p - '0';
+    return true;
+}
 
-    switch (env->state)
+#if AT_RETRY_POLICY_EN
+static const short fatal_cme_codes[] = {
+    3,  /* Operation not allowed*/
+    4,  /* Operation not supported*/
+    10, /* SIM not inserted*/
+    11, /* SIM PIN required*/
+    12, /* SIM PUK required*/
+    13, /* SIM failure*/
+    16, /* Incorrect password*/
+    50, /* Incorrect parameters*/
+    -1};
+
+static const short fatal_cms_codes[] = {
+    302, /* Operation not allowed*/
+    303, /* Operation not supported*/
+    304, /* Invalid PDU mode parameter*/
+    305, /* Invalid text mode parameter*/
+    310, /* SIM not inserted*/
+    311, /* SIM PIN required*/
+    313, /* SIM failure*/
+    316, /* SIM PUK required*/
+    -1};
+
+const at_retry_policy_t at_retry_backoff = {
+    .base = 0,
+    .max_delay = 5000,
+    .factor = 2,
+    .jitter = 50,
+    .max_elapsed = 0,
+    .fatal_cme = fatal_cme_codes,
+    .fatal_cms = fatal_cms_codes,
+    .retryable = NULL};
+
+static unsigned int retry_seed;
+
+static unsigned int retry_random(void)
+{
+    retry_seed = retry_seed * 1103515245u + 12345u + at_get_ms();
+    return retry_seed >> 16;
+}
+
+static bool code_listed(const short *list, int code)
+{
+    for (; list != NULL && *list >= 0; list++)
     {
-    case AT_STAT_SEND:
-        if (cmds[env->i] == NULL)
-        { /* All commands are sent.*/
-            do_at_callback(ai, wi, env->params ? AT_RESP_OK : AT_RESP_ERROR);
-            return true;
-        }
-        send_cmdline(ai, cmds[env->i]);
-        env->recvclr(env);
-        env->reset_timer(env);
-        env->state = AT_STAT_RECV;
-        match_info_init(ai, attr);
-        break;
-    case AT_STAT_RECV:
-        if (find_substr(env, attr->suffix))
-        {
-            env->state = 0;
-            env->i++;
-            env->j = 0;
-            env->params = (void *)true; /*Mark execution status*/
-            AT_DEBUG(ai, "<-\r\n%s\r\n", ai->recvbuf);
-        }
-        else if (find_substr(env, AT_DEF_RESP_ERR))
-        {
-            AT_DEBUG(ai, "<-\r\n%s\r\n", ai->recvbuf);
-            env->j++;
-            AT_DEBUG(ai, "CMD:'%s' failed to executed, retry:%d\r\n", cmds[env->i], env->j);
-            if (env->j >= attr->retry)
-            {
-                env->state = 0;
-                env->j = 0;
-                env->i++;
-            }
-            else
-            {
-                env->state = AT_STAT_RETRY; // After the command responds incorrect, try again after a period of time.
-                env->reset_timer(env);
-            }
-        }
-        else if (env->is_timeout(env, AT_DEF_TIMEOUT))
-        {
-            do_at_callback(ai, wi, AT_RESP_TIMEOUT);
+        if (*list == code)
             return true;
-        }
-        break;
-    case AT_STAT_RETRY:
-        if (env->is_timeout(env, 100))
-            env->state = AT_STAT_SEND; /*Go back to the send state and resend.*/
-        break;
-    default:
-        env->state = AT_STAT_SEND;
     }
-    return 0;
+    return false;
 }
 
 /**
- * @brief       Send command line
+ * @brief  Apply a retry policy to a failed attempt.
+ * @return false if the command is not resent.
  */
-static void at_send_line(at_info_t *ai, const char *fmt, va_list args)
+static bool retry_backoff(at_info_t *ai, const at_retry_policy_t *p, unsigned int start, int resends,
+                          at_fail_class cls, int code)
 {
-    int len;
-    char *cmdline;
-    cmdline = at_core_malloc(AT_MAX_CMD_LEN);
-    if (cmdline == NULL)
+    unsigned int delay, limit, jitter;
+    int i;
+    if (p->retryable != NULL)
     {
-        AT_DEBUG(ai, "Malloc failed when send...\r\n");
-        return;
+        if (!p->retryable(cls, code))
+            return false;
     }
-    len = vsnprintf(cmdline, AT_MAX_CMD_LEN, fmt, args);
-    // Clear receive buffer.
-    ai->recv_cnt = 0;
-    ai->recvbuf[0] = '\0';
-    send_data(ai, cmdline, len);
-    send_data(ai, "\r\n", 2);
-    AT_DEBUG(ai, "->\r\n%s\r\n", cmdline);
-
-    at_core_free(cmdline);
+    else if ((cls == AT_FAIL_CME && code_listed(p->fatal_cme, code)) ||
+             (cls == AT_FAIL_CMS && code_listed(p->fatal_cms, code)))
+    {
+        AT_DEBUG(ai, "Non-retryable error:%d\r\n", code);
+        return false;
+    }
+    delay = p->base != 0 ? p->base : ai->retry_delay;
+    limit = p->max_delay != 0 ? p->max_delay : 0xFFFF;
+    for (i = 0; i < resends && p->factor > 1 && delay < limit; i++)
+        delay *= p->factor;
+    if (delay > limit)
+        delay = limit;
+    if (p->jitter != 0)
+    {
+        jitter = delay * (p->jitter < 100 ? p->jitter : 100) / 100;
+        delay = delay - jitter + retry_random() % (jitter + 1);
+    }
+    if (p->max_elapsed != 0 && at_get_ms() + delay - start > p->max_elapsed)
+    {
+        AT_DEBUG(ai, "Retry time exhausted\r\n");
+        return false;
+    }
+    ai->retry_delay = delay;
+    return true;
 }
-
-#if AT_URC_WARCH_EN
+#endif
 
 /**
- * @brief   Set the AT urc table.
+ * @brief  A command attempt has failed, decide whether it is resent, and after how long 
+ *         (ai->retry_delay).
+ * @param  attr     Attributes of the command.
+ * @param  start    Submission time of the command (ms).
+ * @param  resends  Number of resends already done.
+ * @param  cls      Class of the failure.
+ * @param  code     +CME/+CMS ERROR code, -1 if none.
+ * @return false if the command fails.
  */
-void at_obj_set_urc(at_obj_t *at, const urc_item_t *tbl, int count)
+static bool retry_attempt(at_info_t *ai, const at_attr_t *attr, unsigned int start, int resends,
+                          at_fail_class cls, int code)
 {
-    at_info_t *ai = obj_map(at);
-    ai->urc_tbl = tbl;
-    ai->urc_tbl_size = count;
+    if (resends >= attr->retry)
+        return false;
+#if AT_RETRY_POLICY_EN
+    if (attr->policy != NULL)
+        return retry_backoff(ai, attr->policy, start, resends, cls, code);
+#endif
+    if (cls == AT_FAIL_TIMEOUT) // Without a policy, a timed out command is resent at once.
+        ai->retry_delay = 0;
+    return true;
 }
+
+static inline bool retry_check(at_info_t *ai, work_item_t *wi, int resends, at_fail_class cls, int code)
+{
+    return retry_attempt(ai, &wi->attr, wi->enqueue_time, resends, cls, code);
+}
+
+#if AT_SYNC_EN
 /**
- * @brief Find a URC handler based on URC receive buffer information.
+ * @brief Blocking request state.
  */
-const urc_item_t *find_urc_item(at_info_t *ai, char *urc_buf, unsigned int size)
+enum
 {
-    const urc_item_t *tbl = ai->urc_tbl;
-    int i;
-    for (i = 0; i < ai->urc_tbl_size && tbl; i++, tbl++)
-    {
-        if (strstr(urc_buf, tbl->prefix)) // It will need to be further optimized in the future.
-            return tbl;
-    }
-    return NULL;
-}
+    SYNC_WAIT = 0, /* The caller is waiting*/
+    SYNC_BUSY,     /* The AT task is filling in the result*/
+    SYNC_DONE,     /* Result ready, the caller releases the request*/
+    SYNC_GONE      /* The caller gave up, the AT task releases the request*/
+};
 
-static void urc_reset(at_info_t *ai)
+/**
+ * @brief Blocking request, allocated by the caller and shared with the AT task until one of 
+ *        them releases it.
+ */
+typedef struct at_sync
 {
-    ai->urc_target = 0;
-    ai->urc_cnt = 0;
-    ai->urc_item = NULL;
-    ai->urc_match = 0;
-}
+    void *waiter;         /* Waiting task (at_sync_waiter)*/
+    at_sync_resp_t *resp; /* Caller's result, NULL if not required*/
+    at_resp_code code;    /* Response code*/
+    unsigned char state;  /* Request state (SYNC_XXX)*/
+} at_sync_t;
 
 /**
- * @brief       URC(unsolicited code) handler entry.
- * @param[in]   urc    - URC receive buffer
- * @param[in]   size   - URC receive buffer length
- * @return      none
+ * @brief  Hand the result of a work over to its blocking caller (AT task).
+ * @param  r  Response, NULL if the work ended without one (aborted or destroyed).
  */
-static void urc_handler_entry(at_info_t *ai, urc_recv_status status, char *urc, unsigned int size)
+static void sync_complete(work_item_t *wi, const at_response_t *r)
 {
-    int remain;
-    at_urc_info_t ctx = {status, urc, size};
-    if (ai->urc_target > 0)
-        AT_DEBUG(ai, "<=\r\n%.5s..\r\n", urc);
-    else
-        AT_DEBUG(ai, "<=\r\n%s\r\n", urc);
-    /* Send URC event notification. */
-    remain = ai->urc_item ? ai->urc_item->handler(&ctx) : 0;
-    if (remain == 0 && (ai->urc_item || ai->cursor == NULL))
-    {
-        urc_reset(ai);
+    at_sync_t *s = wi->sync;
+    at_sync_resp_t *resp = s->resp;
+    unsigned char state = SYNC_WAIT;
+    unsigned int off;
+    void *waiter;
+    wi->sync = NULL;
+    if (!__atomic_compare_exchange_n(&s->state, &state, SYNC_BUSY, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+    { // The caller gave up.
+        at_free(s);
+        return;
     }
+    if (r != NULL)
+        s->code = r->code;
     else
+        s->code = wi->state >= AT_WORK_STAT_FINISH ? (at_resp_code)wi->code : AT_RESP_ABORT;
+    if (resp != NULL)
     {
-        AT_DEBUG(ai, "URC receives %d bytes remaining.\r\n", remain);
-        ai->urc_target = ai->urc_cnt + remain;
-        ai->urc_match = true;
+        resp->code = s->code;
+        if (r != NULL)
+        {
+            resp->error = r->error;
+            if (resp->buf != NULL && resp->bufsize != 0)
+            {
+                resp->len = r->recvcnt < resp->bufsize ? r->recvcnt : resp->bufsize - 1;
+                memcpy(resp->buf, r->recvbuf, resp->len);
+                resp->buf[resp->len] = '\0';
+                off = r->prefix - r->recvbuf;
+                resp->prefix = off < resp->len ? resp->buf + off : NULL;
+#if AT_RESULT_URC_EN
+                off = r->urc != NULL ? r->urc - r->recvbuf : resp->len;
+                resp->urc = off < resp->len ? resp->buf + off : NULL;
+#endif
+            }
+        }
     }
+    waiter = s->waiter; // The caller may release the request as soon as it is done.
+    __atomic_store_n(&s->state, SYNC_DONE, __ATOMIC_RELEASE);
+    at_sync_signal(waiter);
 }
 
-static void urc_timeout_process(at_info_t *ai)
+/**
+ * @brief  Indicates whether the blocking caller of a work gave up waiting.
+ */
+static inline bool sync_abandoned(work_item_t *wi)
 {
-    // Receive timeout processing, default (MAX_URC_RECV_TIMEOUT).
-    if (ai->urc_cnt > 0 && AT_IS_TIMEOUT(ai->urc_timer, AT_URC_TIMEOUT))
-    {
-        if (ai->urc_cnt > 2 && ai->urc_item != NULL)
-        {
-            ai->urcbuf[ai->urc_cnt] = '\0';
-            AT_DEBUG(ai, "urc recv timeout=>%s\r\n", ai->urcbuf);
-            urc_handler_entry(ai, URC_RECV_TIMEOUT, ai->urcbuf, ai->urc_cnt);
-        }
-        urc_reset(ai);
-    }
+    return wi->sync != NULL && __atomic_load_n(&wi->sync->state, __ATOMIC_RELAXED) == SYNC_GONE;
 }
+#endif
 
 /**
- * @brief       URC receive processing
- * @param[in]   buf  - Receive buffer
- * @return      none
+ * @brief  AT execution callback handler.
  */
-static void urc_recv_process(at_info_t *ai, char *buf, unsigned int size)
+static void do_at_callback(at_info_t *ai, work_item_t *wi, at_resp_code code)
 {
-    char *urc_buf;
-    int ch;
-    if (ai->urcbuf == NULL)
-        return;
-    if (size == 0)
-    {
-        urc_timeout_process(ai);
-        return;
+    at_fail_class cls;
+    at_response_t r;
+    AT_DEBUG(ai, "<-\r\n%s\r\n", ai->recvbuf);
+#if AT_STATS_EN
+    stats_record(ai, wi, code);
+#endif
+    r.obj = &ai->obj;
+    r.params = wi->attr.params;
+    r.recvbuf = ai->recvbuf;
+    r.recvcnt = ai->recv_cnt;
+    r.code = code;
+    r.prefix = ai->prefix != NULL ? ai->prefix : ai->recvbuf;
+    r.suffix = ai->suffix != NULL ? ai->suffix : ai->recvbuf;
+    r.dropped = ai->recv_dropped;
+    r.error = -1;
+#if AT_RESULT_URC_EN
+    r.urc = code == AT_RESP_OK && wi->attr.urc != NULL && ai->env.state == AT_STAT_URC ?
+            result_urc_find(ai, wi->attr.urc) : NULL;
+#endif
+    if (code == AT_RESP_ERROR)
+        error_parse(ai->recvbuf, ai->recv_cnt, &cls, &r.error);
+    // Exception notification
+    if ((code == AT_RESP_ERROR || code == AT_RESP_TIMEOUT) && __get_adapter(ai)->error != NULL)
+    {
+        __get_adapter(ai)->error(&r);
+        ai->err_occur = 1;
+        AT_DEBUG(ai, "AT Respose :%s\r\n", code == AT_RESP_TIMEOUT ? "timeout" : "error");
     }
-    if (!ai->urc_enable)
+    else
     {
-        if (!AT_IS_TIMEOUT(ai->urc_timer, ai->urc_disable_time))
-            return;
-        ai->urc_enable = 1;
-        AT_DEBUG(ai, "Enable the URC match handler\r\n");
+        ai->err_occur = 0;
     }
-    urc_buf = ai->urcbuf;
-    while (size--)
+#if AT_WORK_CONTEXT_EN
+    at_context_t *ctx = wi->attr.ctx;
+    if (ctx != NULL)
     {
-        ch = *buf++;
-        urc_buf[ai->urc_cnt++] = ch;
-        if (ai->urc_cnt >= ai->urc_bufsize)
-        { /* Empty directly on overflow */
-            urc_reset(ai);
-            AT_DEBUG(ai, "Urc buffer full.\r\n");
+        if (ctx->respbuf != NULL /* && ctx->bufsize */)
+        {
+            ctx->resplen = ai->recv_cnt >= ctx->bufsize ? ctx->bufsize - 1 : ai->recv_cnt;
+            memcpy(ctx->respbuf, ai->recvbuf, ctx->resplen);
+        }
+    }
+#endif
+#if AT_CACHE_EN
+    if (wi->cache != 0) // Store it before the callback has a chance to modify it.
+        cache_store(ai, wi, code);
+#endif
+    update_work_state(wi, AT_WORK_STAT_FINISH, code);
+#if AT_SYNC_EN
+    if (wi->sync != NULL) // Copied before the callback has a chance to modify it.
+        sync_complete(wi, &r);
+#endif
+    // Submit response data and status.
+    if (wi->attr.cb)
+        wi->attr.cb(&r);
+}
+
+#if AT_POOL_EN
+/**
+ * @brief  Initialize the pools (once, when the first AT object is created).
+ */
+static void at_pool_setup(void)
+{
+    if (at_pool_ready)
+        return;
+    at_pool_init(&at_pools[0], pool_small_mem, POOL_SMALL_BLKSIZE, AT_POOL_SMALL_COUNT);
+    at_pool_init(&at_pools[1], pool_large_mem, POOL_LARGE_BLKSIZE, AT_POOL_LARGE_COUNT);
+    at_pool_ready = true;
+}
+
+/**
+ * @brief  Allocate work memory from the smallest fitting pool, fall back to the heap when 
+ *         the request is too large or the pool is exhausted.
+ */
+static void *at_work_malloc(unsigned int nbytes)
+{
+    void *ptr;
+    int i;
+    for (i = 0; i < POOL_CLASS_COUNT; i++)
+    {
+        if (nbytes > at_pools[i].blksize)
             continue;
+        ptr = at_pool_alloc(&at_pools[i]);
+        if (ptr != NULL)
+            return ptr;
+        __atomic_add_fetch(&at_pool_fallback[i], 1, __ATOMIC_RELAXED);
+        break;
+    }
+    return at_core_malloc(nbytes);
+}
+
+static void at_work_free(void *ptr)
+{
+    int i;
+    for (i = 0; i < POOL_CLASS_COUNT; i++)
+    {
+        if (at_pool_contains(&at_pools[i], ptr))
+        {
+            // A pointer inside a block (not returned by the pool) is rejected, the block is 
+            // not put back on the free list twice.
+            at_pool_free(&at_pools[i], ptr);
+            return;
         }
-        if (ai->urc_match)
+    }
+    at_core_free(ptr);
+}
+#else
+#define at_work_malloc at_core_malloc
+#define at_work_free at_core_free
+#endif
+
+#if AT_STATS_EN
+#define STATS_SEND(ai) ((ai)->stats_send = at_get_ms(), (ai)->stats_recv = 0)
+#define STATS_RETRY(ai) ((ai)->stats_retry++)
+#else
+#define STATS_SEND(ai)
+#define STATS_RETRY(ai)
+#endif
+
+/**
+ * @brief  Create a basic work item.
+ */
+static work_item_t *work_item_create(int extend_size)
+{
+    work_item_t *it;
+    it = at_work_malloc(sizeof(work_item_t) + extend_size);
+    if (it != NULL)
+        memset(it, 0, sizeof(work_item_t) + extend_size);
+    return it;
+}
+
+/**
+ * @brief  Destroy work item.
+ * @param  it Pointer to an item to destroy.
+ */
+static void work_item_destroy(work_item_t *it)
+{
+    if (it != NULL)
+    {
+#if AT_SYNC_EN
+        if (it->sync != NULL) // Ended without a response (aborted or destroyed).
+            sync_complete(it, NULL);
+#endif
+        it->magic = 0;
+        at_work_free(it);
+    }
+}
+
+/**
+ * @brief Destroys all work items in the specified queue.
+ */
+static void work_item_destroy_all(struct list_head *head)
+{
+    struct list_head *pos, *n;
+    work_item_t *it;
+    list_for_each_safe(pos, n, head)
+    {
+        it = list_entry(pos, work_item_t, node);
+        list_del(&it->node);
+        work_item_destroy(it);
+    }
+}
+
+/**
+ * @brief  Work item recycling (AT task).
+ */
+static void work_item_recycle(at_info_t *ai, work_item_t *it)
+{
+    list_del(&it->node);
+    work_item_destroy(it);
+    __atomic_sub_fetch(&ai->list_cnt, 1, __ATOMIC_RELAXED);
+}
+/**
+ * @brief  Create and initialize a work item.
+ * @param  type  Type of work item.
+ * @param  attr  Item attributes
+ * @param  info  additional information (for buffer type items, NULL means the caller 
+ *               fills in the buffer itself).
+ * @param  size  the extended size.
+ */
+static work_item_t *create_work_item(at_info_t *ai, int type, const at_attr_t *attr, const void *info, int extend_size)
+{
+    work_item_t *it = work_item_create(extend_size);
+    if (it == NULL)
+    {
+        AT_DEBUG(ai, "Insufficient memory, list count:%d\r\n", ai->list_cnt);
+        return NULL;
+    }
+    if (__atomic_load_n(&ai->list_cnt, __ATOMIC_RELAXED) > AT_LIST_WORK_COUNT)
+    {
+        AT_DEBUG(ai, "Work queue full\r\n");
+        work_item_destroy(it);
+        return NULL;
+    }
+    if (attr == NULL)
+        attr = &at_def_attr;
+
+    if (type == WORK_TYPE_CMD || type == WORK_TYPE_BUF || type == WORK_TYPE_PAYLOAD)
+    {
+        if (info != NULL)
+            memcpy(it->buf, info, extend_size);
+        it->bufsize = extend_size;
+    }
+    else
+    {
+        it->info = info;
+    }
+    it->magic = WORK_ITEM_TAG;
+    it->attr = *attr;
+    it->type = type;
+    it->state = AT_WORK_STAT_READY;
+#if AT_WORK_CONTEXT_EN
+    if (attr->ctx)
+    {
+        attr->ctx->code = AT_RESP_OK;
+        attr->ctx->work_state = AT_WORK_STAT_READY;
+    }
+#endif
+    return it;
+}
+
+#if AT_CACHE_EN
+static bool cache_submit(at_info_t *ai, work_item_t *it);
+#endif
+
+/**
+ * @brief  Put a work item in the queue of its level (AT task).
+ */
+static void work_enqueue(at_info_t *ai, work_item_t *it)
+{
+    unsigned int level;
+#if AT_CACHE_EN
+    bool cached = false;
+    if (ai->cache != NULL && it->state != AT_WORK_STAT_ABORT)
+    { // The cache counters and entries are shared with the cache interfaces.
+        at_lock(ai);
+        cached = cache_submit(ai, it);
+        at_unlock(ai);
+    }
+    if (cached) // Answered from the cache or joined to the query in flight.
+        return;
+#endif
+    level = it->attr.priority < AT_PRIORITY_LEVELS ? it->attr.priority : AT_PRIORITY_HIGH;
+    list_add_tail(&it->node, &ai->queues[level]);
+}
+
+/**
+ * @brief  Indicates whether submission sequence number 'a' precedes 'b'.
+ */
+static inline bool seq_before(unsigned short a, unsigned short b)
+{
+    return (short)(a - b) < 0;
+}
+
+/**
+ * @brief  Submit a work item from any task: it is pushed to the inbox without locking, the 
+ *         AT task moves it to its queues.
+ */
+static work_item_t *sumit_work_item(at_info_t *ai, work_item_t *it)
+{
+    struct list_head *head;
+    if (it != NULL)
+    {
+        it->enqueue_time = at_get_ms();
+        it->seq = __atomic_fetch_add(&ai->submit_seq, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&ai->list_cnt, 1, __ATOMIC_RELAXED);
+        head = __atomic_load_n(&ai->inbox, __ATOMIC_RELAXED);
+        do
+            it->node.next = head;
+        while (!__atomic_compare_exchange_n(&ai->inbox, &head, &it->node, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+        at_notify(ai);
+    }
+    return it;
+}
+
+/**
+ * @brief  Mark the queued work submitted before 'seq' as aborted (AT task).
+ */
+static void work_abort_before(at_info_t *ai, unsigned short seq)
+{
+    work_item_t *it;
+    int i;
+    for (i = 0; i < AT_PRIORITY_LEVELS; i++)
+    {
+        list_for_each_entry(it, &ai->queues[i], node)
         {
-            if (ai->urc_cnt >= ai->urc_target)
-            {
-                urc_handler_entry(ai, URC_RECV_OK, urc_buf, ai->urc_cnt);
-            }
-            continue;
+            if (seq_before(it->seq, seq))
+                update_work_state(it, AT_WORK_STAT_ABORT, AT_RESP_ABORT);
         }
-        if (strchr(AT_URC_END_MARKS, ch) == NULL && ch != '\0') // Find the URC end mark.
-            continue;
-        urc_buf[ai->urc_cnt] = '\0';
-        if (ai->urc_item == NULL)
-        { // Find the corresponding URC handler
-            ai->urc_item = find_urc_item(ai, urc_buf, ai->urc_cnt);
-            if (ai->urc_item == NULL && ch == '\n')
-            {
-                if (ai->urc_cnt > 2 && ai->cursor == NULL) // Unrecognized URC message
-                    AT_DEBUG(ai, "%s\r\n", urc_buf);
-                urc_reset(ai);
-                continue;
-            }
+    }
+#if AT_CACHE_EN
+    if (ai->cache == NULL)
+        return;
+    at_lock(ai);
+    list_for_each_entry(it, &ai->cache->hits, node)
+    {
+        if (seq_before(it->seq, seq))
+            update_work_state(it, AT_WORK_STAT_ABORT, AT_RESP_ABORT);
+    }
+    for (i = 0; i < ai->cache->count; i++)
+    {
+        list_for_each_entry(it, &ai->cache->entry[i].joins, node)
+        {
+            if (seq_before(it->seq, seq))
+                update_work_state(it, AT_WORK_STAT_ABORT, AT_RESP_ABORT);
         }
-        if (ai->urc_item != NULL && ch == ai->urc_item->endmark)
-            urc_handler_entry(ai, URC_RECV_OK, urc_buf, ai->urc_cnt);
     }
+    at_unlock(ai);
+#endif
+}
+
+/**
+ * @brief  Move the submitted work from the inbox to the queues in submission order, then 
+ *         apply a new abort request (AT task).
+ */
+static void work_inbox_process(at_info_t *ai)
+{
+    unsigned short abort_seq = __atomic_load_n(&ai->abort_seq, __ATOMIC_ACQUIRE);
+    bool aborting = abort_seq != ai->abort_done;
+    struct list_head *pos, *next, *list = NULL;
+    work_item_t *it;
+    if (__atomic_load_n(&ai->inbox, __ATOMIC_RELAXED) != NULL)
+    {
+        pos = __atomic_exchange_n(&ai->inbox, NULL, __ATOMIC_ACQUIRE);
+        for (; pos != NULL; pos = next) // Newest first, reverse it.
+        {
+            next = pos->next;
+            pos->next = list;
+            list = pos;
+        }
+        for (pos = list; pos != NULL; pos = next)
+        {
+            next = pos->next;
+            it = list_entry(pos, work_item_t, node);
+            if (aborting && seq_before(it->seq, abort_seq))
+                update_work_state(it, AT_WORK_STAT_ABORT, AT_RESP_ABORT);
+            work_enqueue(ai, it);
+        }
+    }
+    if (aborting)
+    {
+        ai->abort_done = abort_seq;
+        work_abort_before(ai, abort_seq);
+    }
+}
+
+/**
+ * @brief  Create work and put it in the queue
+ * @param  type  work of type
+ * @param  attr  AT attributes
+ * @param  info  Extra info
+ * @param  size  Extra info size
+ */
+static work_item_t *add_work_item(at_info_t *ai, int type, const at_attr_t *attr, const void *info, int extend_size)
+{
+    work_item_t *it = create_work_item(ai, type, attr, info, extend_size);
+    if (it == NULL)
+        return NULL;
+    return sumit_work_item(ai, it);
+}
+
+#if AT_CACHE_EN
+static bool str_equal(const char *a, const char *b)
+{
+    return a == b || (a != NULL && b != NULL && strcmp(a, b) == 0);
+}
+
+/**
+ * @brief  Find the cache entry of a query (only command and single line work are cached).
+ */
+static cache_entry_t *cache_lookup(at_info_t *ai, const work_item_t *it)
+{
+    const char *cmd;
+    int i;
+#if AT_RESULT_URC_EN
+    if (it->attr.urc != NULL) // Its result is an event, not a state to be cached.
+        return NULL;
+#endif
+    if (it->type == WORK_TYPE_CMD)
+        cmd = it->buf;
+    else if (it->type == WORK_TYPE_SINGLLINE)
+        cmd = it->singlline;
+    else
+        return NULL;
+    for (i = 0; i < ai->cache->count && cmd != NULL; i++)
+    {
+        if (strcmp(ai->cache->entry[i].rule->cmd, cmd) == 0)
+            return &ai->cache->entry[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief  Indicates if the stored response answers a query with the given attributes (it 
+ *         contains the expected prefix and suffix).
+ */
+static bool cache_match(const cache_entry_t *e, const at_attr_t *attr)
+{
+    return (attr->prefix == NULL || mem_find(e->buf, e->len, attr->prefix) != NULL) &&
+           (attr->suffix == NULL || mem_find(e->buf, e->len, attr->suffix) != NULL);
+}
+
+/**
+ * @brief  Answer a query from the cache or join it to the identical query in flight, 
+ *         otherwise the query is sent to the modem (the caller holds the lock).
+ * @return true - the work has been taken over by the cache.
+ */
+static bool cache_submit(at_info_t *ai, work_item_t *it)
+{
+    cache_entry_t *e;
+    if (ai->cache == NULL || (e = cache_lookup(ai, it)) == NULL)
+        return false;
+    it->cache = e - ai->cache->entry + 1;
+    if (e->fresh && AT_IS_TIMEOUT(e->time, e->rule->ttl))
+        e->fresh = 0;
+    if (e->fresh && cache_match(e, &it->attr))
+    {
+        list_add_tail(&it->node, &ai->cache->hits);
+        ai->cache->stat.hits++;
+        return true;
+    }
+    if (e->pending && str_equal(e->prefix, it->attr.prefix) && str_equal(e->suffix, it->attr.suffix))
+    {
+        list_add_tail(&it->node, &e->joins);
+        ai->cache->stat.joins++;
+        return true;
+    }
+    if (e->pending) // Different response matching, it runs on its own.
+        it->cache = 0;
+    else
+    { // It becomes the query in flight.
+        e->pending = 1;
+        e->prefix = it->attr.prefix;
+        e->suffix = it->attr.suffix;
+    }
+    ai->cache->stat.misses++;
+    return false;
+}
+
+/**
+ * @brief  Store the response of the query in flight.
+ */
+static void cache_store(at_info_t *ai, work_item_t *wi, at_resp_code code)
+{
+    cache_entry_t *e = &ai->cache->entry[wi->cache - 1];
+    at_lock(ai);
+    e->shared = ai->recv_cnt < sizeof(e->buf) && ai->recv_dropped == 0;
+    e->fresh = e->shared && code == AT_RESP_OK;
+    if (e->shared)
+    {
+        memcpy(e->buf, ai->recvbuf, ai->recv_cnt);
+        e->len = ai->recv_cnt;
+        e->code = code;
+        e->time = at_get_ms();
+    }
+    at_unlock(ai);
+}
+
+/**
+ * @brief  Complete a query answered by the cache (a copy of the response is passed, the 
+ *         callback may modify it), then recycle it.
+ */
+static void cache_deliver(at_info_t *ai, work_item_t *wi, const cache_entry_t *e)
+{
+    char buf[AT_CACHE_RESP_SIZE];
+    at_fail_class cls;
+    at_response_t r;
+    char *p;
+    if (wi->state != AT_WORK_STAT_ABORT)
+    {
+        memcpy(buf, e->buf, e->len);
+        buf[e->len] = '\0';
+#if AT_WORK_CONTEXT_EN
+        at_context_t *ctx = wi->attr.ctx;
+        if (ctx != NULL && ctx->respbuf != NULL)
+        {
+            ctx->resplen = e->len >= ctx->bufsize ? ctx->bufsize - 1 : e->len;
+            memcpy(ctx->respbuf, buf, ctx->resplen);
+        }
+#endif
+        update_work_state(wi, AT_WORK_STAT_FINISH, (at_resp_code)e->code);
+#if AT_SYNC_EN
+        if (wi->attr.cb || wi->sync != NULL)
+#else
+        if (wi->attr.cb)
+#endif
+        {
+            r.obj = &ai->obj;
+            r.params = wi->attr.params;
+            r.recvbuf = buf;
+            r.recvcnt = e->len;
+            r.code = (at_resp_code)e->code;
+            p = wi->attr.prefix != NULL ? mem_find(buf, e->len, wi->attr.prefix) : NULL;
+            r.prefix = p != NULL ? p : buf;
+            p = wi->attr.suffix != NULL ? mem_find(r.prefix, e->len - (r.prefix - buf), wi->attr.suffix) : NULL;
+            r.suffix = p != NULL ? p : buf;
+            r.dropped = 0;
+            r.error = -1;
+#if AT_RESULT_URC_EN
+            r.urc = NULL;
+#endif
+            if (r.code == AT_RESP_ERROR)
+                error_parse(buf, e->len, &cls, &r.error);
+#if AT_SYNC_EN
+            if (wi->sync != NULL)
+                sync_complete(wi, &r);
+#endif
+            if (wi->attr.cb)
+                wi->attr.cb(&r);
+        }
+    }
+    work_item_recycle(ai, wi);
+}
+
+/**
+ * @brief  Deliver the queries answered from the cache.
+ */
+static void cache_hit_process(at_info_t *ai)
+{
+    struct list_head hits;
+    work_item_t *it, *n;
+    INIT_LIST_HEAD(&hits);
+    at_lock(ai);
+    list_splice_init(&ai->cache->hits, &hits);
+    at_unlock(ai);
+    list_for_each_entry_safe(it, n, &hits, node)
+        cache_deliver(ai, it, &ai->cache->entry[it->cache - 1]);
+}
+
+/**
+ * @brief  The query in flight has ended, the joined work shares its response. If it was 
+ *         aborted or its response could not be stored, the joined work is queued again.
+ */
+static void cache_release(at_info_t *ai, work_item_t *wi)
+{
+    cache_entry_t *e = &ai->cache->entry[wi->cache - 1];
+    struct list_head joins;
+    work_item_t *it, *n;
+    bool shared;
+    INIT_LIST_HEAD(&joins);
+    at_lock(ai);
+    shared = e->shared && wi->state != AT_WORK_STAT_ABORT;
+    e->pending = 0;
+    e->shared = 0;
+    list_splice_init(&e->joins, &joins);
+    at_unlock(ai);
+    list_for_each_entry_safe(it, n, &joins, node)
+    {
+        if (shared || it->state == AT_WORK_STAT_ABORT)
+        {
+            cache_deliver(ai, it, e);
+            continue;
+        }
+        list_del(&it->node);
+        it->cache = 0;
+        work_enqueue(ai, it);
+    }
+}
+
+#if AT_URC_WARCH_EN
+/**
+ * @brief  Invalidate the cached responses whose URC prefix is found in a URC frame.
+ */
+static void cache_urc_process(at_info_t *ai, const char *urc, unsigned int size)
+{
+    cache_entry_t *e;
+    int i;
+    for (i = 0; i < ai->cache->count; i++)
+    {
+        e = &ai->cache->entry[i];
+        if (!e->fresh || e->rule->urc == NULL || mem_find(urc, size, e->rule->urc) == NULL)
+            continue;
+        at_lock(ai);
+        e->fresh = 0;
+        ai->cache->stat.invalidations++;
+        at_unlock(ai);
+        AT_DEBUG(ai, "Cached '%s' invalidated\r\n", e->rule->cmd);
+    }
+}
+#endif
+#endif
+
+/**
+ * @brief  Make room for 'size' failure function entries in the match table, the entries
+ *         already computed are kept (the table only grows, to the longest patterns used).
+ * @return false - insufficient memory.
+ */
+static bool match_table_reserve(at_info_t *ai, unsigned int size)
+{
+    unsigned short *table;
+    if (size <= ai->match_table_size)
+        return true;
+    size = (size + 15u) & ~15u;
+    table = at_core_malloc(size * sizeof(unsigned short));
+    if (table == NULL)
+    {
+        AT_DEBUG(ai, "No memory for the match table\r\n");
+        return false;
+    }
+    if (ai->match_table != NULL)
+    {
+        memcpy(table, ai->match_table, ai->match_table_size * sizeof(unsigned short));
+        at_core_free(ai->match_table);
+    }
+    ai->match_table = table;
+    ai->match_table_size = size;
+    return true;
+}
+
+/**
+ * @brief  Initialize a matcher and precompute the failure function of its pattern.
+ * @param  len  Pattern length.
+ * @param  fail Failure function table (one entry per pattern character).
+ */
+static void matcher_init(str_matcher_t *m, const char *pat, unsigned int len, unsigned short *fail)
+{
+    unsigned short q, k = 0;
+    m->pat = pat;
+    m->len = len;
+    m->cnt = 0;
+    m->fail = fail;
+    if (m->len > 0)
+        fail[0] = 0;
+    for (q = 1; q < m->len; q++)
+    {
+        while (k > 0 && pat[q] != pat[k])
+            k = fail[k - 1];
+        if (pat[q] == pat[k])
+            k++;
+        fail[q] = k;
+    }
+}
+
+/**
+ * @brief  Get the length of the longest proper prefix of pat[0..q) which is also its suffix.
+ */
+static inline unsigned short matcher_border(const str_matcher_t *m, unsigned short q)
+{
+    return m->fail[q - 1];
+}
+
+/**
+ * @brief  Feed one character to the matcher.
+ * @return true - the pattern has been matched, it ends at this character.
+ */
+static inline bool matcher_feed(str_matcher_t *m, char ch)
+{
+    unsigned short q = m->cnt;
+    if (m->pat[q] != ch)
+    {
+        if (q == 0) // Fast path: nothing matched yet.
+            return false;
+        do
+            q = matcher_border(m, q);
+        while (q > 0 && m->pat[q] != ch);
+    }
+    if (m->pat[q] == ch)
+        q++;
+    if (q == m->len)
+    {
+        m->cnt = matcher_border(m, q);
+        return true;
+    }
+    m->cnt = q;
+    return false;
+}
+
+/**
+ * @brief  Restart matching from the beginning of the receive buffer.
+ */
+static void match_info_reset(at_info_t *ai)
+{
+    ai->prefix = ai->suffix = NULL;
+    ai->match_len = 0;
+    ai->match_mask = 0;
+    if (ai->prefix_matcher.len == 0)
+        ai->match_mask |= MATCH_MASK_PREFIX;
+    if (ai->suffix_matcher.len == 0)
+        ai->match_mask |= MATCH_MASK_SUFFIX;
+    ai->prefix_matcher.cnt = 0;
+    ai->suffix_matcher.cnt = 0;
+    ai->error_matcher.cnt = 0;
+}
+
+/**
+ * @brief  Initialize matching info
+ * @param  prefix Response prefix, NULL if not required.
+ * @param  suffix Response suffix, NULL if not required.
+ * @return false - insufficient memory for the failure functions of the patterns.
+ */
+static bool match_info_init(at_info_t *ai, const char *prefix, const char *suffix)
+{
+    unsigned int plen = prefix != NULL ? strlen(prefix) : 0;
+    unsigned int slen = suffix != NULL ? strlen(suffix) : 0;
+    unsigned short *table;
+    if (!match_table_reserve(ai, plen + slen + sizeof(AT_DEF_RESP_ERR) - 1))
+        return false;
+    table = ai->match_table;
+    matcher_init(&ai->prefix_matcher, prefix, plen, table);
+    matcher_init(&ai->suffix_matcher, suffix, slen, table + plen);
+    matcher_init(&ai->error_matcher, AT_DEF_RESP_ERR, sizeof(AT_DEF_RESP_ERR) - 1, table + plen + slen);
+    match_info_reset(ai);
+    return true;
+}
+
+/**
+ * @brief  Feed the receive buffer from 'start' to 'end' to the suffix matcher.
+ */
+static void suffix_match(at_info_t *ai, unsigned short start, unsigned short end)
+{
+    for (; start < end; start++)
+    {
+        if (matcher_feed(&ai->suffix_matcher, ai->recvbuf[start]))
+        {
+            ai->suffix = ai->recvbuf + start + 1 - ai->suffix_matcher.len;
+            ai->match_mask |= MATCH_MASK_SUFFIX;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief  Match the newly received response data (the prefix, the suffix after the prefix, 
+ *         and the error identifier), resuming from where the last call stopped.
+ */
+static void response_match(at_info_t *ai)
+{
+    unsigned short i, start;
+    if (ai->recv_cnt < ai->match_len) // The receive buffer has been emptied, start over.
+        match_info_reset(ai);
+    for (i = ai->match_len; i < ai->recv_cnt; i++)
+    {
+        if (!(ai->match_mask & MATCH_MASK_PREFIX))
+        {
+            if (matcher_feed(&ai->prefix_matcher, ai->recvbuf[i]))
+            {
+                ai->prefix = ai->recvbuf + i + 1 - ai->prefix_matcher.len;
+                ai->match_mask |= MATCH_MASK_PREFIX;
+                // The suffix is searched from the start of the prefix.
+                start = ai->prefix - ai->recvbuf;
+                if (!(ai->match_mask & MATCH_MASK_SUFFIX))
+                    suffix_match(ai, start, i + 1);
+            }
+        }
+        else if (!(ai->match_mask & MATCH_MASK_SUFFIX))
+        {
+            suffix_match(ai, i, i + 1);
+        }
+        if (!(ai->match_mask & MATCH_MASK_ERROR) && matcher_feed(&ai->error_matcher, ai->recvbuf[i]))
+            ai->match_mask |= MATCH_MASK_ERROR;
+    }
+    ai->match_len = ai->recv_cnt;
+}
+
+/**
+ * @brief Custom work processing
+ */
+static int do_work_handler(at_info_t *ai)
+{
+    work_item_t *i = ai->cursor;
+    if (ai->next_delay > 0)
+    {
+        if (!AT_IS_TIMEOUT(ai->delay_timer, ai->next_delay))
+            return 0;
+        ai->next_delay = 0;
+    }
+    return ((int (*)(at_env_t *e))i->work)(&ai->env);
+}
+
+#if AT_COROUTINE_EN
+/**
+ * @brief Await state of a coroutine work.
+ */
+enum
+{
+    CO_RUN = 0, /* Running, it is resumed on every cycle*/
+    CO_SLEEP,   /* Sleeping for next_delay*/
+    CO_RESP,    /* Waiting for the response of a command, or for a URC*/
+    CO_DONE     /* The await has ended, its result is in co_result*/
+};
+
+/**
+ * @brief  Coroutine work processing, the coroutine is only resumed once what it awaits has 
+ *         ended.
+ */
+static int do_coroutine_handler(at_info_t *ai)
+{
+    at_fail_class cls;
+    int code;
+    if (ai->co_wait == CO_RESP)
+    {
+        if (ai->match_len != ai->recv_cnt)
+            response_match(ai);
+        if (!ai->co_urc && (ai->match_mask & (MATCH_MASK_ERROR | MATCH_MASK_SUFFIX)))
+            rto_sample(ai);
+        if (ai->match_mask & MATCH_MASK_SUFFIX)
+            ai->co_result = AT_RESP_OK;
+        else if (!ai->co_urc && (ai->match_mask & MATCH_MASK_ERROR) &&
+                 error_parse(ai->recvbuf, ai->recv_cnt, &cls, &code))
+            ai->co_result = AT_RESP_ERROR;
+        else if (ai->co_urc ? AT_IS_TIMEOUT(ai->delay_timer, ai->next_delay) : AT_IS_TIMEOUT(ai->timer, ai->resp_timeout))
+        {
+            if (!ai->co_urc)
+                rto_timeout(ai);
+            ai->co_result = AT_RESP_TIMEOUT;
+        }
+        else
+            return false;
+        ai->next_delay = 0;
+        ai->co_wait = CO_DONE;
+    }
+    else if (ai->next_delay > 0) // Sleeping, or a next_wait of the coroutine.
+    {
+        if (!AT_IS_TIMEOUT(ai->delay_timer, ai->next_delay))
+            return false;
+        ai->next_delay = 0;
+        if (ai->co_wait == CO_SLEEP)
+        {
+            ai->co_result = AT_RESP_OK;
+            ai->co_wait = CO_DONE;
+        }
+    }
+    return ai->cursor->work(&ai->env);
+}
+
+/**
+ * @brief  Suspend the coroutine for some time.
+ */
+static void co_sleep(at_info_t *ai, unsigned int ms)
+{
+    ai->next_delay = ms != 0 ? ms : 1;
+    ai->delay_timer = at_get_ms();
+    ai->co_wait = CO_SLEEP;
+}
+
+/**
+ * @brief  Send the awaited command and start matching its response.
+ */
+static void co_send(at_info_t *ai, const at_attr_t *attr, const char *cmd, va_list va)
+{
+    char *line = NULL;
+    va_list args;
+    int len;
+    va_copy(args, va);
+    len = vsnprintf(NULL, 0, cmd, args); // Measure first, the line is formatted once.
+    va_end(args);
+    if (len >= 0)
+        line = at_core_malloc(len + 1);
+    if (line == NULL || !match_info_init(ai, attr->prefix, attr->suffix))
+    { // Not sent, the await ends with an error.
+        at_core_free(line);
+        ai->co_result = AT_RESP_ERROR;
+        ai->co_wait = CO_DONE;
+        return;
+    }
+    vsnprintf(line, len + 1, cmd, va);
+    if (len > 0)
+    {
+        send_line(ai, line, len);
+        AT_DEBUG(ai, "->\r\n%s\r\n", line);
+    }
+    rto_begin(ai, line, attr->timeout, ai->co_resends > 0);
+    at_core_free(line);
+    ai->co_wait = CO_RESP;
+    ai->co_urc = 0;
+    ai->env.reset_timer(&ai->env);
+    ai->env.recvclr(&ai->env);
+}
+#endif
+
+#if AT_RESULT_URC_EN
+/**
+ * @brief  Offset of the data received after the response of the command.
+ */
+static unsigned int result_urc_start(at_info_t *ai)
+{
+    return ai->suffix != NULL ? ai->suffix - ai->recvbuf + ai->suffix_matcher.len : 0;
+}
+
+/**
+ * @brief  Start waiting for the result URC: the error matcher, which is no longer needed once
+ *         the response has ended, looks for the URC prefix in the data after the response (the
+ *         response prefix and suffix stay valid).
+ */
+static bool result_urc_begin(at_info_t *ai, const char *urc)
+{
+    unsigned int used = ai->prefix_matcher.len + ai->suffix_matcher.len, len = strlen(urc);
+    if (!match_table_reserve(ai, used + len))
+        return false;
+    ai->prefix_matcher.fail = ai->match_table; // The table may have moved.
+    ai->suffix_matcher.fail = ai->match_table + ai->prefix_matcher.len;
+    matcher_init(&ai->error_matcher, urc, len, ai->match_table + used);
+    ai->match_mask &= ~MATCH_MASK_ERROR;
+    ai->match_len = result_urc_start(ai);
+    return true;
+}
+
+/**
+ * @brief  Find the complete result URC line received after the response.
+ * @return Pointer to the URC in the receive buffer, NULL if it has not been received yet.
+ */
+static char *result_urc_find(at_info_t *ai, const char *urc)
+{
+    unsigned int start = result_urc_start(ai);
+    char *p = start < ai->recv_cnt ? mem_find(ai->recvbuf + start, ai->recv_cnt - start, urc) : NULL;
+    return p != NULL && memchr(p, '\n', ai->recv_cnt - (p - ai->recvbuf)) != NULL ? p : NULL;
+}
+#endif
+
+/**
+ * @brief  An attempt of the running command failed: it is resent according to the retry
+ *         settings, or the work ends.
+ * @return true if the work has ended.
+ */
+static bool cmd_failed(at_info_t *ai, work_item_t *wi, at_fail_class cls, int code)
+{
+    at_env_t *env = &ai->env;
+    if (!retry_check(ai, wi, env->i++, cls, code))
+    {
+        do_at_callback(ai, wi, cls == AT_FAIL_TIMEOUT ? AT_RESP_TIMEOUT : AT_RESP_ERROR);
+        return true;
+    }
+    // After an error response it waits for a while before resending.
+    env->state = cls != AT_FAIL_TIMEOUT || ai->retry_delay != 0 ? AT_STAT_RETRY : AT_STAT_SEND;
+    env->reset_timer(env);
+    STATS_RETRY(ai);
+    return false;
+}
+
+/**
+ * @brief  Generic commands processing
+ */
+static int do_cmd_handler(at_info_t *ai)
+{
+    work_item_t *wi = ai->cursor;
+    at_env_t *env = &ai->env;
+    at_attr_t *attr = &wi->attr;
+#if AT_PAYLOAD_EN
+    payload_info_t pi;
+#endif
+    at_fail_class cls;
+    int code;
+    switch (env->state)
+    {
+    case AT_STAT_SEND:
+        if (wi->type == WORK_TYPE_CUSTOM && wi->sender != NULL)
+        {
+            wi->sender(env);
+        }
+        else if (wi->type == WORK_TYPE_BUF)
+        {
+            send_data(ai, wi->buf, wi->bufsize);
+        }
+        else if (wi->type == WORK_TYPE_SINGLLINE)
+        {
+            send_cmdline(ai, wi->singlline);
+        }
+#if AT_PAYLOAD_EN
+        else if (wi->type == WORK_TYPE_PAYLOAD)
+        {
+            send_cmdline(ai, payload_line(wi));
+        }
+#endif
+        else
+        {
+            send_cmdline(ai, wi->buf);
+        }
+        STATS_SEND(ai);
+        rto_begin(ai, wi->type == WORK_TYPE_CMD ? wi->buf : wi->type == WORK_TYPE_SINGLLINE ? wi->singlline : NULL,
+                  attr->timeout, env->i > 0);
+        env->state = AT_STAT_RECV;
+        env->reset_timer(env);
+        env->recvclr(env);
+#if AT_PAYLOAD_EN
+        if (wi->type == WORK_TYPE_PAYLOAD)
+        { // The prompt is matched as soon as it arrives, it is not followed by a line end.
+            env->state = AT_STAT_PROMPT;
+            if (!match_info_init(ai, NULL, AT_DEF_PROMPT))
+            {
+                do_at_callback(ai, wi, AT_RESP_ERROR);
+                return true;
+            }
+            break;
+        }
+#endif
+        if (!match_info_init(ai, attr->prefix, attr->suffix))
+        {
+            do_at_callback(ai, wi, AT_RESP_ERROR);
+            return true;
+        }
+        break;
+    case AT_STAT_RECV: /*Receive information and matching processing.*/
+        if (ai->match_len != ai->recv_cnt)
+            response_match(ai);
+        if (ai->match_mask & (MATCH_MASK_ERROR | MATCH_MASK_SUFFIX))
+            rto_sample(ai);
+        if ((ai->match_mask & MATCH_MASK_ERROR) && error_parse(ai->recvbuf, ai->recv_cnt, &cls, &code))
+        {
+            AT_DEBUG(ai, "<-\r\n%s\r\n", ai->recvbuf);
+            if (cmd_failed(ai, wi, cls, code))
+                return true;
+        }
+        if (ai->match_mask & MATCH_MASK_SUFFIX)
+        {
+#if AT_RESULT_URC_EN
+            if (attr->urc != NULL)
+            {
+                if (!result_urc_begin(ai, attr->urc))
+                {
+                    do_at_callback(ai, wi, AT_RESP_ERROR);
+                    return true;
+                }
+                env->state = AT_STAT_URC;
+                env->reset_timer(env);
+                break;
+            }
+#endif
+            do_at_callback(ai, wi, AT_RESP_OK);
+            return true;
+        }
+        else if (env->is_timeout(env, ai->resp_timeout))
+        {
+            AT_DEBUG(ai, "Command response timeout, retry:%d\r\n", env->i);
+            rto_timeout(ai);
+            if (cmd_failed(ai, wi, AT_FAIL_TIMEOUT, -1))
+                return true;
+        }
+        break;
+    case AT_STAT_RETRY:
+        if (env->is_timeout(env, ai->retry_delay))
+            env->state = AT_STAT_SEND; /*Go back to the send state*/
+        break;
+#if AT_PAYLOAD_EN
+    case AT_STAT_PROMPT: /*Wait for the prompt, then write the payload.*/
+        payload_info(wi, &pi);
+        if (ai->match_len != ai->recv_cnt)
+            response_match(ai);
+        if (ai->match_mask & MATCH_MASK_SUFFIX)
+        {
+            env->state = AT_STAT_PAYLOAD;
+            env->j = 0;
+            env->reset_timer(env);
+        }
+        else if ((ai->match_mask & MATCH_MASK_ERROR) && error_parse(ai->recvbuf, ai->recv_cnt, &cls, &code))
+        {
+            AT_DEBUG(ai, "<-\r\n%s\r\n", ai->recvbuf);
+            if (cmd_failed(ai, wi, cls, code))
+                return true;
+            break;
+        }
+        else if (env->is_timeout(env, pi.prompt_timeout))
+        {
+            AT_DEBUG(ai, "Prompt timeout, retry:%d\r\n", env->i);
+            if (cmd_failed(ai, wi, AT_FAIL_TIMEOUT, -1))
+                return true;
+            break;
+        }
+        else
+            break;
+        /* fall through */
+    case AT_STAT_PAYLOAD:
+        payload_info(wi, &pi);
+        // Written straight from the caller's buffer (or the copy in the work item), a write
+        // that is not accepted at once is resumed on the next cycles.
+        env->j += send_data(ai, payload_data(wi, &pi) + env->j, pi.len - env->j);
+        if ((unsigned int)env->j < pi.len)
+        {
+            if (env->is_timeout(env, ai->resp_timeout) && cmd_failed(ai, wi, AT_FAIL_TIMEOUT, -1))
+                return true;
+            break;
+        }
+        AT_DEBUG(ai, "->\r\n<%u bytes>\r\n", pi.len);
+        env->state = AT_STAT_RECV;
+        env->reset_timer(env);
+        env->recvclr(env);
+        if (!match_info_init(ai, attr->prefix, attr->suffix))
+        {
+            do_at_callback(ai, wi, AT_RESP_ERROR);
+            return true;
+        }
+        break;
+#endif
+#if AT_RESULT_URC_EN
+    case AT_STAT_URC: /*The response has ended, wait for the result URC.*/
+        if (ai->match_len != ai->recv_cnt)
+            response_match(ai);
+        if ((ai->match_mask & MATCH_MASK_ERROR) && result_urc_find(ai, attr->urc) != NULL)
+        {
+            do_at_callback(ai, wi, AT_RESP_OK);
+            return true;
+        }
+        else if (env->is_timeout(env, attr->urc_timeout))
+        {
+            AT_DEBUG(ai, "Result URC '%s' timeout\r\n", attr->urc);
+            do_at_callback(ai, wi, AT_RESP_TIMEOUT); // The command may have taken effect, it is not resent.
+            return true;
+        }
+        break;
+#endif
+    default:
+        env->state = AT_STAT_SEND;
+    }
+    return false;
+}
+
+/**
+ * @brief  Multi-line command sending processing.
+ */
+static int send_multiline_handler(at_info_t *ai)
+{
+    work_item_t *wi = ai->cursor;
+    at_env_t *env = &ai->env;
+    at_attr_t *attr = &wi->attr;
+    const char **cmds = wi->multiline;
+    at_fail_class cls;
+    int code;
+
+    switch (env->state)
+    {
+    case AT_STAT_SEND:
+        if (cmds[env->i] == NULL)
+        { /* All commands are sent.*/
+            do_at_callback(ai, wi, env->params ? AT_RESP_OK : AT_RESP_ERROR);
+            return true;
+        }
+        send_cmdline(ai, cmds[env->i]);
+        STATS_SEND(ai);
+        rto_begin(ai, cmds[env->i], attr->timeout, env->j > 0);
+        env->recvclr(env);
+        env->reset_timer(env);
+        env->state = AT_STAT_RECV;
+        if (!match_info_init(ai, NULL, attr->suffix)) // Only the suffix is matched for multiline commands.
+        {
+            do_at_callback(ai, wi, AT_RESP_ERROR);
+            return true;
+        }
+        break;
+    case AT_STAT_RECV:
+        if (ai->match_len != ai->recv_cnt)
+            response_match(ai);
+        if (ai->match_mask & (MATCH_MASK_ERROR | MATCH_MASK_SUFFIX))
+            rto_sample(ai);
+        if (ai->match_mask & MATCH_MASK_SUFFIX)
+        {
+            env->state = 0;
+            env->i++;
+            env->j = 0;
+            env->params = (void *)true; /*Mark execution status*/
+            AT_DEBUG(ai, "<-\r\n%s\r\n", ai->recvbuf);
+        }
+        else if ((ai->match_mask & MATCH_MASK_ERROR) && error_parse(ai->recvbuf, ai->recv_cnt, &cls, &code))
+        {
+            AT_DEBUG(ai, "<-\r\n%s\r\n", ai->recvbuf);
+            AT_DEBUG(ai, "CMD:'%s' failed to executed, retry:%d\r\n", cmds[env->i], env->j);
+            if (!retry_check(ai, wi, env->j++, cls, code))
+            {
+                if (attr->stop_on_error)
+                {
+                    do_at_callback(ai, wi, AT_RESP_ERROR); // The failed line ends the command.
+                    return true;
+                }
+                env->state = 0; // The failed line is skipped.
+                env->i++;
+                env->j = 0;
+                break;
+            }
+            env->state = AT_STAT_RETRY; // After the command responds incorrect, try again after a period of time.
+            env->reset_timer(env);
+            STATS_RETRY(ai);
+        }
+        else if (env->is_timeout(env, ai->resp_timeout))
+        {
+            AT_DEBUG(ai, "CMD:'%s' response timeout, retry:%d\r\n", cmds[env->i], env->j);
+            rto_timeout(ai);
+            if (!retry_check(ai, wi, env->j++, AT_FAIL_TIMEOUT, -1))
+            {
+                do_at_callback(ai, wi, AT_RESP_TIMEOUT);
+                return true;
+            }
+            env->state = ai->retry_delay != 0 ? AT_STAT_RETRY : AT_STAT_SEND;
+            env->reset_timer(env);
+            STATS_RETRY(ai);
+        }
+        break;
+    case AT_STAT_RETRY:
+        if (env->is_timeout(env, ai->retry_delay))
+            env->state = AT_STAT_SEND; /*Go back to the send state and resend.*/
+        break;
+    default:
+        env->state = AT_STAT_SEND;
+    }
+    return 0;
+}
+
+/**
+ * @brief       Send command line
+ */
+static void at_send_line(at_info_t *ai, const char *fmt, va_list args)
+{
+    int len;
+    char *cmdline;
+    va_list va;
+    va_copy(va, args);
+    len = vsnprintf(NULL, 0, fmt, va); // Measure the formatted length first.
+    va_end(va);
+    if (len < 0)
+        return;
+    // From the heap: raw lines must not take the pool blocks reserved for the work items.
+    cmdline = at_core_malloc(len + 1);
+    if (cmdline == NULL)
+    {
+        AT_DEBUG(ai, "Malloc failed when send...\r\n");
+        return;
+    }
+    vsnprintf(cmdline, len + 1, fmt, args);
+    // Clear receive buffer.
+    ai->recv_cnt = 0;
+    ai->recvbuf[0] = '\0';
+    send_line(ai, cmdline, len);
+    AT_DEBUG(ai, "->\r\n%s\r\n", cmdline);
+
+    at_core_free(cmdline);
+}
+
+#if AT_URC_WARCH_EN
+
+#if AT_URC_MATCHER_EN
+/**
+ * @brief  Get the next automaton state from state 's' on input 'ch'.
+ */
+static unsigned short urc_node_next(const urc_node_t *nodes, unsigned short s, unsigned char ch)
+{
+    unsigned short c;
+    for (;;)
+    {
+        for (c = nodes[s].child; c != 0; c = nodes[c].sibling)
+        {
+            if (nodes[c].ch == ch)
+                return c;
+        }
+        if (s == 0)
+            return 0;
+        s = nodes[s].fail;
+    }
+}
+
+/**
+ * @brief  Count the trie nodes needed by the URC table (distinct prefixes of all prefixes).
+ */
+static unsigned int urc_node_count(const urc_item_t *tbl, int count)
+{
+    unsigned int nodes = 1; // Root node
+    int i, j, len, n;
+    for (i = 0; i < count; i++)
+    {
+        len = strlen(tbl[i].prefix);
+        for (n = 1; n <= len; n++)
+        {
+            for (j = 0; j < i; j++)
+            {
+                if ((int)strlen(tbl[j].prefix) >= n && strncmp(tbl[i].prefix, tbl[j].prefix, n) == 0)
+                    break;
+            }
+            if (j == i) // First table item with this prefix.
+                nodes++;
+        }
+    }
+    return nodes;
+}
+
+/**
+ * @brief  Build the URC matcher automaton.
+ * @return Automaton nodes, NULL if there is not enough memory.
+ */
+static urc_node_t *urc_matcher_build(const urc_item_t *tbl, int count)
+{
+    unsigned int size = urc_node_count(tbl, count);
+    unsigned short *queue;
+    unsigned short used = 1, head = 0, tail = 0;
+    unsigned short s, c, f;
+    const unsigned char *p;
+    urc_node_t *nodes;
+    int i;
+    if (size > 0xFFFF)
+        return NULL;
+    nodes = at_core_malloc(size * sizeof(urc_node_t));
+    queue = at_core_malloc(size * sizeof(unsigned short));
+    if (nodes == NULL || queue == NULL)
+    {
+        at_core_free(nodes);
+        at_core_free(queue);
+        return NULL;
+    }
+    memset(nodes, 0, size * sizeof(urc_node_t));
+    // Build the trie, the first item in the table wins on identical prefixes.
+    for (i = 0; i < count; i++)
+    {
+        s = 0;
+        for (p = (const unsigned char *)tbl[i].prefix; *p != '\0'; p++)
+        {
+            for (c = nodes[s].child; c != 0 && nodes[c].ch != *p; c = nodes[c].sibling)
+                ;
+            if (c == 0)
+            {
+                c = used++;
+                nodes[c].ch = *p;
+                nodes[c].sibling = nodes[s].child;
+                nodes[s].child = c;
+            }
+            s = c;
+        }
+        if (nodes[s].out == 0)
+            nodes[s].out = i + 1;
+    }
+    // Breadth-first: compute the failure links and merge the outputs along them, so that 
+    // each state directly reports the first table item that ends at it.
+    for (c = nodes[0].child; c != 0; c = nodes[c].sibling)
+        queue[tail++] = c;
+    while (head < tail)
+    {
+        s = queue[head++];
+        if (nodes[s].out == 0 || (nodes[nodes[s].fail].out != 0 && nodes[nodes[s].fail].out < nodes[s].out))
+            nodes[s].out = nodes[nodes[s].fail].out;
+        for (c = nodes[s].child; c != 0; c = nodes[c].sibling)
+        {
+            f = urc_node_next(nodes, nodes[s].fail, nodes[c].ch);
+            nodes[c].fail = f;
+            queue[tail++] = c;
+        }
+    }
+    at_core_free(queue);
+    return nodes;
+}
+#endif
+
+/**
+ * @brief   Set the AT urc table.
+ */
+void at_obj_set_urc(at_obj_t *at, const urc_item_t *tbl, int count)
+{
+    at_info_t *ai = obj_map(at);
+    ai->urc_tbl = tbl;
+    ai->urc_tbl_size = count;
+#if AT_URC_MATCHER_EN
+    at_core_free(ai->urc_nodes);
+    ai->urc_nodes = NULL;
+    ai->urc_state = 0;
+    ai->urc_hit = 0;
+    if (tbl != NULL && count > 0)
+    {
+        ai->urc_nodes = urc_matcher_build(tbl, count);
+        if (ai->urc_nodes == NULL)
+            AT_DEBUG(ai, "No memory for the URC matcher, use linear scan.\r\n");
+    }
+#endif
+}
+
+/**
+ * @brief   Get the number of bytes in the URC receive buffer.
+ */
+int at_obj_get_urcbuf_count(at_obj_t *at)
+{
+    return obj_map(at)->urc_cnt;
+}
+
+/**
+ * @brief   Enable/Disable the URC match handler.
+ * @param   enable  URC match enable
+ * @param   timeout Disable time(ms), the URC matching is re-enabled automatically 
+ *                  when it expires.
+ */
+void at_obj_urc_set_enable(at_obj_t *at, int enable, unsigned short timeout)
+{
+    at_info_t *ai = obj_map(at);
+    ai->urc_enable = enable ? 1 : 0;
+    if (!enable)
+    {
+        ai->urc_timer = at_get_ms();
+        ai->urc_disable_time = timeout;
+    }
+}
+/**
+ * @brief Find a URC handler based on URC receive buffer information.
+ */
+const urc_item_t *find_urc_item(at_info_t *ai, char *urc_buf, unsigned int size)
+{
+    const urc_item_t *tbl = ai->urc_tbl;
+    int i;
+    for (i = 0; i < ai->urc_tbl_size && tbl; i++, tbl++)
+    {
+        if (mem_find(urc_buf, size, tbl->prefix))
+            return tbl;
+    }
+    return NULL;
+}
+
+static void urc_reset(at_info_t *ai)
+{
+    ai->urc_target = 0;
+    ai->urc_cnt = 0;
+    ai->urc_item = NULL;
+    ai->urc_match = 0;
+    ai->urc_stream = 0;
+    ai->urc_remain = 0;
+    ai->urc_skip = 0;
+#if AT_URC_MATCHER_EN
+    ai->urc_state = 0;
+    ai->urc_hit = 0;
+#endif
+}
+
+/**
+ * @brief       URC(unsolicited code) handler entry.
+ * @param[in]   urc    - URC receive buffer
+ * @param[in]   size   - URC receive buffer length
+ * @return      none
+ */
+static void urc_handler_entry(at_info_t *ai, urc_recv_status status, char *urc, unsigned int size)
+{
+    int remain;
+    at_urc_info_t ctx = {status, urc, size, 0};
+    if (ai->urc_target > 0)
+        AT_DEBUG(ai, "<=\r\n%.5s..\r\n", urc);
+    else
+        AT_DEBUG(ai, "<=\r\n%s\r\n", urc);
+    /* Send URC event notification. */
+    remain = ai->urc_item ? ai->urc_item->handler(&ctx) : 0;
+    if (ai->urc_item != NULL && ai->urc_item->data != NULL)
+    {
+        // Streaming item: the header has been parsed, the payload bypasses the URC buffer.
+        // An incomplete header (URC_STREAM_MORE) waits for the next end mark.
+        if (status != URC_RECV_OK || remain == 0)
+            urc_reset(ai);
+        else if (remain > 0)
+        {
+            AT_DEBUG(ai, "URC streams %d bytes.\r\n", remain);
+            ai->urc_stream = 1;
+            ai->urc_remain = remain;
+            ai->urc_skip = ctx.skip > 0 ? ctx.skip : 0;
+            ai->urc_cnt = 0;
+        }
+        return;
+    }
+    if (remain == 0 && (ai->urc_item || ai->cursor == NULL))
+    {
+        urc_reset(ai);
+    }
+    else
+    {
+        AT_DEBUG(ai, "URC receives %d bytes remaining.\r\n", remain);
+        ai->urc_target = ai->urc_cnt + remain;
+        ai->urc_match = true;
+    }
+}
+
+/**
+ * @brief       End the payload stream of the current URC.
+ */
+static void urc_stream_end(at_info_t *ai, urc_recv_status status)
+{
+    const urc_item_t *item = ai->urc_item;
+    urc_reset(ai);
+    if (item->end != NULL)
+        item->end(status);
+}
+
+/**
+ * @brief       Pass the received payload of a streaming URC to its data handler.
+ * @return      Number of bytes consumed.
+ */
+static unsigned int urc_stream_process(at_info_t *ai, const char *buf, unsigned int size)
+{
+    unsigned int n;
+    if (ai->urc_skip > 0)
+    {
+        n = size < ai->urc_skip ? size : ai->urc_skip;
+        ai->urc_skip -= n;
+        return n;
+    }
+    n = size < ai->urc_remain ? size : ai->urc_remain;
+    ai->urc_item->data(buf, n);
+    ai->urc_remain -= n;
+    if (ai->urc_remain == 0)
+        urc_stream_end(ai, URC_RECV_OK);
+    return n;
+}
+
+static void urc_timeout_process(at_info_t *ai)
+{
+    if (ai->urc_stream && AT_IS_TIMEOUT(ai->urc_timer, AT_URC_TIMEOUT))
+    {
+        AT_DEBUG(ai, "urc stream timeout, %d bytes missing\r\n", ai->urc_remain);
+        urc_stream_end(ai, URC_RECV_TIMEOUT);
+        return;
+    }
+    // Receive timeout processing, default (MAX_URC_RECV_TIMEOUT).
+    if (ai->urc_cnt > 0 && AT_IS_TIMEOUT(ai->urc_timer, AT_URC_TIMEOUT))
+    {
+        if (ai->urc_cnt > 2 && ai->urc_item != NULL)
+        {
+            ai->urcbuf[ai->urc_cnt] = '\0';
+            AT_DEBUG(ai, "urc recv timeout=>%s\r\n", ai->urcbuf);
+            urc_handler_entry(ai, URC_RECV_TIMEOUT, ai->urcbuf, ai->urc_cnt);
+        }
+        urc_reset(ai);
+    }
+}
+
+/**
+ * @brief       URC receive processing
+ * @param[in]   buf  - Receive buffer
+ * @return      none
+ */
+static void urc_recv_process(at_info_t *ai, char *buf, unsigned int size)
+{
+    char *urc_buf;
+    unsigned int n;
+    int ch;
+    if (ai->urcbuf == NULL)
+        return;
+    if (!ai->urc_enable)
+    {
+        if (!AT_IS_TIMEOUT(ai->urc_timer, ai->urc_disable_time))
+            return;
+        ai->urc_enable = 1;
+        AT_DEBUG(ai, "Enable the URC match handler\r\n");
+    }
+    if (size == 0)
+    {
+        urc_timeout_process(ai);
+        return;
+    }
+    ai->urc_timer = at_get_ms();
+    urc_buf = ai->urcbuf;
+    while (size > 0)
+    {
+        if (ai->urc_stream)
+        {
+            n = urc_stream_process(ai, buf, size);
+            buf += n;
+            size -= n;
+            continue;
+        }
+        ch = *buf++;
+        size--;
+        urc_buf[ai->urc_cnt++] = ch;
+        if (ai->urc_cnt >= ai->urc_bufsize - 1)
+        {
+            AT_DEBUG(ai, "Urc buffer full.\r\n");
+            // A recognized frame that does not fit is delivered as far as it was received,
+            // unrecognized data is simply discarded.
+            if (ai->urc_item != NULL)
+            {
+                urc_buf[ai->urc_cnt] = '\0';
+                urc_handler_entry(ai, URC_RECV_OVERFLOW, urc_buf, ai->urc_cnt);
+            }
+            urc_reset(ai);
+            continue;
+        }
+        if (ai->urc_match)
+        {
+            if (ai->urc_cnt >= ai->urc_target)
+            {
+                urc_handler_entry(ai, URC_RECV_OK, urc_buf, ai->urc_cnt);
+            }
+            continue;
+        }
+#if AT_URC_MATCHER_EN
+        if (ai->urc_nodes != NULL)
+        {
+            ai->urc_state = urc_node_next(ai->urc_nodes, ai->urc_state, (unsigned char)ch);
+            if (ai->urc_nodes[ai->urc_state].out != 0 &&
+                (ai->urc_hit == 0 || ai->urc_nodes[ai->urc_state].out < ai->urc_hit))
+                ai->urc_hit = ai->urc_nodes[ai->urc_state].out;
+        }
+#endif
+        if (!IS_URC_END_MARK(ch)) // Find the URC end mark.
+            continue;
+        urc_buf[ai->urc_cnt] = '\0';
+#if AT_CACHE_EN
+        if (ai->cache != NULL)
+            cache_urc_process(ai, urc_buf, ai->urc_cnt);
+#endif
+        if (ai->urc_item == NULL)
+        { // Find the corresponding URC handler
+#if AT_URC_MATCHER_EN
+            if (ai->urc_nodes != NULL)
+                ai->urc_item = ai->urc_hit ? &ai->urc_tbl[ai->urc_hit - 1] : NULL;
+            else
+#endif
+                ai->urc_item = find_urc_item(ai, urc_buf, ai->urc_cnt);
+            if (ai->urc_item == NULL && ch == '\n')
+            {
+                if (ai->urc_cnt > 2 && ai->cursor == NULL) // Unrecognized URC message
+                    AT_DEBUG(ai, "%s\r\n", urc_buf);
+                urc_reset(ai);
+                continue;
+            }
+        }
+        if (ai->urc_item != NULL && ch == ai->urc_item->endmark)
+            urc_handler_entry(ai, URC_RECV_OK, urc_buf, ai->urc_cnt);
+    }
+}
+#endif
+/**
+ * @brief       Indicates whether a command in this state matches the received data.
+ */
+static inline bool cmd_receiving(int state)
+{
+    return state == AT_STAT_RECV || state == AT_STAT_URC || state == AT_STAT_PROMPT;
+}
+
+/**
+ * @brief       Receive buffer overflow processing: the oldest data is discarded to make room
+ *              for 'size' bytes. Pending data is matched first and the match pointers are
+ *              moved along, so the prefix/suffix matching state survives the overflow.
+ */
+static void recv_overflow(at_info_t *ai, unsigned int size)
+{
+    unsigned int keep, drop;
+    work_item_t *wi = ai->cursor;
+    if (wi == NULL)
+    { // Nobody is waiting for the data.
+        ai->recv_cnt = 0;
+        return;
+    }
+#if AT_COROUTINE_EN
+    if (wi->type == WORK_TYPE_COROUTINE ? ai->co_wait == CO_RESP :
+        wi->type != WORK_TYPE_GENERAL && cmd_receiving(ai->env.state))
+#else
+    if (wi->type != WORK_TYPE_GENERAL && cmd_receiving(ai->env.state))
+#endif
+    {
+        if (ai->match_len != ai->recv_cnt)
+            response_match(ai);
+    }
+    keep = ai->recv_bufsize - 1 - size;
+    drop = ai->recv_cnt - keep;
+    memmove(ai->recvbuf, ai->recvbuf + drop, keep);
+    ai->recv_cnt = keep;
+    ai->match_len = ai->match_len > drop ? ai->match_len - drop : 0;
+    if (ai->prefix != NULL)
+        ai->prefix = ai->prefix - ai->recvbuf >= (int)drop ? ai->prefix - drop : ai->recvbuf;
+    if (ai->suffix != NULL)
+        ai->suffix = ai->suffix - ai->recvbuf >= (int)drop ? ai->suffix - drop : ai->recvbuf;
+    if (ai->recv_dropped == 0)
+        AT_DEBUG(ai, "Receive buffer overflow, the oldest data is discarded.\r\n");
+    ai->recv_dropped += drop;
+}
+
+/**
+ * @brief       Command response data processing
+ * @return      none
+ */
+static void resp_recv_process(at_info_t *ai, const char *buf, unsigned int size)
+{
+    unsigned int n;
+    if (size == 0)
+        return;
+#if AT_STATS_EN
+    if (!ai->stats_recv)
+    {
+        ai->stats_first = at_get_ms();
+        ai->stats_recv = 1;
+    }
+#endif
+    while (size > 0)
+    {
+        // Data is added at most half a buffer at a time, so that an overflow always keeps 
+        // the latest half of the buffer.
+        n = size < ai->recv_bufsize / 2u ? size : ai->recv_bufsize / 2u;
+        if (ai->recv_cnt + n >= ai->recv_bufsize)
+            recv_overflow(ai, n);
+        memcpy(ai->recvbuf + ai->recv_cnt, buf, n);
+        ai->recv_cnt += n;
+        buf += n;
+        size -= n;
+    }
+    ai->recvbuf[ai->recv_cnt] = '\0';
+}
+
+static int (*const work_handler_table[WORK_TYPE_MAX])(at_info_t *) = {
+    [WORK_TYPE_GENERAL] = do_work_handler,
+    [WORK_TYPE_SINGLLINE] = do_cmd_handler,
+    [WORK_TYPE_MULTILINE] = send_multiline_handler,
+    [WORK_TYPE_CMD] = do_cmd_handler,
+    [WORK_TYPE_CUSTOM] = do_cmd_handler,
+    [WORK_TYPE_BUF] = do_cmd_handler,
+#if AT_COROUTINE_EN
+    [WORK_TYPE_COROUTINE] = do_coroutine_handler,
+#endif
+#if AT_PAYLOAD_EN
+    [WORK_TYPE_PAYLOAD] = do_cmd_handler,
+#endif
+};
+
+/**
+ * @brief   Indicates if any work is queued.
+ */
+static bool work_queued(at_info_t *ai)
+{
+    int i;
+    for (i = 0; i < AT_PRIORITY_LEVELS; i++)
+    {
+        if (!list_empty(&ai->queues[i]))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief   Select the next work (the caller holds the lock).
+ *          The queue heads are compared by their aged level (one level higher for each 
+ *          aging interval waited, the oldest wins a tie), then the work of the selected 
+ *          queue with the earliest deadline runs first (FIFO without deadlines).
+ */
+static work_item_t *work_select(at_info_t *ai)
+{
+    work_item_t *it, *best = NULL;
+    unsigned int now = at_get_ms(), level, best_level = 0;
+    int i, queue = 0;
+    for (i = AT_PRIORITY_LEVELS - 1; i >= 0; i--)
+    {
+        if (list_empty(&ai->queues[i]))
+            continue;
+        it = list_first_entry(&ai->queues[i], work_item_t, node);
+        level = i;
+        if (ai->aging != 0)
+            level += (now - it->enqueue_time) / ai->aging;
+        if (level > AT_PRIORITY_HIGH)
+            level = AT_PRIORITY_HIGH;
+        if (best == NULL || level > best_level ||
+            (level == best_level && (int)(it->enqueue_time - best->enqueue_time) < 0))
+        {
+            best = it;
+            best_level = level;
+            queue = i;
+        }
+    }
+    if (best == NULL)
+        return NULL;
+    list_for_each_entry(it, &ai->queues[queue], node)
+    {
+        if (it->attr.deadline != 0 && (best->attr.deadline == 0 ||
+            (int)(it->enqueue_time + it->attr.deadline - best->enqueue_time - best->attr.deadline) < 0))
+            best = it;
+    }
+    return best;
+}
+
+/**
+ * @brief   AT work processing.
+ */
+static void at_work_process(at_info_t *ai)
+{
+    at_env_t *env = &ai->env;
+    if (ai->cursor == NULL)
+    {
+        if (!work_queued(ai))
+            return; // No work to do.
+
+        ai->cursor = work_select(ai);
+        if (ai->cursor == NULL)
+            return;
+        ai->next_delay = 0;
+        env->obj = (struct at_obj *)ai;
+        env->i = 0;
+        env->j = 0;
+        env->state = 0;
+        env->params = ai->cursor->attr.params;
+        env->recvclr(env);
+        env->reset_timer(env);
+#if AT_COROUTINE_EN
+        ai->co_wait = CO_RUN;
+        ai->co_resend = 0;
+        ai->prefix = ai->suffix = NULL; // Nothing to keep for a first URC await.
+#endif
+#if AT_STATS_EN
+        ai->stats_start = at_get_ms();
+        ai->stats_retry = 0;
+        ai->stats_recv = 1;
+#endif
+#if AT_SYNC_EN
+        if (sync_abandoned(ai->cursor)) // Nobody is waiting for the result any more.
+            update_work_state(ai->cursor, AT_WORK_STAT_ABORT, AT_RESP_ABORT);
+#endif
+        /*Enter running state*/
+        if (ai->cursor->state == AT_WORK_STAT_READY)
+        {
+            update_work_state(ai->cursor, AT_WORK_STAT_RUN, (at_resp_code)ai->cursor->code);
+        }
+    }
+    /* When the job execution is complete, put it into the idle work queue */
+    if (ai->cursor->state >= AT_WORK_STAT_FINISH || work_handler_table[ai->cursor->type](ai))
+    {
+        // Marked the work as done.
+        if (ai->cursor->state == AT_WORK_STAT_RUN)
+        {
+            update_work_state(ai->cursor, AT_WORK_STAT_FINISH, (at_resp_code)ai->cursor->code);
+        }
+#if AT_CACHE_EN
+        if (ai->cursor->cache != 0)
+            cache_release(ai, ai->cursor);
+#endif
+        // Recycle Processed work item.
+        work_item_recycle(ai, ai->cursor);
+        ai->cursor = NULL;
+    }
+}
+
+/**
+ * @brief  Create an AT object
+ * @param  adap AT interface adapter (AT object only saves its pointer, it must be a global resident object)
+ * @return Pointer to a new AT object
+ */
+at_obj_t *at_obj_create(const at_adapter_t *adap)
+{
+    at_env_t *e;
+    at_info_t *ai;
+    int i;
+#if AT_POOL_EN
+    at_pool_setup();
+#endif
+    ai = at_core_malloc(sizeof(at_info_t));
+    if (ai == NULL)
+        return NULL;
+    memset(ai, 0, sizeof(at_info_t));
+    ai->obj.adap = adap;
+    /* Initialize the priority queues*/
+    for (i = 0; i < AT_PRIORITY_LEVELS; i++)
+        INIT_LIST_HEAD(&ai->queues[i]);
+    ai->aging = AT_PRIORITY_AGING;
+    // Allocate at least 32 bytes to the buffer
+    ai->recv_bufsize = adap->recv_bufsize < 32 ? 32 : adap->recv_bufsize;
+    ai->recvbuf = at_core_malloc(ai->recv_bufsize);
+    if (ai->recvbuf == NULL)
+    {
+        at_obj_destroy(&ai->obj);
+        return NULL;
+    }
+#if AT_URC_WARCH_EN
+    if (adap->urc_bufsize != 0)
+    {
+        ai->urc_bufsize = adap->urc_bufsize < 32 ? 32 : adap->urc_bufsize;
+        ai->urcbuf = at_core_malloc(ai->urc_bufsize);
+        if (ai->urcbuf == NULL)
+        {
+            at_obj_destroy(&ai->obj);
+            return NULL;
+        }
+    }
+#endif
+#if AT_STATS_EN
+    // The statistics table is not work memory, it is not counted against AT_MEM_LIMIT_SIZE.
+    ai->stats = at_malloc(sizeof(stats_entry_t) * AT_STATS_CMD_COUNT);
+    if (ai->stats != NULL)
+        memset(ai->stats, 0, sizeof(stats_entry_t) * AT_STATS_CMD_COUNT);
+    else
+        AT_DEBUG(ai, "No memory for the command statistics\r\n");
+#endif
+#if AT_RTO_EN
+    // Not work memory either.
+    ai->rto = at_malloc(sizeof(rto_table_t));
+    if (ai->rto != NULL)
+    {
+        memset(ai->rto, 0, sizeof(rto_table_t));
+        ai->rto->min = AT_RTO_MIN;
+        ai->rto->max = AT_RTO_MAX;
+    }
+    else
+        AT_DEBUG(ai, "No memory for the adaptive timeouts\r\n");
+#endif
+    e = &ai->env;
+    ai->recv_cnt = 0;
+    ai->urc_enable = 1;
+    ai->enable = 1;
+    // Initialization of public work environment.
+    e->is_timeout = at_is_timeout;
+    e->println = println;
+    e->recvbuf = get_recvbuf;
+    e->recvclr = recvbuf_clear;
+    e->recvlen = get_recv_count;
+    e->contains = find_substr;
+    e->disposing = at_isabort;
+    e->finish = at_finish;
+    e->reset_timer = at_reset_timer;
+    e->next_wait = at_next_wait;
+    return &ai->obj;
+}
+/**
+ * @brief  Destroy a AT object.
+ */
+void at_obj_destroy(at_obj_t *obj)
+{
+    at_info_t *ai = obj_map(obj);
+    int i;
+
+    if (obj == NULL)
+        return;
+
+    work_inbox_process(ai);
+    for (i = 0; i < AT_PRIORITY_LEVELS; i++)
+        work_item_destroy_all(&ai->queues[i]);
+#if AT_CACHE_EN
+    if (ai->cache != NULL)
+    {
+        work_item_destroy_all(&ai->cache->hits);
+        for (i = 0; i < ai->cache->count; i++)
+            work_item_destroy_all(&ai->cache->entry[i].joins);
+        at_free(ai->cache);
+    }
+#endif
+
+    if (ai->recvbuf != NULL)
+        at_core_free(ai->recvbuf);
+#if AT_URC_WARCH_EN
+    if (ai->urcbuf != NULL)
+        at_core_free(ai->urcbuf);
+#if AT_URC_MATCHER_EN
+    at_core_free(ai->urc_nodes);
+#endif
+#endif
+    at_core_free(ai->match_table);
+#if AT_STATS_EN
+    if (ai->stats != NULL)
+        at_free(ai->stats);
+#endif
+#if AT_RTO_EN
+    if (ai->rto != NULL)
+        at_free(ai->rto);
+#endif
+#if AT_RAW_TRANSPARENT_EN
+    if (ai->raw_buf != NULL)
+        at_free(ai->raw_buf);
+#endif
+    at_core_free(ai);
+}
+
+/**
+ * @brief   Indicates if the AT object is busy.
+ * @return  true - command queue is not empty, busy state
+ */
+bool at_obj_busy(at_obj_t *at)
+{
+    return __atomic_load_n(&obj_map(at)->list_cnt, __ATOMIC_RELAXED) != 0 || obj_map(at)->urc_cnt != 0 ||
+           obj_map(at)->urc_stream;
+}
+
+/**
+ * @brief   Enable/Disable the AT work
+ */
+void at_obj_set_enable(at_obj_t *at, int enable)
+{
+    obj_map(at)->enable = enable ? 1 : 0;
+}
+
+/**
+ * @brief   Set the buffer used to read received data, replacing the AT_RX_CHUNK_SIZE buffer 
+ *          on the stack of at_obj_process (a larger buffer means fewer read calls).
+ * @param   buf  Buffer (must remain valid while it is in use), NULL to restore the default.
+ * @param   size Buffer size
+ */
+void at_obj_set_rxbuf(at_obj_t *at, void *buf, unsigned int size)
+{
+    at_info_t *ai = obj_map(at);
+    ai->rxbuf = buf != NULL && size != 0 ? buf : NULL;
+    ai->rxbuf_size = size;
+}
+
+/**
+ * @brief   Set the priority aging interval (default AT_PRIORITY_AGING).
+ * @param   interval A queued work is raised by one level for each interval (ms) it waits, 
+ *                   0 for strict priorities.
+ */
+void at_obj_set_aging(at_obj_t *at, unsigned int interval)
+{
+    obj_map(at)->aging = interval;
+}
+
+/**
+ * @brief   Set user data
+ */
+void at_obj_set_user_data(at_obj_t *at, void *user_data)
+{
+    at->user_data = user_data;
+}
+
+/**
+ * @brief   Get user data.
+ */
+void *at_obj_get_user_data(at_obj_t *at)
+{
+    return at->user_data;
+}
+
+/**
+ * @brief   Default attributes initialization.
+ *          Default low priority, other reference AT_DEF_XXX definition.
+ * @param   attr AT attributes
+ */
+void at_attr_deinit(at_attr_t *attr)
+{
+    *attr = at_def_attr;
+}
+
+/**
+ * @brief   Create a command work item formatted from a variable argument list.
+ */
+static work_item_t *create_cmd_item(at_info_t *ai, const at_attr_t *attr, const char *cmd, va_list va)
+{
+    work_item_t *it;
+    va_list args;
+    int len;
+    // The exact length is measured first, the command is then formatted directly into the 
+    // tail of a work item of that size (a single allocation).
+    va_copy(args, va);
+    len = vsnprintf(NULL, 0, cmd, args);
+    va_end(args);
+    if (len <= 0)
+        return NULL;
+    it = create_work_item(ai, WORK_TYPE_CMD, attr, NULL, len + 1);
+    if (it == NULL)
+        return NULL;
+    vsnprintf(it->buf, len + 1, cmd, va);
+    return it;
+}
+
+/**
+ * @brief   Execute command (with variable argument list)
+ * @param   attr AT attributes(NULL to use the default value)
+ * @param   cmd  Format the command.
+ * @param   va   Variable parameter list
+ * @return  Indicates whether the asynchronous work was enqueued successfully
+ */
+bool at_exec_vcmd(at_obj_t *at, const at_attr_t *attr, const char *cmd, va_list va)
+{
+    at_info_t *ai = obj_map(at);
+    return sumit_work_item(ai, create_cmd_item(ai, attr, cmd, va)) != NULL;
+}
+
+/**
+ * @brief   Execute one command
+ * @param   attr AT attributes(NULL to use the default value)
+ * @param   cmd  Formatted arguments
+ * @param   ...  Variable argument list (same usage as printf)
+ * @retval  Indicates whether the asynchronous work was enqueued successfully
+ */
+bool at_exec_cmd(at_obj_t *at, const at_attr_t *attr, const char *cmd, ...)
+{
+    bool ret;
+    va_list args;
+    va_start(args, cmd);
+    ret = at_exec_vcmd(at, attr, cmd, args);
+    va_end(args);
+    return ret;
+}
+
+#if AT_PAYLOAD_EN
+/**
+ * @brief   Execute a prompt command (with variable argument list): the command line is sent,
+ *          the payload is written once the prompt (AT_DEF_PROMPT) is received, then the 
+ *          response (and the result URC, see at_attr_t.urc) is waited for as for a command.
+ *          An error or a timeout resends the whole sequence according to 'retry'.
+ * @param   attr    AT attributes (NULL to use the default value), 'timeout' applies to the 
+ *                  response after the payload.
+ * @param   payload Payload, and whether it is copied or borrowed.
+ * @param   cmd     Format the command.
+ * @param   va      Variable parameter list
+ * @return  Indicates whether the asynchronous work was enqueued successfully
+ */
+bool at_exec_vpayload(at_obj_t *at, const at_attr_t *attr, const at_payload_t *payload, const char *cmd, va_list va)
+{
+    at_info_t *ai = obj_map(at);
+    payload_info_t pi;
+    work_item_t *it;
+    va_list args;
+    int len;
+    va_copy(args, va);
+    len = vsnprintf(NULL, 0, cmd, args);
+    va_end(args);
+    if (len <= 0 || payload->len == 0)
+        return false;
+    it = create_work_item(ai, WORK_TYPE_PAYLOAD, attr, NULL,
+                          sizeof(pi) + len + 1 + (payload->copy ? payload->len : 0));
+    if (it == NULL)
+        return false;
+    pi.data = payload->copy ? NULL : payload->data;
+    pi.len = payload->len;
+    pi.prompt_timeout = payload->prompt_timeout != 0 ? payload->prompt_timeout : AT_DEF_PROMPT_TIMEOUT;
+    memcpy(it->buf, &pi, sizeof(pi));
+    vsnprintf(it->buf + sizeof(pi), len + 1, cmd, va);
+    if (payload->copy)
+        memcpy(it->buf + sizeof(pi) + len + 1, payload->data, payload->len);
+    return sumit_work_item(ai, it) != NULL;
+}
+
+/**
+ * @brief   Execute a prompt command such as AT+QMTPUBEX, AT+CMGS or AT+QISEND, see 
+ *          at_exec_vpayload.
+ * @param   ...  Variable argument list of the command (same usage as printf)
+ * @retval  Indicates whether the asynchronous work was enqueued successfully
+ */
+bool at_exec_payload(at_obj_t *at, const at_attr_t *attr, const at_payload_t *payload, const char *cmd, ...)
+{
+    bool ret;
+    va_list args;
+    va_start(args, cmd);
+    ret = at_exec_vpayload(at, attr, payload, cmd, args);
+    va_end(args);
+    return ret;
+}
+#endif
+
+#if AT_SYNC_EN
+/**
+ * @brief   Submit a work item and wait until it ends (calling task).
+ * @param   it   Work item to submit (NULL if it could not be created).
+ * @param   resp Result, NULL if not required.
+ */
+static at_resp_code sync_exec(at_info_t *ai, work_item_t *it, at_sync_resp_t *resp)
+{
+    unsigned int wait = resp != NULL ? resp->wait : AT_WAIT_FOREVER;
+    unsigned int start, elapsed;
+    unsigned char state;
+    at_resp_code code;
+    at_sync_t *s;
+    if (resp != NULL)
+    {
+        resp->len = 0;
+        resp->code = AT_RESP_ERROR;
+        resp->error = -1;
+        resp->prefix = NULL;
+#if AT_RESULT_URC_EN
+        resp->urc = NULL;
+#endif
+        if (resp->buf != NULL && resp->bufsize != 0)
+            resp->buf[0] = '\0';
+    }
+    if (it == NULL)
+        return AT_RESP_ERROR; // Queue full or out of memory.
+    s = at_malloc(sizeof(at_sync_t));
+    if (s == NULL)
+    {
+        work_item_destroy(it);
+        return AT_RESP_ERROR;
+    }
+    s->waiter = at_sync_waiter();
+    s->resp = resp;
+    s->code = AT_RESP_ERROR;
+    s->state = SYNC_WAIT;
+    it->sync = s;
+    sumit_work_item(ai, it);
+    start = at_get_ms();
+    for (;;)
+    {
+        if (wait != AT_WAIT_FOREVER)
+        {
+            elapsed = at_get_ms() - start;
+            wait = elapsed < wait ? wait - elapsed : 0;
+            start += elapsed;
+        }
+        if (wait != 0 && at_sync_wait(wait))
+        {
+            if (__atomic_load_n(&s->state, __ATOMIC_ACQUIRE) == SYNC_DONE)
+                break;
+            continue; // A stale signal, the result is not ready.
+        }
+        state = SYNC_WAIT;
+        if (__atomic_compare_exchange_n(&s->state, &state, SYNC_GONE, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        { // The AT task releases the request, the work is skipped if it has not started.
+            if (resp != NULL)
+                resp->code = AT_RESP_TIMEOUT;
+            return AT_RESP_TIMEOUT;
+        }
+        wait = AT_WAIT_FOREVER; // The result is being filled in, the signal follows.
+    }
+    code = s->code;
+    at_free(s);
+    return code;
+}
+
+/**
+ * @brief   Initialize the result of a blocking command.
+ * @param   buf     Buffer receiving a copy of the response, NULL if not required.
+ * @param   bufsize Buffer size.
+ * @param   wait    Maximum waiting time (ms), AT_WAIT_FOREVER to wait until the work ends 
+ *                  (it always ends after its timeout and retries).
+ */
+void at_sync_resp_init(at_sync_resp_t *resp, void *buf, unsigned int bufsize, unsigned int wait)
+{
+    memset(resp, 0, sizeof(at_sync_resp_t));
+    resp->wait = wait;
+    resp->buf = buf;
+    resp->bufsize = bufsize;
+    resp->error = -1;
+}
+
+/**
+ * @brief   Execute command and wait for its result (with variable argument list)
+ * @param   attr AT attributes(NULL to use the default value), the callback is still invoked.
+ * @param   resp Result and response copy, NULL if not required.
+ * @param   cmd  Format the command.
+ * @param   va   Variable parameter list
+ * @return  Response code of the command, AT_RESP_ERROR if it could not be submitted, 
+ *          AT_RESP_TIMEOUT if no result was ready within 'resp->wait' (the command is 
+ *          dropped if it has not started yet), AT_RESP_ABORT if the work was aborted.
+ * @note    The calling task sleeps until the AT task signals the result, it must not be the 
+ *          task running at_obj_process (nor a callback). On FreeRTOS, the notification of the
+ *          calling task is used.
+ */
+at_resp_code at_exec_vcmd_sync(at_obj_t *at, const at_attr_t *attr, at_sync_resp_t *resp, const char *cmd, va_list va)
+{
+    at_info_t *ai = obj_map(at);
+    return sync_exec(ai, create_cmd_item(ai, attr, cmd, va), resp);
+}
+
+/**
+ * @brief   Execute one command and wait for its result (see at_exec_vcmd_sync).
+ * @param   attr AT attributes(NULL to use the default value)
+ * @param   resp Result and response copy, NULL if not required.
+ * @param   cmd  Formatted arguments
+ * @param   ...  Variable argument list (same usage as printf)
+ * @return  Response code of the command.
+ */
+at_resp_code at_exec_cmd_sync(at_obj_t *at, const at_attr_t *attr, at_sync_resp_t *resp, const char *cmd, ...)
+{
+    at_resp_code ret;
+    va_list args;
+    va_start(args, cmd);
+    ret = at_exec_vcmd_sync(at, attr, resp, cmd, args);
+    va_end(args);
+    return ret;
+}
+
+/**
+ * @brief   Send multiline commands and wait for the result (see at_exec_vcmd_sync).
+ * @param   resp      Result and response copy (of the last line), NULL if not required.
+ * @param   multiline Command table, with the last item ending in NULL.
+ * @return  Response code of the commands.
+ * @note    Only the address is saved, as with at_send_multiline.
+ */
+at_resp_code at_send_multiline_sync(at_obj_t *at, const at_attr_t *attr, at_sync_resp_t *resp, const char **multiline)
+{
+    at_info_t *ai = obj_map(at);
+    return sync_exec(ai, create_work_item(ai, WORK_TYPE_MULTILINE, attr, multiline, 0), resp);
+}
+#endif
+
+/**
+ * @brief   Execute custom command
+ * @param   attr AT attributes(NULL to use the default value)
+ * @param   sender Command sending handler (such as sending any type of data through the env->obj->adap-write interface)
+ * @retval  Indicates whether the asynchronous work was enqueued successfully
+ */
+bool at_custom_cmd(at_obj_t *at, const at_attr_t *attr, void (*sender)(at_env_t *env))
+{
+    return add_work_item(obj_map(at), WORK_TYPE_CUSTOM, attr, (const void *)sender, 0) != NULL;
+}
+/**
+ * @brief   Send (binary) data
+ * @param   attr AT attributes(NULL to use the default value)
+ * @param   databuf Binary data
+ * @param   bufsize Binary data length
+ * @retval  Indicates whether the asynchronous work was enqueued successfully
+ */
+bool at_send_data(at_obj_t *at, const at_attr_t *attr, const void *databuf, unsigned int bufsize)
+{
+    return add_work_item(obj_map(at), WORK_TYPE_BUF, attr, databuf, bufsize) != NULL;
+}
+/**
+ * @brief   Send a single-line command
+ * @param   cb        Response callback handler, Fill in NULL if not required
+ * @param   timeout   command execution timeout(ms)
+ * @param   retry     command retries( >= 0)
+ * @param   singlline command
+ * @retval  Indicates whether the asynchronous work was enqueued successfully.
+ * @note    Only the address is saved, so the 'singlline' can not be a local variable which will be destroyed.
+ */
+bool at_send_singlline(at_obj_t *at, const at_attr_t *attr, const char *singlline)
+{
+    return add_work_item(obj_map(at), WORK_TYPE_SINGLLINE, attr, singlline, 0) != NULL;
+}
+
+/**
+ * @brief   Send multiline commands
+ * @param   attr AT attributes(NULL to use the default value)
+ * @param   multiline Command table, with the last item ending in NULL.
+ * @example :
+ *          const char *multiline = {
+ *              "AT+XXX",
+ *              "AT+XXX",
+ *              NULL
+ *          };
+ *          at_send_multiline(at_dev, NULL, multiline);
+ *
+ * @retval  Indicates whether the asynchronous work was enqueued successfully.
+ * @note    Only the address is saved, so the array can not be a local variable which will be destroyed.
+ */
+bool at_send_multiline(at_obj_t *at, const at_attr_t *attr, const char **multiline)
+{
+    return add_work_item(obj_map(at), WORK_TYPE_MULTILINE, attr, multiline, 0) != NULL;
 }
-#endif
+
 /**
- * @brief       Command response data processing
- * @return      none
+ * @brief   Execute custom work.
+ * @param   params User parameter.
+ * @param   work   AT custom polling work entry, specific usage ref@at_work_t
+ * @retval  Indicates whether the asynchronous work was enqueued successfully.
  */
-static void resp_recv_process(at_info_t *ai, const char *buf, unsigned int size)
+bool at_do_work(at_obj_t *at, void *params, at_work_t work)
 {
-    if (size == 0)
-        return;
-    if (ai->recv_cnt + size >= ai->recv_bufsize) // Receive overflow, clear directly.
-        ai->recv_cnt = 0;
-
-    memcpy(ai->recvbuf + ai->recv_cnt, buf, size);
-    ai->recv_cnt += size;
-    ai->recvbuf[ai->recv_cnt] = '\0';
+    at_attr_t attr;
+    at_attr_deinit(&attr);
+    attr.params = params;
+    return add_work_item(obj_map(at), WORK_TYPE_GENERAL, &attr, (const void *)work, 0) != NULL;
 }
 
-static int (*const work_handler_table[WORK_TYPE_MAX])(at_info_t *) = {
-    [WORK_TYPE_GENERAL] = do_work_handler,
-    [WORK_TYPE_SINGLLINE] = do_cmd_handler,
-    [WORK_TYPE_MULTILINE] = send_multiline_handler,
-    [WORK_TYPE_CMD] = do_cmd_handler,
-    [WORK_TYPE_CUSTOM] = do_cmd_handler,
-    [WORK_TYPE_BUF] = do_cmd_handler,
-};
+#if AT_COROUTINE_EN
+/**
+ * @brief   Execute a coroutine work (see AT_CO_BEGIN).
+ * @param   params User parameter (env->params).
+ * @param   co     Coroutine body, it is resumed by the AT task whenever what it awaits ends.
+ * @retval  Indicates whether the asynchronous work was enqueued successfully.
+ */
+bool at_do_coroutine(at_obj_t *at, void *params, at_work_t co)
+{
+    at_attr_t attr;
+    at_attr_deinit(&attr);
+    attr.params = params;
+    return add_work_item(obj_map(at), WORK_TYPE_COROUTINE, &attr, (const void *)co, 0) != NULL;
+}
 
 /**
- * @brief   AT work processing.
+ * @brief   Command await of a coroutine (see AT_CO_CMD): the command is sent and the 
+ *          coroutine is suspended until the response suffix, an error or a timeout, errors
+ *          and timeouts are resent according to the attributes (retry, policy).
+ * @param   attr AT attributes (NULL to use the default value), the callback is not used.
+ * @return  true while the coroutine has to stay suspended, false once the result is known 
+ *          (at_co_result, the response is in the receive buffer).
  */
-static void at_work_process(at_info_t *ai)
+bool at_co_vcmd(at_env_t *env, const at_attr_t *attr, const char *cmd, va_list va)
 {
-    at_env_t *env = &ai->env;
-    if (ai->cursor == NULL)
+    at_info_t *ai = obj_map(env->obj);
+    at_fail_class cls = AT_FAIL_TIMEOUT;
+    int code = -1;
+    if (attr == NULL)
+        attr = &at_def_attr;
+    if (ai->co_wait == CO_DONE)
     {
-        if (!list_empty(&ai->hlist))
-            ai->clist = &ai->hlist;
-        else if (!list_empty(&ai->llist))
-            ai->clist = &ai->llist;
+        ai->co_wait = CO_RUN;
+        if (ai->co_resend) // The retry delay has expired.
+        {
+            ai->co_resend = 0;
+        }
         else
-            return; // No work to do.
-
-        at_lock(ai);
-        ai->next_delay = 0;
-        env->obj = (struct at_obj *)ai;
-        env->i = 0;
-        env->j = 0;
-        env->state = 0;
-        ai->cursor = list_first_entry(ai->clist, work_item_t, node);
-        env->params = ai->cursor->attr.params;
-        env->recvclr(env);
-        env->reset_timer(env);
-        /*Enter running state*/
-        if (ai->cursor->state == AT_WORK_STAT_READY)
         {
-            update_work_state(ai->cursor, AT_WORK_STAT_RUN, (at_resp_code)ai->cursor->code);
+            if (ai->co_result == AT_RESP_OK)
+                return false;
+            if (ai->co_result == AT_RESP_ERROR)
+                error_parse(ai->recvbuf, ai->recv_cnt, &cls, &code);
+            AT_DEBUG(ai, "<-\r\n%s\r\n", ai->recvbuf);
+            if (!retry_attempt(ai, attr, ai->co_start, ai->co_resends, cls, code))
+                return false;
+            ai->co_resends++;
+            if (ai->retry_delay != 0)
+            {
+                co_sleep(ai, ai->retry_delay);
+                ai->co_resend = 1;
+                return true;
+            }
         }
-        at_unlock(ai);
     }
-    /* When the job execution is complete, put it into the idle work queue */
-    if (ai->cursor->state >= AT_WORK_STAT_FINISH || work_handler_table[ai->cursor->type](ai))
+    else
     {
-        // Marked the work as done.
-        if (ai->cursor->state == AT_WORK_STAT_RUN)
-        {
-            update_work_state(ai->cursor, AT_WORK_STAT_FINISH, (at_resp_code)ai->cursor->code);
-        }
-        // Recycle Processed work item.
-        work_item_recycle(ai, ai->cursor);
-        ai->cursor = NULL;
+        ai->co_resends = 0;
+        ai->co_start = at_get_ms();
     }
+    co_send(ai, attr, cmd, va);
+    return true;
 }
 
 /**
- * @brief  Create an AT object
- * @param  adap AT interface adapter (AT object only saves its pointer, it must be a global resident object)
- * @return Pointer to a new AT object
+ * @brief   Command await of a coroutine (with variable argument list), see at_co_vcmd.
  */
-at_obj_t *at_obj_create(const at_adapter_t *adap)
+bool at_co_cmd(at_env_t *env, const at_attr_t *attr, const char *cmd, ...)
 {
-    at_env_t *e;
-    at_info_t *ai = at_core_malloc(sizeof(at_info_t));
-    if (ai == NULL)
-        return NULL;
-    memset(ai, 0, sizeof(at_info_t));
-    ai->obj.adap = adap;
-    /* Initialize high and low priority queues*/
-    INIT_LIST_HEAD(&ai->hlist);
-    INIT_LIST_HEAD(&ai->llist);
-    // Allocate at least 32 bytes to the buffer
-    ai->recv_bufsize = adap->recv_bufsize < 32 ? 32 : adap->recv_bufsize;
-    ai->recvbuf = at_core_malloc(ai->recv_bufsize);
-    if (ai->recvbuf == NULL)
+    bool ret;
+    va_list args;
+    va_start(args, cmd);
+    ret = at_co_vcmd(env, attr, cmd, args);
+    va_end(args);
+    return ret;
+}
+
+/**
+ * @brief   URC await of a coroutine (see AT_CO_URC): the coroutine is suspended until a line
+ *          starting with 'prefix' is received, or the timeout. The data received after the 
+ *          response of the previous command is kept, so that a URC that came with it is seen.
+ * @param   timeout Maximum waiting time (ms).
+ * @return  true while the coroutine has to stay suspended, false once the result is known 
+ *          (at_co_result: AT_RESP_OK or AT_RESP_TIMEOUT, at_co_resp points to the URC, 
+ *          AT_RESP_ERROR if there is no memory to match the prefix).
+ */
+bool at_co_urc(at_env_t *env, const char *prefix, unsigned int timeout)
+{
+    at_info_t *ai = obj_map(env->obj);
+    unsigned int keep = 0, used;
+    if (ai->co_wait == CO_DONE)
     {
-        at_obj_destroy(&ai->obj);
-        return NULL;
+        ai->co_wait = CO_RUN;
+        return false;
     }
-#if AT_URC_WARCH_EN
-    if (adap->urc_bufsize != 0)
+    if (ai->suffix != NULL) // Drop the data up to the end of the last matched response.
     {
-        ai->urc_bufsize = adap->urc_bufsize < 32 ? 32 : adap->urc_bufsize;
-        ai->urcbuf = at_core_malloc(ai->urc_bufsize);
-        if (ai->urcbuf == NULL)
-        {
-            at_obj_destroy(&ai->obj);
-            return NULL;
-        }
+        used = ai->suffix - ai->recvbuf + ai->suffix_matcher.len;
+        keep = used < ai->recv_cnt ? ai->recv_cnt - used : 0;
+        memmove(ai->recvbuf, ai->recvbuf + ai->recv_cnt - keep, keep);
     }
-#endif
-    e = &ai->env;
-    ai->recv_cnt = 0;
-    ai->urc_enable = 1;
-    ai->enable = 1;
-    // Initialization of public work environment.
-    e->is_timeout = at_is_timeout;
-    e->println = println;
-    e->recvbuf = get_recvbuf;
-    e->recvclr = recvbuf_clear;
-    e->recvlen = get_recv_count;
-    e->contains = find_substr;
-    e->disposing = at_isabort;
-    e->finish = at_finish;
-    e->reset_timer = at_reset_timer;
-    e->next_wait = at_next_wait;
-    return &ai->obj;
+    ai->recv_cnt = keep;
+    ai->recvbuf[keep] = '\0';
+    ai->recv_dropped = 0;
+    if (!match_info_init(ai, prefix, "\n"))
+    {
+        ai->co_result = AT_RESP_ERROR;
+        ai->co_wait = CO_DONE;
+        return true;
+    }
+    ai->next_delay = timeout != 0 ? timeout : 1;
+    ai->delay_timer = at_get_ms();
+    ai->co_wait = CO_RESP;
+    ai->co_urc = 1;
+    return true;
 }
+
 /**
- * @brief  Destroy a AT object.
+ * @brief   Delay await of a coroutine (see AT_CO_SLEEP), the AT task sleeps meanwhile 
+ *          unless other events occur.
+ * @return  true while the coroutine has to stay suspended.
  */
-void at_obj_destroy(at_obj_t *obj)
+bool at_co_sleep(at_env_t *env, unsigned int ms)
 {
-    at_info_t *ai = obj_map(obj);
-
-    if (obj == NULL)
-        return;
-
-    work_item_destroy_all(ai, &ai->hlist);
-    work_item_destroy_all(ai, &ai->llist);
-
-    if (ai->recvbuf != NULL)
-        at_core_free(ai->recvbuf);
-#if AT_URC_WARCH_EN
-    if (ai->urcbuf != NULL)
-        at_core_free(ai->urcbuf);
-#endif
-    at_core_free(ai);
+    at_info_t *ai = obj_map(env->obj);
+    if (ai->co_wait == CO_DONE)
+    {
+        ai->co_wait = CO_RUN;
+        return false;
+    }
+    co_sleep(ai, ms);
+    return true;
 }
 
 /**
- * @brief   Indicates if the AT object is busy.
- * @return  true - command queue is not empty, busy state
+ * @brief   Get the result of the last await of a coroutine.
  */
-bool at_obj_busy(at_obj_t *at)
+at_resp_code at_co_result(at_env_t *env)
 {
-    return !list_empty(&obj_map(at)->hlist) || !list_empty(&obj_map(at)->llist) || obj_map(at)->urc_cnt != 0;
+    return (at_resp_code)obj_map(env->obj)->co_result;
 }
 
 /**
- * @brief   Enable/Disable the AT work
+ * @brief   Get the response of the last await of a coroutine: the matched prefix (or URC) 
+ *          in the receive buffer, the start of the receive buffer if there is none.
  */
-void at_obj_set_enable(at_obj_t *at, int enable)
+char *at_co_resp(at_env_t *env)
 {
-    obj_map(at)->enable = enable ? 1 : 0;
+    at_info_t *ai = obj_map(env->obj);
+    return ai->prefix != NULL ? ai->prefix : ai->recvbuf;
 }
+#endif
 
 /**
- * @brief   Set user data
+ * @brief Abort all AT work submitted so far (deferred: it is aborted by the AT task at its 
+ *        next processing cycle, see at_chat.h).
  */
-void at_obj_set_user_data(at_obj_t *at, void *user_data)
+void at_work_abort_all(at_obj_t *at)
 {
-    at->user_data = user_data;
+    at_info_t *ai = obj_map(at);
+    __atomic_store_n(&ai->abort_seq, __atomic_load_n(&ai->submit_seq, __ATOMIC_RELAXED), __ATOMIC_RELEASE);
+    at_notify(ai);
 }
 
-/**
- * @brief   Get user data.
- */
-void *at_obj_get_user_data(at_obj_t *at)
+#if AT_MEM_WATCH_EN
+
+static void *at_core_malloc(unsigned int nbytes)
 {
-    return at->user_data;
+    // Work memory is allocated by the submitting tasks and released by the AT task.
+    unsigned int cur = __atomic_add_fetch(&at_cur_mem, nbytes, __ATOMIC_RELAXED);
+    unsigned int max = __atomic_load_n(&at_max_mem, __ATOMIC_RELAXED);
+    unsigned long *mem_info;
+    if (cur > AT_MEM_LIMIT_SIZE)
+    { // The maximum memory limit has been exceeded.
+        __atomic_sub_fetch(&at_cur_mem, nbytes, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    mem_info = (unsigned long *)at_malloc(nbytes + sizeof(unsigned long));
+    if (mem_info == NULL)
+    {
+        __atomic_sub_fetch(&at_cur_mem, nbytes, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    *mem_info = nbytes;
+    // Record maximum memory usage.
+    while (cur > max && !__atomic_compare_exchange_n(&at_max_mem, &max, cur, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+    return mem_info + 1;
+}
+
+static void at_core_free(void *ptr)
+{
+    unsigned long *mem_info = (unsigned long *)ptr;
+    unsigned long nbyte;
+    if (ptr != NULL)
+    {
+        mem_info--;
+        nbyte = *mem_info;
+        __atomic_sub_fetch(&at_cur_mem, nbyte, __ATOMIC_RELAXED);
+        at_free(mem_info);
+    }
 }
 
 /**
- * @brief   Default attributes initialization.
- *          Default low priority, other reference AT_DEF_XXX definition.
- * @param   attr AT attributes
+ * @brief Get the maximum memory usage.
  */
-void at_attr_deinit(at_attr_t *attr)
+unsigned int at_max_used_memory(void)
 {
-    *attr = at_def_attr;
+    return at_max_mem;
 }
 
 /**
- * @brief   Execute command (with variable argument list)
- * @param   attr AT attributes(NULL to use the default value)
- * @param   cmd  Format the command.
- * @param   va   Variable parameter list
- * @return  Indicates whether the asynchronous work was enqueued successfully
+ * @brief Get current memory usage.
  */
-bool at_exec_vcmd(at_obj_t *at, const at_attr_t *attr, const char *cmd, va_list va)
+unsigned int at_cur_used_memory(void)
 {
-    char *buf;
-    int len;
-    void *workid = NULL;
-    buf = at_core_malloc(AT_MAX_CMD_LEN);
-    if (buf == NULL)
-    {
-        AT_DEBUG(obj_map(at), "No memory when execute vcmd...\r\n");
-        return NULL;
-    }
-    len = vsnprintf(buf, AT_MAX_CMD_LEN, cmd, va);
-    if (len > 0)
-    {
-        workid = add_work_item(obj_map(at), WORK_TYPE_CMD, attr, buf, len + 1);
-    }
-    at_core_free(buf);
-    return workid != NULL;
+    return at_cur_mem;
+}
+
+#else
+
+static void *at_core_malloc(unsigned int nbytes)
+{
+    return at_malloc(nbytes);
 }
 
+static void at_core_free(void *ptr)
+{
+    at_free(ptr);
+}
+
+#endif
+
+#if AT_POOL_EN
 /**
- * @brief   Execute one command
- * @param   attr AT attributes(NULL to use the default value)
- * @param   cmd  Formatted arguments
- * @param   ...  Variable argument list (same usage as printf)
- * @retval  Indicates whether the asynchronous work was enqueued successfully
+ * @brief  Get the number of pool size classes.
  */
-bool at_exec_cmd(at_obj_t *at, const at_attr_t *attr, const char *cmd, ...)
+int at_pool_class_count(void)
 {
-    bool ret;
-    va_list args;
-    va_start(args, cmd);
-    ret = at_exec_vcmd(at, attr, cmd, args);
-    va_end(args);
-    return ret;
+    return POOL_CLASS_COUNT;
 }
 
-/**
- * @brief   Execute custom command
- * @param   attr AT attributes(NULL to use the default value)
- * @param   sender Command sending handler (such as sending any type of data through the env->obj->adap-write interface)
- * @retval  Indicates whether the asynchronous work was enqueued successfully
+/**
+ * @brief  Get the occupancy statistics of a pool size class.
+ * @param  index Size class index (0 ~ at_pool_class_count() - 1, from small to large)
+ * @param  stat  Statistics output
+ * @return false - invalid size class index.
  */
-bool at_custom_cmd(at_obj_t *at, const at_attr_t *attr, void (*sender)(at_env_t *env))
+bool at_pool_get_stat(int index, at_pool_stat_t *stat)
 {
-    return add_work_item(obj_map(at), WORK_TYPE_CUSTOM, attr, (const void *)sender, 0) != NULL;
+    if (index < 0 || index >= POOL_CLASS_COUNT)
+        return false;
+    stat->blksize = at_pools[index].blksize;
+    stat->count = at_pools[index].count;
+    stat->used = __atomic_load_n(&at_pools[index].used, __ATOMIC_RELAXED);
+    stat->max_used = __atomic_load_n(&at_pools[index].max_used, __ATOMIC_RELAXED);
+    stat->fallback = __atomic_load_n(&at_pool_fallback[index], __ATOMIC_RELAXED);
+    return true;
 }
+#endif
+
+#if AT_STATS_EN
 /**
- * @brief   Send (binary) data
- * @param   attr AT attributes(NULL to use the default value)
- * @param   databuf Binary data
- * @param   bufsize Binary data length
- * @retval  Indicates whether the asynchronous work was enqueued successfully
+ * @brief  Get the number of tracked command names.
  */
-bool at_send_data(at_obj_t *at, const at_attr_t *attr, const void *databuf, unsigned int bufsize)
+int at_obj_stats_count(at_obj_t *at)
 {
-    return add_work_item(obj_map(at), WORK_TYPE_BUF, attr, databuf, bufsize) != NULL;
+    return obj_map(at)->stats_used;
 }
+
 /**
- * @brief   Send a single-line command
- * @param   cb        Response callback handler, Fill in NULL if not required
- * @param   timeout   command execution timeout(ms)
- * @param   retry     command retries( >= 0)
- * @param   singlline command
- * @retval  Indicates whether the asynchronous work was enqueued successfully.
- * @note    Only the address is saved, so the 'singlline' can not be a local variable which will be destroyed.
+ * @brief  Get the counters of a tracked command name.
+ * @param  index Entry index (0 ~ at_obj_stats_count() - 1)
+ * @return false if the index is invalid.
  */
-bool at_send_singlline(at_obj_t *at, const at_attr_t *attr, const char *singlline)
+bool at_obj_get_stats(at_obj_t *at, int index, at_cmd_stats_t *stats)
 {
-    return add_work_item(obj_map(at), WORK_TYPE_SINGLLINE, attr, singlline, 0) != NULL;
+    at_info_t *ai = obj_map(at);
+    if (index < 0 || index >= ai->stats_used)
+        return false;
+    at_lock(ai);
+    *stats = ai->stats[index].info;
+    at_unlock(ai);
+    return true;
 }
 
 /**
- * @brief   Send multiline commands
- * @param   attr AT attributes(NULL to use the default value)
- * @param   multiline Command table, with the last item ending in NULL.
- * @example :
- *          const char *multiline = {
- *              "AT+XXX",
- *              "AT+XXX",
- *              NULL
- *          };
- *          at_send_multiline(at_dev, NULL, multiline);
- *
- * @retval  Indicates whether the asynchronous work was enqueued successfully.
- * @note    Only the address is saved, so the array can not be a local variable which will be destroyed.
+ * @brief  Get a latency histogram of a tracked command name.
+ * @param  buckets Sample count of each bucket, see at_stats_bucket_limit for the bucket ranges.
+ * @return false if the index is invalid.
  */
-bool at_send_multiline(at_obj_t *at, const at_attr_t *attr, const char **multiline)
+bool at_obj_get_histogram(at_obj_t *at, int index, at_stats_kind kind, unsigned int buckets[AT_STATS_BUCKETS])
 {
-    return add_work_item(obj_map(at), WORK_TYPE_MULTILINE, attr, multiline, 0) != NULL;
+    at_info_t *ai = obj_map(at);
+    if (index < 0 || index >= ai->stats_used || kind >= AT_STATS_KIND_MAX)
+        return false;
+    at_lock(ai);
+    memcpy(buckets, ai->stats[index].hist[kind], sizeof(ai->stats[index].hist[kind]));
+    at_unlock(ai);
+    return true;
 }
 
 /**
- * @brief   Execute custom work.
- * @param   params User parameter.
- * @param   work   AT custom polling work entry, specific usage ref@at_work_t
- * @retval  Indicates whether the asynchronous work was enqueued successfully.
+ * @brief  Get the upper limit (ms, exclusive) of a histogram bucket.
  */
-bool at_do_work(at_obj_t *at, void *params, at_work_t work)
+unsigned int at_stats_bucket_limit(int bucket)
 {
-    at_attr_t attr;
-    at_attr_deinit(&attr);
-    attr.params = params;
-    return add_work_item(obj_map(at), WORK_TYPE_GENERAL, &attr, (const void *)work, 0) != NULL;
+    unsigned int octave, sub;
+    if (bucket < (int)STATS_SUB_COUNT)
+        return bucket + 1;
+    if (bucket >= AT_STATS_BUCKETS - 1)
+        return AT_WAIT_FOREVER;
+    octave = bucket / STATS_SUB_COUNT;
+    sub = bucket % STATS_SUB_COUNT;
+    return (STATS_SUB_COUNT + sub + 1) << (octave - 1);
 }
 
 /**
- * @brief Abort all AT work
+ * @brief  Estimate a percentile of a latency histogram.
+ * @param  percent Percentile (such as 50, 99)
+ * @return Upper limit of the bucket holding the percentile (ms, capped at the recorded 
+ *         maximum), 0 if there are no samples.
  */
-void at_work_abort_all(at_obj_t *at)
+unsigned int at_obj_stats_percentile(at_obj_t *at, int index, at_stats_kind kind, unsigned int percent)
 {
-    struct list_head *pos;
-    work_item_t *it;
     at_info_t *ai = obj_map(at);
+    unsigned int total = 0, target, sum = 0, limit = 0;
+    const unsigned int *hist;
+    int i;
+    if (index < 0 || index >= ai->stats_used || kind >= AT_STATS_KIND_MAX)
+        return 0;
     at_lock(ai);
-    list_for_each(pos, &ai->hlist)
-    {
-        it = list_entry(pos, work_item_t, node);
-        update_work_state(it, AT_WORK_STAT_ABORT, AT_RESP_ABORT);
-    }
-    list_for_each(pos, &ai->llist)
+    hist = ai->stats[index].hist[kind];
+    for (i = 0; i < AT_STATS_BUCKETS; i++)
+        total += hist[i];
+    target = (total * (percent > 100 ? 100 : percent) + 99) / 100;
+    if (target == 0 && total != 0)
+        target = 1;
+    for (i = 0; i < AT_STATS_BUCKETS && total != 0; i++)
     {
-        it = list_entry(pos, work_item_t, node);
-        update_work_state(it, AT_WORK_STAT_ABORT, AT_RESP_ABORT);
+        sum += hist[i];
+        if (sum >= target)
+        {
+            limit = at_stats_bucket_limit(i) - 1;
+            if (limit > ai->stats[index].info.max[kind])
+                limit = ai->stats[index].info.max[kind];
+            break;
+        }
     }
     at_unlock(ai);
+    return limit;
 }
 
-#if AT_MEM_WATCH_EN
-
-static void *at_core_malloc(unsigned int nbytes)
+/**
+ * @brief  Clear all statistics.
+ */
+void at_obj_stats_reset(at_obj_t *at)
 {
-    if (nbytes + at_cur_mem > AT_MEM_LIMIT_SIZE)
-    { // The maximum memory limit has been exceeded.
-        return NULL;
-    }
-    unsigned long *mem_info = (unsigned long *)at_malloc(nbytes + sizeof(unsigned long));
-    *mem_info = nbytes;
-    at_cur_mem += nbytes;        // Statistics of current memory usage.
-    if (at_cur_mem > at_max_mem) // Record maximum memory usage.
-        at_max_mem = at_cur_mem;
-    return mem_info + 1;
+    at_info_t *ai = obj_map(at);
+    if (ai->stats == NULL)
+        return;
+    at_lock(ai);
+    memset(ai->stats, 0, sizeof(stats_entry_t) * AT_STATS_CMD_COUNT);
+    ai->stats_used = 0;
+    at_unlock(ai);
 }
 
-static void at_core_free(void *ptr)
+/**
+ * @brief  Print the statistics through the debug interface of the adapter.
+ */
+void at_obj_stats_print(at_obj_t *at)
 {
-    unsigned long *mem_info = (unsigned long *)ptr;
-    unsigned long nbyte;
-    if (ptr != NULL)
+    static const char *const kind_name[AT_STATS_KIND_MAX] = {"queue", "modem", "total"};
+    at_info_t *ai = obj_map(at);
+    at_cmd_stats_t st;
+    int i, k;
+    for (i = 0; at_obj_get_stats(at, i, &st); i++)
     {
-        mem_info--;
-        nbyte = *mem_info;
-        at_cur_mem -= nbyte;
-        at_free(mem_info);
+        AT_DEBUG(ai, "%-16s count:%u error:%u timeout:%u retry:%u\r\n", st.name, st.count, st.errors,
+                 st.timeouts, st.retries);
+        for (k = 0; k < AT_STATS_KIND_MAX; k++)
+            AT_DEBUG(ai, "    %s p50:%ums p99:%ums max:%ums\r\n", kind_name[k],
+                     at_obj_stats_percentile(at, i, (at_stats_kind)k, 50),
+                     at_obj_stats_percentile(at, i, (at_stats_kind)k, 99), st.max[k]);
     }
 }
+#endif
 
+#if AT_RTO_EN
 /**
- * @brief Get the maximum memory usage.
+ * @brief  Set the bounds of the adaptive timeouts (default AT_RTO_MIN ~ AT_RTO_MAX).
+ *         The response timeout of a command name is its smoothed response time plus four 
+ *         times its variation, it is doubled on each timeout until the next response. The 
+ *         retry delay after an error response is the smoothed response time. Commands with 
+ *         a static timeout above 'max' keep their static timeout and retry delay.
+ * @param  min  Lower bound (ms)
+ * @param  max  Upper bound (ms), 0 to use the static timeouts only.
  */
-unsigned int at_max_used_memory(void)
+void at_obj_set_rto(at_obj_t *at, unsigned int min, unsigned int max)
 {
-    return at_max_mem;
+    at_info_t *ai = obj_map(at);
+    if (ai->rto == NULL)
+        return;
+    at_lock(ai);
+    ai->rto->min = min;
+    ai->rto->max = max < 0xFFFF ? max : 0xFFFF;
+    at_unlock(ai);
 }
 
 /**
- * @brief Get current memory usage.
+ * @brief  Get the number of tracked command names.
  */
-unsigned int at_cur_used_memory(void)
+int at_obj_rto_count(at_obj_t *at)
 {
-    return at_cur_mem;
+    return obj_map(at)->rto != NULL ? obj_map(at)->rto->used : 0;
 }
 
-#else
+/**
+ * @brief  Get the response time estimation of a tracked command name.
+ * @param  index Entry index (0 ~ at_obj_rto_count() - 1)
+ * @return false if the index is invalid.
+ */
+bool at_obj_get_rto(at_obj_t *at, int index, at_rto_info_t *info)
+{
+    at_info_t *ai = obj_map(at);
+    if (index < 0 || index >= at_obj_rto_count(at))
+        return false;
+    at_lock(ai);
+    *info = ai->rto->entry[index].info;
+    at_unlock(ai);
+    return true;
+}
 
-static void *at_core_malloc(unsigned int nbytes)
+/**
+ * @brief  Forget the learned response times (such as after the module has been restarted 
+ *         or the serial rate has changed).
+ */
+void at_obj_rto_reset(at_obj_t *at)
 {
-    return at_malloc(nbytes);
+    at_info_t *ai = obj_map(at);
+    if (ai->rto == NULL)
+        return;
+    at_lock(ai);
+    memset(ai->rto->entry, 0, sizeof(ai->rto->entry));
+    ai->rto->used = 0;
+    at_unlock(ai);
 }
+#endif
 
-static void at_core_free(void *ptr)
+#if AT_CACHE_EN
+/**
+ * @brief  Set the response cache rules of idempotent query commands.
+ *         A query whose command text matches a rule is answered from the stored response 
+ *         within its TTL, an identical query submitted while one is in flight (with the same 
+ *         prefix and suffix) shares its response instead of being sent again. The callback 
+ *         is invoked as usual, from the AT processing context.
+ * @param  tbl   Cache rules (must be a global resident table), NULL to disable the cache.
+ * @param  count Number of rules
+ * @return false if the AT object is busy (the rules can only be changed while no work is 
+ *         queued) or there is no memory.
+ */
+bool at_obj_set_cache(at_obj_t *at, const at_cache_rule_t *tbl, int count)
 {
-    at_free(ptr);
+    at_info_t *ai = obj_map(at);
+    cache_t *cache = NULL;
+    unsigned int size;
+    int i;
+    if (ai->cursor != NULL || at_obj_busy(at))
+        return false;
+    if (tbl != NULL && count > 0)
+    {
+        // The cache is not work memory, it is not counted against AT_MEM_LIMIT_SIZE.
+        size = sizeof(cache_t) + sizeof(cache_entry_t) * count;
+        cache = at_malloc(size);
+        if (cache == NULL)
+            return false;
+        memset(cache, 0, size);
+        INIT_LIST_HEAD(&cache->hits);
+        cache->count = count;
+        for (i = 0; i < count; i++)
+        {
+            cache->entry[i].rule = &tbl[i];
+            INIT_LIST_HEAD(&cache->entry[i].joins);
+        }
+    }
+    at_lock(ai);
+    if (ai->cache != NULL)
+        at_free(ai->cache);
+    ai->cache = cache;
+    at_unlock(ai);
+    return true;
+}
+
+/**
+ * @brief  Drop all cached responses (such as after the module has been restarted).
+ */
+void at_obj_cache_flush(at_obj_t *at)
+{
+    at_info_t *ai = obj_map(at);
+    int i;
+    at_lock(ai);
+    for (i = 0; ai->cache != NULL && i < ai->cache->count; i++)
+        ai->cache->entry[i].fresh = 0;
+    at_unlock(ai);
 }
 
+/**
+ * @brief  Get the cache counters (they restart when the rules are set).
+ */
+void at_obj_get_cache_stat(at_obj_t *at, at_cache_stat_t *stat)
+{
+    at_info_t *ai = obj_map(at);
+    at_lock(ai);
+    if (ai->cache != NULL)
+        *stat = ai->cache->stat;
+    else
+        memset(stat, 0, sizeof(*stat));
+    at_unlock(ai);
+}
 #endif
 
 #if AT_WORK_CONTEXT_EN
@@ -1278,65 +4005,164 @@ at_resp_code at_work_get_result(at_context_t *ctx)
 
 #if AT_RAW_TRANSPARENT_EN
 /**
- * @brief  Data transparent transmission processing.
+ * @brief  Exit command detection on the data sent to the modem, a line (ended by '\r' or
+ *         '\n') equal to the exit command (case insensitive) generates the on_exit event.
  */
-static void at_raw_trans_process(at_obj_t *obj)
+static void raw_exit_match(at_info_t *ai, const unsigned char *data, unsigned int len)
 {
-    unsigned char rbuf[32];
-    int size;
-    int i;
-    at_info_t *ai = obj_map(obj);
-    if (obj->raw_conf == NULL)
+    const at_raw_trans_conf_t *conf = ai->obj.raw_conf;
+    const char *cmd = conf->exit_cmd;
+    unsigned int i;
+    if (cmd == NULL)
         return;
-    size = obj->adap->read(rbuf, sizeof(rbuf));
-    if (size > 0)
-    {
-        obj->raw_conf->write(rbuf, size);
-    }
-    size = obj->raw_conf->read(rbuf, sizeof(rbuf));
-    if (size > 0)
+    for (i = 0; i < len && ai->raw_trans; i++)
     {
-        obj->adap->write(rbuf, size);
+        if (data[i] == '\r' || data[i] == '\n')
+        {
+            if (ai->raw_exit_cnt != RAW_EXIT_MISMATCH && cmd[ai->raw_exit_cnt] == '\0' && conf->on_exit)
+                conf->on_exit();
+            ai->raw_exit_cnt = 0;
+        }
+        else if (ai->raw_exit_cnt != RAW_EXIT_MISMATCH && cmd[ai->raw_exit_cnt] != '\0' &&
+                 tolower(data[i]) == tolower((unsigned char)cmd[ai->raw_exit_cnt]))
+        {
+            ai->raw_exit_cnt++;
+        }
+        else
+        {
+            ai->raw_exit_cnt = RAW_EXIT_MISMATCH;
+        }
     }
-    // Exit command detection
-    if (obj->raw_conf->exit_cmd != NULL)
+}
+
+/**
+ * @brief  Move data from 'read' to 'write' through a pipe until the source is drained, the
+ *         sink stops accepting data or the budget is used up. Data the sink did not accept
+ *         stays in the pipe for the next call.
+ * @return true - the budget was used up before the source was drained.
+ */
+static bool raw_pump(at_info_t *ai, raw_pipe_t *p, unsigned int (*read)(void *, unsigned int),
+                     unsigned int (*write)(const void *, unsigned int), bool to_modem)
+{
+    unsigned int total = 0, n;
+    bool drained = false;
+    while (ai->raw_trans && (AT_RX_BUDGET == 0 || total < AT_RX_BUDGET))
     {
-        for (i = 0; i < size; i++)
+        if (p->len == 0)
         {
-            if (ai->recv_cnt >= ai->recv_bufsize)
-                ai->recv_cnt = 0;
-            ai->recvbuf[ai->recv_cnt] = rbuf[i];
-            if (rbuf[i] == '\r' || rbuf[i] == 'n')
-            {
-                ai->recvbuf[ai->recv_cnt] = '\0';
-                ai->recv_cnt = 0;
-                if (strcasecmp(obj->raw_conf->exit_cmd, ai->recvbuf) != 0)
-                {
-                    continue;
-                }
-                if (obj->raw_conf->on_exit)
-                {
-                    obj->raw_conf->on_exit();
-                }
-            }
-            else
-            {
-                ai->recv_cnt++;
-            }
+            if (drained)
+                return false;
+            p->off = 0;
+            p->len = read(p->buf, ai->raw_half);
+            if (p->len == 0)
+                return false;
+            drained = p->len < ai->raw_half; // A short read means the source has been drained.
+            if (to_modem)
+                raw_exit_match(ai, p->buf, p->len);
         }
+        n = write(p->buf + p->off, p->len);
+        p->off += n;
+        p->len -= n;
+        total += n;
+        if (p->len != 0) // The sink is full.
+            return false;
+    }
+    return ai->raw_trans;
+}
+
+/**
+ * @brief  Zero-copy host -> modem transfer, the host data is written to the modem in place.
+ * @return true - the budget was used up before the source was drained.
+ */
+static bool raw_pump_peek(at_info_t *ai)
+{
+    const at_raw_trans_conf_t *conf = ai->obj.raw_conf;
+    unsigned int total = 0, len, n;
+    const void *data;
+    while (ai->raw_trans && (AT_RX_BUDGET == 0 || total < AT_RX_BUDGET))
+    {
+        data = conf->peek(&len);
+        if (data == NULL || len == 0)
+            return false;
+        n = __get_adapter(ai)->write(data, len);
+        raw_exit_match(ai, data, n);
+        conf->consume(n);
+        total += n;
+        if (n < len)
+            return false;
     }
+    return ai->raw_trans;
+}
+
+/**
+ * @brief  Data transparent transmission processing.
+ * @return true - more data is pending (the budget was used up).
+ */
+static bool at_raw_trans_process(at_info_t *ai)
+{
+    const at_raw_trans_conf_t *conf = ai->obj.raw_conf;
+    bool pending;
+    if (conf == NULL || ai->raw_buf == NULL)
+        return false;
+    pending = raw_pump(ai, &ai->raw_rx, __get_adapter(ai)->read, conf->write, false);
+    if (conf->peek != NULL && conf->consume != NULL && ai->raw_tx.len == 0)
+        pending |= raw_pump_peek(ai);
+    else
+        pending |= raw_pump(ai, &ai->raw_tx, conf->read, __get_adapter(ai)->write, true);
+    return pending;
+}
+
+/**
+ * @brief  Release the transparent transmission buffer (by the AT task, after the mode was left).
+ */
+static void raw_buf_release(at_info_t *ai)
+{
+    at_lock(ai);
+    if (!ai->raw_trans)
+    {
+        at_free(ai->raw_buf);
+        ai->raw_buf = NULL;
+    }
+    at_unlock(ai);
 }
 
 /**
  * @brief  Enter transparent transmission mode.
  * @param  conf The configuration for transparent transmission mode.
+ * @return false - no memory for the transparent transmission buffer.
  */
-void at_raw_transport_enter(at_obj_t *obj, const at_raw_trans_conf_t *conf)
+bool at_raw_transport_enter(at_obj_t *obj, const at_raw_trans_conf_t *conf)
 {
     at_info_t *ai = obj_map(obj);
-    obj->raw_conf = conf;
-    ai->raw_trans = 1;
-    ai->recv_cnt = 0;
+    unsigned int size = conf->bufsize != 0 ? conf->bufsize : AT_RAW_BUF_SIZE;
+    if (size < 64) // Allocate at least 64 bytes to the buffer
+        size = 64;
+    at_lock(ai);
+    // The buffer of the last session is kept until the AT task releases it.
+    if (ai->raw_buf == NULL)
+    {
+        // The buffer is not work memory, it is not counted against AT_MEM_LIMIT_SIZE.
+        ai->raw_buf = at_malloc(size);
+        ai->raw_half = size / 2;
+    }
+    if (ai->raw_buf != NULL)
+    {
+        ai->raw_rx.buf = ai->raw_buf;
+        ai->raw_tx.buf = ai->raw_buf + ai->raw_half;
+        ai->raw_rx.len = ai->raw_tx.len = 0;
+        ai->raw_exit_cnt = 0;
+        obj->raw_conf = conf;
+        ai->raw_trans = 1;
+        ai->recv_cnt = 0;
+    }
+    at_unlock(ai);
+    if (ai->raw_buf == NULL)
+    {
+        AT_DEBUG(ai, "No memory for the transparent transmission buffer\r\n");
+        return false;
+    }
+    at_notify(ai);
+    return true;
 }
 
 /**
@@ -1350,25 +4176,161 @@ void at_raw_transport_exit(at_obj_t *obj)
 
 #endif
 
+/**
+ * @brief  Get the remaining time(ms) of a timer that expires when AT_IS_TIMEOUT(start, time) 
+ *         becomes true.
+ */
+static unsigned int time_remain(unsigned int start, unsigned int time)
+{
+    unsigned int elapsed = at_get_ms() - start;
+    return elapsed > time ? 0 : time - elapsed + 1;
+}
+
+static inline unsigned int min_time(unsigned int a, unsigned int b)
+{
+    return a < b ? a : b;
+}
+
+/**
+ * @brief  Get the time until the currently running work needs to be polled again.
+ */
+static unsigned int work_next_deadline(at_info_t *ai)
+{
+    work_item_t *wi = ai->cursor;
+#if AT_PAYLOAD_EN
+    payload_info_t pi;
+#endif
+    if (wi == NULL) // The next work can be started immediately.
+        return work_queued(ai) || __atomic_load_n(&ai->inbox, __ATOMIC_RELAXED) != NULL ? 0 : AT_WAIT_FOREVER;
+    if (wi->state >= AT_WORK_STAT_FINISH)
+        return 0;
+    if (wi->type == WORK_TYPE_GENERAL)
+    {
+        if (ai->next_delay > 0)
+            return time_remain(ai->delay_timer, ai->next_delay);
+        return AT_POLL_INTERVAL; // Custom work polls on its own conditions.
+    }
+#if AT_COROUTINE_EN
+    if (wi->type == WORK_TYPE_COROUTINE)
+    {
+        if (ai->co_wait == CO_RESP && !ai->co_urc)
+            return time_remain(ai->timer, ai->resp_timeout);
+        if (ai->next_delay > 0)
+            return time_remain(ai->delay_timer, ai->next_delay);
+        return ai->co_wait == CO_RUN ? AT_POLL_INTERVAL : 0; // Polls a condition.
+    }
+#endif
+    switch (ai->env.state)
+    {
+    case AT_STAT_RECV:
+        return time_remain(ai->timer, ai->resp_timeout);
+    case AT_STAT_RETRY:
+        return time_remain(ai->timer, ai->retry_delay);
+#if AT_RESULT_URC_EN
+    case AT_STAT_URC:
+        return time_remain(ai->timer, wi->attr.urc_timeout);
+#endif
+#if AT_PAYLOAD_EN
+    case AT_STAT_PROMPT:
+        payload_info(wi, &pi);
+        return time_remain(ai->timer, pi.prompt_timeout);
+    case AT_STAT_PAYLOAD: // The adapter did not accept the whole payload.
+        return AT_POLL_INTERVAL;
+#endif
+    default:
+        return 0;
+    }
+}
+
+#if AT_URC_WARCH_EN
+/**
+ * @brief  Get the time until the URC receive timeout or the end of the URC disable window.
+ */
+static unsigned int urc_next_deadline(at_info_t *ai)
+{
+    if (ai->urcbuf == NULL)
+        return AT_WAIT_FOREVER;
+    if (!ai->urc_enable)
+        return time_remain(ai->urc_timer, ai->urc_disable_time);
+    if (ai->urc_cnt > 0 || ai->urc_stream)
+        return time_remain(ai->urc_timer, AT_URC_TIMEOUT);
+    return AT_WAIT_FOREVER;
+}
+#endif
+
+/**
+ * @brief  Drain the received data (within AT_RX_BUDGET) and run the work, the work is 
+ *         processed after every chunk, as it was with one read per call.
+ */
+static void at_process(at_info_t *ai)
+{
+    char chunk[AT_RX_CHUNK_SIZE];
+    char *rbuf = ai->rxbuf != NULL ? ai->rxbuf : chunk;
+    unsigned int size = ai->rxbuf != NULL ? ai->rxbuf_size : sizeof(chunk);
+    unsigned int total = 0, read_size;
+    ai->rx_pending = 0;
+    work_inbox_process(ai);
+#if AT_CACHE_EN
+    if (ai->cache != NULL && !list_empty(&ai->cache->hits))
+        cache_hit_process(ai);
+#endif
+    do
+    {
+        read_size = __get_adapter(ai)->read(rbuf, size);
+#if AT_URC_WARCH_EN
+        urc_recv_process(ai, rbuf, read_size);
+#endif
+        resp_recv_process(ai, rbuf, read_size);
+        at_work_process(ai);
+        if (read_size < size) // A short read means the driver has been drained.
+            return;
+        total += read_size;
+    } while (AT_RX_BUDGET == 0 || total < AT_RX_BUDGET);
+    ai->rx_pending = 1;
+}
+
 /**
  * @brief  AT work polling processing.
  */
 void at_obj_process(at_obj_t *at)
 {
-    char rbuf[64];
-    int read_size;
     register at_info_t *ai = obj_map(at);
 #if AT_RAW_TRANSPARENT_EN
     if (ai->raw_trans)
     {
-        at_raw_trans_process(at);
+        at_raw_trans_process(ai);
         return;
     }
+    if (ai->raw_buf != NULL)
+        raw_buf_release(ai);
+#endif
+    at_process(ai);
+}
+
+/**
+ * @brief  AT work processing, and get the time until the next pending deadline.
+ * @return The number of milliseconds until the earliest pending timeout (command response, 
+ *         retry wait, next_wait delay, URC frame or URC disable window), AT_WAIT_FOREVER if 
+ *         nothing is pending.
+ * @note   In event-driven mode, the caller should block until new data is received, a work 
+ *         is submitted (adapter notify) or the returned time expires, whichever comes first.
+ */
+unsigned int at_obj_process_timed(at_obj_t *at)
+{
+    unsigned int wait;
+    register at_info_t *ai = obj_map(at);
+#if AT_RAW_TRANSPARENT_EN
+    if (ai->raw_trans) // The host side cannot be waited for, it is polled.
+        return at_raw_trans_process(ai) ? 0 : AT_POLL_INTERVAL;
+    if (ai->raw_buf != NULL)
+        raw_buf_release(ai);
 #endif
-    read_size = __get_adapter(ai)->read(rbuf, sizeof(rbuf));
+    at_process(ai);
+    if (ai->rx_pending) // More data is waiting in the driver.
+        return 0;
+    wait = work_next_deadline(ai);
 #if AT_URC_WARCH_EN
-    urc_recv_process(ai, rbuf, read_size);
+    wait = min_time(wait, urc_next_deadline(ai));
 #endif
-    resp_recv_process(ai, rbuf, read_size);
-    at_work_process(ai);
+    return wait;
 }
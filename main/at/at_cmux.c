@@ -0,0 +1,667 @@
+/******************************************************************************
+ * @brief        3GPP TS 27.010 multiplexer (CMUX, basic option)
+ *
+ * Frame: F9 | address | control | length (1~2 bytes) | information | FCS | F9
+ *
+ * The module is the only owner of the physical port, received frames are decoded when a
+ * channel reads (or at_cmux_poll is called) and the information is queued in the receive
+ * buffer of its channel. A frame that does not fit waits until that channel is read, so
+ * no data is lost, but the other channels are held up meanwhile.
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "at_cmux.h"
+#include <string.h>
+
+#if AT_CMUX_EN
+
+#if AT_CMUX_CHANNELS < 1 || AT_CMUX_CHANNELS > 4
+#error "AT_CMUX_CHANNELS must be in the range 1 ~ 4"
+#endif
+
+#if AT_CMUX_RX_SIZE < AT_CMUX_FRAME_SIZE
+#error "AT_CMUX_RX_SIZE must not be smaller than AT_CMUX_FRAME_SIZE"
+#endif
+
+#define CMUX_FLAG      0xF9
+#define CMUX_EA        0x01
+#define CMUX_CR        0x02
+#define CMUX_PF        0x10
+
+/* Frame types (control field without the P/F bit)*/
+#define CMUX_SABM      0x2F
+#define CMUX_UA        0x63
+#define CMUX_DM        0x0F
+#define CMUX_DISC      0x43
+#define CMUX_UIH       0xEF
+#define CMUX_UI        0x03
+
+/* Control channel message types (without the C/R and EA bits)*/
+#define CMUX_MSG_NSC   0x10
+#define CMUX_MSG_TEST  0x20
+#define CMUX_MSG_FCOFF 0x60
+#define CMUX_MSG_FCON  0xA0
+#define CMUX_MSG_CLD   0xC0
+#define CMUX_MSG_MSC   0xE0
+
+/* V.24 signals sent with MSC: RTC, RTR and DV*/
+#define CMUX_V24_SIGNALS 0x8D
+
+/* Remainder of a frame with a valid FCS*/
+#define CMUX_FCS_GOOD  0xCF
+
+/* Maximum frame size on the line: flag, address, control, length, information, FCS, flag*/
+#define CMUX_FRAME_MAX (AT_CMUX_FRAME_SIZE + 7)
+
+#define CMUX_DEBUG(fmt, args...)                  \
+    do                                            \
+    {                                             \
+        if (cmux.port->debug)                     \
+            cmux.port->debug(fmt, ##args);        \
+    } while (0)
+
+/**
+ * @brief Data link connection state.
+ */
+typedef enum {
+    DLC_CLOSED = 0,
+    DLC_OPENING,                   /* SABM sent, waiting for UA*/
+    DLC_OPEN,
+    DLC_CLOSING                    /* DISC sent, waiting for UA*/
+} dlc_state;
+
+/**
+ * @brief Frame decoder state.
+ */
+typedef enum {
+    RX_FLAG = 0,                   /* Searching the opening flag*/
+    RX_ADDR,
+    RX_CTRL,
+    RX_LEN,
+    RX_LEN2,
+    RX_DATA,
+    RX_FCS,
+    RX_END                         /* Waiting for the closing flag*/
+} rx_state;
+
+/**
+ * @brief Virtual channel.
+ */
+typedef struct {
+    const at_adapter_t *adapter;   /* Adapter of the AT object running on the channel*/
+    unsigned int head;             /* Read position of the receive buffer*/
+    unsigned int count;            /* Bytes in the receive buffer*/
+    unsigned char buf[AT_CMUX_RX_SIZE];
+} cmux_channel_t;
+
+/**
+ * @brief Channel interfaces (the adapter interfaces have no context, one set per channel).
+ */
+typedef struct {
+    unsigned int (*write)(const void *buf, unsigned int len);
+    unsigned int (*read)(void *buf, unsigned int len);
+} cmux_thunk_t;
+
+/**
+ * @brief Multiplexer (only one physical port).
+ */
+static struct {
+    const at_cmux_port_t *port;
+    unsigned char state[AT_CMUX_CHANNELS + 1]; /* DLC states, indexed by DLCI*/
+    cmux_channel_t ch[AT_CMUX_CHANNELS];       /* Channels of DLCI 1 ~ AT_CMUX_CHANNELS*/
+    unsigned char rx_state;
+    unsigned char addr, ctrl, fcs;
+    unsigned short len, cnt;
+    unsigned char pending;                     /* A data frame waits for room in its channel*/
+    unsigned char frame[AT_CMUX_FRAME_SIZE];   /* Information of the frame being received*/
+    unsigned char in[CMUX_FRAME_MAX];          /* Data read from the physical port*/
+    unsigned short in_off, in_len;
+    at_cmux_stat_t stat;
+} cmux;
+
+/**
+ * @brief CRC-8 table of the FCS (polynomial x^8 + x^2 + x + 1, reflected).
+ */
+static const unsigned char cmux_crc[256] = {
+    0x00, 0x91, 0xE3, 0x72, 0x07, 0x96, 0xE4, 0x75,
+    0x0E, 0x9F, 0xED, 0x7C, 0x09, 0x98, 0xEA, 0x7B,
+    0x1C, 0x8D, 0xFF, 0x6E, 0x1B, 0x8A, 0xF8, 0x69,
+    0x12, 0x83, 0xF1, 0x60, 0x15, 0x84, 0xF6, 0x67,
+    0x38, 0xA9, 0xDB, 0x4A, 0x3F, 0xAE, 0xDC, 0x4D,
+    0x36, 0xA7, 0xD5, 0x44, 0x31, 0xA0, 0xD2, 0x43,
+    0x24, 0xB5, 0xC7, 0x56, 0x23, 0xB2, 0xC0, 0x51,
+    0x2A, 0xBB, 0xC9, 0x58, 0x2D, 0xBC, 0xCE, 0x5F,
+    0x70, 0xE1, 0x93, 0x02, 0x77, 0xE6, 0x94, 0x05,
+    0x7E, 0xEF, 0x9D, 0x0C, 0x79, 0xE8, 0x9A, 0x0B,
+    0x6C, 0xFD, 0x8F, 0x1E, 0x6B, 0xFA, 0x88, 0x19,
+    0x62, 0xF3, 0x81, 0x10, 0x65, 0xF4, 0x86, 0x17,
+    0x48, 0xD9, 0xAB, 0x3A, 0x4F, 0xDE, 0xAC, 0x3D,
+    0x46, 0xD7, 0xA5, 0x34, 0x41, 0xD0, 0xA2, 0x33,
+    0x54, 0xC5, 0xB7, 0x26, 0x53, 0xC2, 0xB0, 0x21,
+    0x5A, 0xCB, 0xB9, 0x28, 0x5D, 0xCC, 0xBE, 0x2F,
+    0xE0, 0x71, 0x03, 0x92, 0xE7, 0x76, 0x04, 0x95,
+    0xEE, 0x7F, 0x0D, 0x9C, 0xE9, 0x78, 0x0A, 0x9B,
+    0xFC, 0x6D, 0x1F, 0x8E, 0xFB, 0x6A, 0x18, 0x89,
+    0xF2, 0x63, 0x11, 0x80, 0xF5, 0x64, 0x16, 0x87,
+    0xD8, 0x49, 0x3B, 0xAA, 0xDF, 0x4E, 0x3C, 0xAD,
+    0xD6, 0x47, 0x35, 0xA4, 0xD1, 0x40, 0x32, 0xA3,
+    0xC4, 0x55, 0x27, 0xB6, 0xC3, 0x52, 0x20, 0xB1,
+    0xCA, 0x5B, 0x29, 0xB8, 0xCD, 0x5C, 0x2E, 0xBF,
+    0x90, 0x01, 0x73, 0xE2, 0x97, 0x06, 0x74, 0xE5,
+    0x9E, 0x0F, 0x7D, 0xEC, 0x99, 0x08, 0x7A, 0xEB,
+    0x8C, 0x1D, 0x6F, 0xFE, 0x8B, 0x1A, 0x68, 0xF9,
+    0x82, 0x13, 0x61, 0xF0, 0x85, 0x14, 0x66, 0xF7,
+    0xA8, 0x39, 0x4B, 0xDA, 0xAF, 0x3E, 0x4C, 0xDD,
+    0xA6, 0x37, 0x45, 0xD4, 0xA1, 0x30, 0x42, 0xD3,
+    0xB4, 0x25, 0x57, 0xC6, 0xB3, 0x22, 0x50, 0xC1,
+    0xBA, 0x2B, 0x59, 0xC8, 0xBD, 0x2C, 0x5E, 0xCF,
+};
+
+static inline void cmux_lock(void)
+{
+    if (cmux.port->lock != NULL)
+        cmux.port->lock();
+}
+
+static inline void cmux_unlock(void)
+{
+    if (cmux.port->unlock != NULL)
+        cmux.port->unlock();
+}
+
+static unsigned char cmux_fcs(unsigned char fcs, const unsigned char *buf, unsigned int len)
+{
+    while (len--)
+        fcs = cmux_crc[fcs ^ *buf++];
+    return fcs;
+}
+
+/**
+ * @brief  Encode and send a frame (the caller holds the lock).
+ * @param  cr   - Command/response bit of the address field.
+ * @param  ctrl - Frame type (including the P/F bit).
+ * @return true - The frame has been written completely.
+ */
+static bool cmux_send_frame(int dlci, int cr, unsigned char ctrl, const void *data, unsigned int len)
+{
+    unsigned char frame[CMUX_FRAME_MAX];
+    unsigned int n = 0, hlen, ret;
+    unsigned char fcs;
+    frame[n++] = CMUX_FLAG;
+    frame[n++] = (unsigned char)(dlci << 2) | (cr ? CMUX_CR : 0) | CMUX_EA;
+    frame[n++] = ctrl;
+    if (len > 127)
+    {
+        frame[n++] = (unsigned char)((len & 0x7F) << 1);
+        frame[n++] = (unsigned char)(len >> 7);
+    }
+    else
+    {
+        frame[n++] = (unsigned char)(len << 1) | CMUX_EA;
+    }
+    hlen = n;
+    if (len > 0)
+        memcpy(&frame[n], data, len);
+    n += len;
+    // The FCS covers the address, control and length fields (and the information of UI frames).
+    fcs = cmux_fcs(0xFF, &frame[1], hlen - 1);
+    if ((ctrl & ~CMUX_PF) == CMUX_UI)
+        fcs = cmux_fcs(fcs, &frame[hlen], len);
+    frame[n++] = 0xFF - fcs;
+    frame[n++] = CMUX_FLAG;
+    for (hlen = 0; hlen < n; hlen += ret)
+    {
+        ret = cmux.port->write(&frame[hlen], n - hlen);
+        if (ret == 0)
+            return false;
+    }
+    cmux.stat.tx_frames++;
+    return true;
+}
+
+/**
+ * @brief  Send a control channel message.
+ */
+static bool cmux_send_msg(unsigned char type, int cr, const void *value, unsigned int len)
+{
+    unsigned char msg[8];
+    msg[0] = type | (cr ? CMUX_CR : 0) | CMUX_EA;
+    msg[1] = (unsigned char)(len << 1) | CMUX_EA;
+    if (len > 0)
+        memcpy(&msg[2], value, len);
+    return cmux_send_frame(0, 1, CMUX_UIH, msg, len + 2);
+}
+
+static void cmux_close_all(void)
+{
+    memset(cmux.state, DLC_CLOSED, sizeof(cmux.state));
+}
+
+/**
+ * @brief  Control channel message processing (DLCI 0).
+ */
+static void cmux_control_handler(void)
+{
+    unsigned char type = cmux.frame[0] & ~(CMUX_CR | CMUX_EA);
+    unsigned int len;
+    if (cmux.len < 2)
+        return;
+    len = cmux.frame[1] >> 1;
+    if (len + 2 > cmux.len || len > 6)
+        return;
+    if (!(cmux.frame[0] & CMUX_CR))
+    { // Response to one of our commands.
+        if (type == CMUX_MSG_CLD)
+            cmux_close_all();
+        return;
+    }
+    switch (type)
+    {
+    case CMUX_MSG_CLD:
+        cmux_send_msg(type, 0, NULL, 0);
+        cmux_close_all();
+        CMUX_DEBUG("CMUX closed down by the module\r\n");
+        break;
+    case CMUX_MSG_MSC:
+    case CMUX_MSG_TEST:
+    case CMUX_MSG_FCON:
+    case CMUX_MSG_FCOFF:
+        // Acknowledged by returning the value (flow control is left to the physical port).
+        cmux_send_msg(type, 0, &cmux.frame[2], len);
+        break;
+    default:
+        cmux_send_msg(CMUX_MSG_NSC, 0, &cmux.frame[0], 1);
+        break;
+    }
+}
+
+/**
+ * @brief  Received frame processing (the information of data frames is left pending).
+ */
+static void cmux_frame_handler(void)
+{
+    int dlci = cmux.addr >> 2;
+    unsigned char value;
+    cmux.stat.rx_frames++;
+    switch (cmux.ctrl & ~CMUX_PF)
+    {
+    case CMUX_UA:
+        if (dlci > AT_CMUX_CHANNELS)
+            break;
+        if (cmux.state[dlci] == DLC_OPENING)
+        {
+            cmux.state[dlci] = DLC_OPEN;
+            CMUX_DEBUG("CMUX DLCI %d open\r\n", dlci);
+            if (dlci != 0)
+            {
+                value = (unsigned char)(dlci << 2) | CMUX_CR | CMUX_EA;
+                cmux_send_msg(CMUX_MSG_MSC, 1, (unsigned char[]){value, CMUX_V24_SIGNALS}, 2);
+            }
+        }
+        else if (cmux.state[dlci] == DLC_CLOSING)
+        {
+            cmux.state[dlci] = DLC_CLOSED;
+        }
+        break;
+    case CMUX_DM:
+        if (dlci <= AT_CMUX_CHANNELS)
+        {
+            if (cmux.state[dlci] == DLC_OPENING)
+                CMUX_DEBUG("CMUX DLCI %d rejected\r\n", dlci);
+            cmux.state[dlci] = DLC_CLOSED;
+        }
+        break;
+    case CMUX_SABM: // Channels are only opened by this side.
+        cmux_send_frame(dlci, 0, CMUX_DM | CMUX_PF, NULL, 0);
+        break;
+    case CMUX_DISC:
+        cmux_send_frame(dlci, 0, CMUX_UA | CMUX_PF, NULL, 0);
+        if (dlci == 0)
+            cmux_close_all();
+        else if (dlci <= AT_CMUX_CHANNELS)
+            cmux.state[dlci] = DLC_CLOSED;
+        break;
+    case CMUX_UIH:
+    case CMUX_UI:
+        if (dlci == 0)
+            cmux_control_handler();
+        else if (cmux.len > 0)
+            cmux.pending = 1;
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief  Queue the pending data frame in its channel.
+ * @param  reader - DLCI of the channel being read (0: none), the other channels are notified.
+ * @return false - The channel has no room for it yet.
+ */
+static bool cmux_deliver(int reader)
+{
+    int dlci = cmux.addr >> 2;
+    cmux_channel_t *ch;
+    unsigned int pos, n;
+    if (dlci > AT_CMUX_CHANNELS || cmux.state[dlci] != DLC_OPEN)
+    {
+        cmux.stat.dropped += cmux.len;
+        cmux.pending = 0;
+        return true;
+    }
+    ch = &cmux.ch[dlci - 1];
+    if (AT_CMUX_RX_SIZE - ch->count < cmux.len)
+        return false;
+    pos = (ch->head + ch->count) % AT_CMUX_RX_SIZE;
+    n = AT_CMUX_RX_SIZE - pos < cmux.len ? AT_CMUX_RX_SIZE - pos : cmux.len;
+    memcpy(&ch->buf[pos], cmux.frame, n);
+    memcpy(ch->buf, &cmux.frame[n], cmux.len - n);
+    ch->count += cmux.len;
+    cmux.pending = 0;
+    if (dlci != reader && ch->adapter != NULL && ch->adapter->notify != NULL)
+        ch->adapter->notify();
+    return true;
+}
+
+/**
+ * @brief  State after the length field.
+ */
+static unsigned char cmux_data_state(void)
+{
+    if (cmux.len > AT_CMUX_FRAME_SIZE)
+    {
+        cmux.stat.fcs_errors++;
+        return RX_FLAG;
+    }
+    cmux.cnt = 0;
+    return cmux.len > 0 ? RX_DATA : RX_FCS;
+}
+
+/**
+ * @brief  Frame decoding, it stops after a data frame (left pending).
+ * @return Number of bytes consumed.
+ */
+static unsigned int cmux_decode(const unsigned char *buf, unsigned int size)
+{
+    const unsigned char *p = buf, *end = buf + size;
+    unsigned int n;
+    while (p < end && !cmux.pending)
+    {
+        switch (cmux.rx_state)
+        {
+        case RX_FLAG:
+            p = memchr(p, CMUX_FLAG, end - p);
+            if (p == NULL)
+                return size;
+            p++;
+            cmux.rx_state = RX_ADDR;
+            break;
+        case RX_ADDR: // Repeated flags are skipped, the closing flag may open the next frame.
+            if (*p != CMUX_FLAG)
+            {
+                cmux.addr = *p;
+                cmux.fcs = cmux_crc[0xFF ^ *p];
+                cmux.rx_state = RX_CTRL;
+            }
+            p++;
+            break;
+        case RX_CTRL:
+            cmux.ctrl = *p;
+            cmux.fcs = cmux_crc[cmux.fcs ^ *p++];
+            cmux.rx_state = RX_LEN;
+            break;
+        case RX_LEN:
+            cmux.len = *p >> 1;
+            cmux.fcs = cmux_crc[cmux.fcs ^ *p];
+            cmux.rx_state = (*p++ & CMUX_EA) ? cmux_data_state() : RX_LEN2;
+            break;
+        case RX_LEN2:
+            cmux.len |= *p << 7;
+            cmux.fcs = cmux_crc[cmux.fcs ^ *p++];
+            cmux.rx_state = cmux_data_state();
+            break;
+        case RX_DATA:
+            n = end - p < cmux.len - cmux.cnt ? end - p : cmux.len - cmux.cnt;
+            memcpy(&cmux.frame[cmux.cnt], p, n);
+            p += n;
+            cmux.cnt += n;
+            if (cmux.cnt == cmux.len)
+                cmux.rx_state = RX_FCS;
+            break;
+        case RX_FCS:
+            if ((cmux.ctrl & ~CMUX_PF) == CMUX_UI)
+                cmux.fcs = cmux_fcs(cmux.fcs, cmux.frame, cmux.len);
+            if (cmux_crc[cmux.fcs ^ *p++] == CMUX_FCS_GOOD)
+                cmux.rx_state = RX_END;
+            else
+            {
+                cmux.stat.fcs_errors++;
+                cmux.rx_state = RX_FLAG;
+            }
+            break;
+        case RX_END:
+            if (*p == CMUX_FLAG)
+            {
+                p++;
+                cmux.rx_state = RX_ADDR;
+                cmux_frame_handler();
+            }
+            else
+            { // Not the closing flag, resynchronize.
+                cmux.stat.fcs_errors++;
+                cmux.rx_state = RX_FLAG;
+            }
+            break;
+        }
+    }
+    return p - buf;
+}
+
+/**
+ * @brief  Read and decode the physical port until it is drained or a channel is full
+ *         (the caller holds the lock).
+ */
+static void cmux_pump(int reader)
+{
+    for (;;)
+    {
+        if (cmux.pending && !cmux_deliver(reader))
+            return;
+        if (cmux.in_off >= cmux.in_len)
+        {
+            cmux.in_off = 0;
+            cmux.in_len = cmux.port->read(cmux.in, sizeof(cmux.in));
+            if (cmux.in_len == 0)
+                return;
+        }
+        cmux.in_off += cmux_decode(&cmux.in[cmux.in_off], cmux.in_len - cmux.in_off);
+    }
+}
+
+static unsigned int cmux_write(int dlci, const void *buf, unsigned int len)
+{
+    const unsigned char *p = buf;
+    unsigned int sent = 0, n;
+    cmux_lock();
+    while (sent < len && cmux.state[dlci] == DLC_OPEN)
+    {
+        n = len - sent > AT_CMUX_FRAME_SIZE ? AT_CMUX_FRAME_SIZE : len - sent;
+        if (!cmux_send_frame(dlci, 1, CMUX_UIH, &p[sent], n))
+            break;
+        sent += n;
+    }
+    cmux_unlock();
+    return sent;
+}
+
+static unsigned int cmux_read(int dlci, void *buf, unsigned int len)
+{
+    cmux_channel_t *ch = &cmux.ch[dlci - 1];
+    unsigned char *p = buf;
+    unsigned int n;
+    cmux_lock();
+    cmux_pump(dlci);
+    if (len > ch->count)
+        len = ch->count;
+    n = AT_CMUX_RX_SIZE - ch->head < len ? AT_CMUX_RX_SIZE - ch->head : len;
+    memcpy(p, &ch->buf[ch->head], n);
+    memcpy(&p[n], ch->buf, len - n);
+    ch->head = (ch->head + len) % AT_CMUX_RX_SIZE;
+    ch->count -= len;
+    cmux_unlock();
+    return len;
+}
+
+#define CMUX_CHANNEL(n)                                                      \
+    static unsigned int cmux_write_##n(const void *buf, unsigned int len)    \
+    {                                                                        \
+        return cmux_write(n, buf, len);                                      \
+    }                                                                        \
+    static unsigned int cmux_read_##n(void *buf, unsigned int len)           \
+    {                                                                        \
+        return cmux_read(n, buf, len);                                       \
+    }
+
+CMUX_CHANNEL(1)
+#if AT_CMUX_CHANNELS > 1
+CMUX_CHANNEL(2)
+#endif
+#if AT_CMUX_CHANNELS > 2
+CMUX_CHANNEL(3)
+#endif
+#if AT_CMUX_CHANNELS > 3
+CMUX_CHANNEL(4)
+#endif
+
+static const cmux_thunk_t cmux_thunks[AT_CMUX_CHANNELS] = {
+    {cmux_write_1, cmux_read_1},
+#if AT_CMUX_CHANNELS > 1
+    {cmux_write_2, cmux_read_2},
+#endif
+#if AT_CMUX_CHANNELS > 2
+    {cmux_write_3, cmux_read_3},
+#endif
+#if AT_CMUX_CHANNELS > 3
+    {cmux_write_4, cmux_read_4},
+#endif
+};
+
+/**
+ * @brief  Initialize the multiplexer, the module must already be in CMUX mode (AT+CMUX=0).
+ * @param  port Physical port (must be a global resident object).
+ * @return true - success, false - invalid port.
+ */
+bool at_cmux_init(const at_cmux_port_t *port)
+{
+    if (port == NULL || port->write == NULL || port->read == NULL)
+        return false;
+    memset(&cmux, 0, sizeof(cmux));
+    cmux.port = port;
+    return true;
+}
+
+/**
+ * @brief  Open a data link connection (send SABM), DLCI 0 (the control channel) must be
+ *         opened first.
+ * @return true - the request has been sent, check at_cmux_is_open for the result.
+ */
+bool at_cmux_open(int dlci)
+{
+    bool ret;
+    if (cmux.port == NULL || dlci < 0 || dlci > AT_CMUX_CHANNELS)
+        return false;
+    cmux_lock();
+    ret = dlci == 0 || cmux.state[0] == DLC_OPEN;
+    if (ret)
+    {
+        cmux.state[dlci] = DLC_OPENING;
+        ret = cmux_send_frame(dlci, 1, CMUX_SABM | CMUX_PF, NULL, 0);
+    }
+    cmux_unlock();
+    return ret;
+}
+
+/**
+ * @brief  Indicates whether a data link connection is established.
+ */
+bool at_cmux_is_open(int dlci)
+{
+    return cmux.port != NULL && dlci >= 0 && dlci <= AT_CMUX_CHANNELS && cmux.state[dlci] == DLC_OPEN;
+}
+
+/**
+ * @brief  Close a data link connection (send DISC).
+ */
+void at_cmux_close(int dlci)
+{
+    if (cmux.port == NULL || dlci < 0 || dlci > AT_CMUX_CHANNELS)
+        return;
+    cmux_lock();
+    if (cmux.state[dlci] != DLC_CLOSED)
+    {
+        cmux.state[dlci] = DLC_CLOSING;
+        cmux_send_frame(dlci, 1, CMUX_DISC | CMUX_PF, NULL, 0);
+    }
+    cmux_unlock();
+}
+
+/**
+ * @brief  Close down the multiplexer (CLD), the module returns to AT command mode.
+ */
+void at_cmux_stop(void)
+{
+    if (cmux.port == NULL)
+        return;
+    cmux_lock();
+    if (cmux.state[0] == DLC_OPEN)
+        cmux_send_msg(CMUX_MSG_CLD, 1, NULL, 0);
+    cmux_close_all();
+    cmux_unlock();
+}
+
+/**
+ * @brief  Process the received frames without reading a channel (such as while waiting
+ *         for the channels to open), the channels that receive data are notified.
+ */
+void at_cmux_poll(void)
+{
+    if (cmux.port == NULL)
+        return;
+    cmux_lock();
+    cmux_pump(0);
+    cmux_unlock();
+}
+
+/**
+ * @brief  Fill in the read/write interfaces of the adapter of a channel, the rest of the
+ *         adapter (buffer sizes, lock, notify...) is set by the caller.
+ * @param  dlci    Channel (1 ~ AT_CMUX_CHANNELS)
+ * @param  adapter Adapter (must be a global resident object), its 'notify' interface is
+ *                 also called when data for the channel is received while another channel
+ *                 is read.
+ * @return true - success, false - invalid channel.
+ */
+bool at_cmux_adapter(int dlci, at_adapter_t *adapter)
+{
+    if (cmux.port == NULL || dlci < 1 || dlci > AT_CMUX_CHANNELS)
+        return false;
+    adapter->write = cmux_thunks[dlci - 1].write;
+    adapter->writev = NULL;
+    adapter->read = cmux_thunks[dlci - 1].read;
+    cmux.ch[dlci - 1].adapter = adapter;
+    return true;
+}
+
+/**
+ * @brief  Get the multiplexer statistics.
+ */
+void at_cmux_get_stat(at_cmux_stat_t *stat)
+{
+    *stat = cmux.stat;
+}
+
+#endif //End of AT_CMUX_EN
@@ -5,7 +5,9 @@
 #include <string.h>
 #include "driver/uart.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "esp_log.h" // 用于ESP_LOGI
 #include <stdarg.h>  // 用于va_list, va_start, va_end
 #include <stdio.h>   // 用于vsnprintf
@@ -15,6 +17,15 @@ static const char *TAG = "AT_Device";
 // 声明一个全局的互斥锁变量
 SemaphoreHandle_t at_mutex;
 
+// UART驱动事件队列
+static QueueHandle_t uart_queue;
+
+// 命令提交唤醒信号量(不向驱动的事件队列投递自定义事件)
+static SemaphoreHandle_t wakeup_sem;
+
+// 队列集合，AT任务同时等待串口事件和命令提交
+static QueueSetHandle_t wait_set;
+
 /**
  * @brief AT设备
  */
@@ -22,7 +33,6 @@ typedef struct
 {
     // ring_buf_t rb_tx;
     // ring_buf_t rb_rx;
-    unsigned char txbuf[UART_BUF_SIZE];
     unsigned char rxbuf[UART_BUF_SIZE];
 } at_device_t;
 
@@ -72,11 +82,37 @@ void at_mutex_unlock(void)
 }
 
 /**
- * @brief AT模拟器初始化()
+ * @brief AT设备初始化
+ *
+ * 配置UART参数，安装带事件队列的UART驱动并设置相关引脚。
+ * 事件队列与唤醒信号量加入同一个队列集合，用于在事件驱动模式下唤醒AT任务。
  */
 void at_device_init(void)
 {
-    // 未使用，直接使用ec800_uart_init()初始化
+    uart_config_t uart_config = {
+        .baud_rate = ec800M_BAND,        // Set the baud rate
+        .data_bits = UART_DATA_8_BITS,   // Set the data bits
+        .parity = UART_PARITY_DISABLE,   // Disable parity
+        .stop_bits = UART_STOP_BITS_1,   // Set the stop bits
+        .source_clk = UART_SCLK_DEFAULT, // Set the source clock
+    };
+    int intr_alloc_flags = 0; // Define the interrupt allocation flags
+
+    ESP_ERROR_CHECK(uart_driver_install(UART_PORT_NUM, UART_BUF_SIZE * 2, UART_BUF_SIZE * 2,
+                                        UART_EVENT_QUEUE_SIZE, &uart_queue, intr_alloc_flags)); // Install the UART driver
+    ESP_ERROR_CHECK(uart_param_config(UART_PORT_NUM, &uart_config));                            // Configure the UART parameters
+    ESP_ERROR_CHECK(uart_set_pin(UART_PORT_NUM, ec800M_TX, ec800M_RX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE)); // Set the UART pins
+
+    // 队列集合的长度须能容纳所有成员的元素(事件队列 + 二值信号量)
+    wakeup_sem = xSemaphoreCreateBinary();
+    wait_set = xQueueCreateSet(UART_EVENT_QUEUE_SIZE + 1);
+    if (wakeup_sem == NULL || wait_set == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to create the wait set");
+        return;
+    }
+    xQueueAddToSet(uart_queue, wait_set);
+    xQueueAddToSet(wakeup_sem, wait_set);
 }
 
 /*
@@ -110,6 +146,25 @@ unsigned int at_device_write(const void *buf, unsigned int len)
     return (unsigned int)ret;
 }
 
+/*
+ * @brief	    向串口发送多段数据(逐段写入UART驱动的发送环形缓冲区，不经过共享的
+ *              中间缓冲区，因此没有长度限制，也不需要额外加锁)
+ * @param[in]   iov       -  数据段
+ * @param[in]   iovcnt    -  数据段个数
+ * @return 	    实际写入总长度
+ */
+unsigned int at_device_writev(const at_iovec_t *iov, int iovcnt)
+{
+    unsigned int total = 0;
+    int i;
+    for (i = 0; i < iovcnt; i++)
+    {
+        if (iov[i].len > 0)
+            total += at_device_write(iov[i].base, iov[i].len);
+    }
+    return total;
+}
+
 /*
  * @brief	    读取串口接收缓冲区的数据
  * @param[in]   buf       -  数据缓存
@@ -120,7 +175,12 @@ unsigned int at_device_write(const void *buf, unsigned int len)
 unsigned int at_device_read(void *buf, unsigned int len)
 {
     // 使用 uart_read_bytes 函数从 UART 缓冲区读取数据
+#if AT_DEVICE_EVENT_EN
+    // 事件驱动模式下由at_device_wait()负责等待，这里不阻塞
+    int ret = uart_read_bytes(UART_PORT_NUM, buf, len, 0);
+#else
     int ret = uart_read_bytes(UART_PORT_NUM, buf, len, 20 / portTICK_PERIOD_MS);
+#endif
     // 检查 uart_write_bytes 是否返回了错误
     if (ret == -1)
     {
@@ -158,6 +218,54 @@ void at_debug(const char *fmt, ...)
     ESP_LOGI(TAG, "%s", buffer); // 使用ESP_LOGI处理格式化后的字符串
     va_end(args);
 }
+/**
+ * @brief 唤醒AT任务(有新命令提交时由AT框架调用)
+ */
+void at_device_notify(void)
+{
+    // 信号量已被释放时说明AT任务马上就会被唤醒，重复释放会直接返回
+    if (wakeup_sem != NULL)
+        xSemaphoreGive(wakeup_sem);
+}
+
+/**
+ * @brief 等待串口事件、命令提交或超时
+ *
+ * @param ms 最长等待时间(ms)，AT_DEVICE_WAIT_FOREVER表示一直等待
+ */
+void at_device_wait(unsigned int ms)
+{
+    QueueSetMemberHandle_t member;
+    uart_event_t event;
+    TickType_t ticks;
+    if (ms == AT_DEVICE_WAIT_FOREVER)
+        ticks = portMAX_DELAY;
+    else // 向上取整，避免不足一个tick时变成忙等
+        ticks = (ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+
+    if (wait_set == NULL)
+    {
+        vTaskDelay(ticks == portMAX_DELAY ? 1 : ticks);
+        return;
+    }
+    member = xQueueSelectFromSet(wait_set, ticks);
+    // 合并睡眠期间累积的事件，一次唤醒处理所有已到达的数据。
+    // 每个被选中的成员都要取出一个元素，否则队列集合与成员的计数会不一致
+    while (member != NULL)
+    {
+        if (member == wakeup_sem)
+        {
+            xSemaphoreTake(wakeup_sem, 0);
+        }
+        else if (xQueueReceive(uart_queue, &event, 0) == pdTRUE &&
+                 (event.type == UART_FIFO_OVF || event.type == UART_BUFFER_FULL))
+        {
+            ESP_LOGW(TAG, "UART rx overflow, event:%d", event.type);
+        }
+        member = xQueueSelectFromSet(wait_set, 0);
+    }
+}
+
 /**
  * @brief 触发生成URC消息
  */
@@ -0,0 +1,106 @@
+/******************************************************************************
+ * @brief        Fixed-block memory pool for the AT component
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "at_pool.h"
+#include <stddef.h>
+
+#define POOL_INDEX_MASK 0xFFFFu
+#define POOL_TAG_INC    0x10000u
+
+/**
+ * @brief  Get the block of the specified index (index starts from 1).
+ */
+static inline unsigned char *pool_block(at_pool_t *pool, unsigned int index)
+{
+    return pool->base + (index - 1) * pool->blksize;
+}
+
+/**
+ * @brief  The index of the next free block is stored at the beginning of a free block.
+ */
+static inline unsigned short *pool_next(at_pool_t *pool, unsigned int index)
+{
+    return (unsigned short *)pool_block(pool, index);
+}
+
+/**
+ * @brief  Initialize a pool.
+ * @param  storage Block storage (at least AT_POOL_ALIGN(blksize) * count bytes, 8-byte aligned)
+ * @param  blksize Block size
+ * @param  count   Number of blocks (< 65535)
+ */
+void at_pool_init(at_pool_t *pool, void *storage, unsigned short blksize, unsigned short count)
+{
+    unsigned int i;
+    pool->base = storage;
+    pool->blksize = AT_POOL_ALIGN(blksize);
+    pool->count = count;
+    pool->used = 0;
+    pool->max_used = 0;
+    for (i = 1; i <= count; i++)
+        *pool_next(pool, i) = i < count ? i + 1 : 0;
+    pool->head = count ? 1 : 0;
+}
+
+/**
+ * @brief  Allocate a block.
+ * @return Pointer to the block, NULL if the pool is exhausted.
+ */
+void *at_pool_alloc(at_pool_t *pool)
+{
+    unsigned int head, next, index;
+    unsigned short used, max;
+    head = __atomic_load_n(&pool->head, __ATOMIC_ACQUIRE);
+    do
+    {
+        index = head & POOL_INDEX_MASK;
+        if (index == 0)
+            return NULL;
+        next = ((head & ~POOL_INDEX_MASK) + POOL_TAG_INC) | *pool_next(pool, index);
+    } while (!__atomic_compare_exchange_n(&pool->head, &head, next, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    used = __atomic_add_fetch(&pool->used, 1, __ATOMIC_RELAXED);
+    max = __atomic_load_n(&pool->max_used, __ATOMIC_RELAXED);
+    while (used > max && !__atomic_compare_exchange_n(&pool->max_used, &max, used, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+    return pool_block(pool, index);
+}
+
+/**
+ * @brief  Release a block.
+ * @param  ptr Pointer to the block, as returned by at_pool_alloc.
+ * @return false - the pointer is not the start of a block of this pool (nothing is released).
+ */
+bool at_pool_free(at_pool_t *pool, void *ptr)
+{
+    unsigned int head, next, index, offset;
+    if (!at_pool_contains(pool, ptr))
+        return false;
+    offset = (unsigned char *)ptr - pool->base;
+    if (offset % pool->blksize != 0)
+        return false;
+    index = offset / pool->blksize + 1;
+    head = __atomic_load_n(&pool->head, __ATOMIC_RELAXED);
+    do
+    {
+        *pool_next(pool, index) = head & POOL_INDEX_MASK;
+        next = ((head & ~POOL_INDEX_MASK) + POOL_TAG_INC) | index;
+    } while (!__atomic_compare_exchange_n(&pool->head, &head, next, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    __atomic_sub_fetch(&pool->used, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+/**
+ * @brief  Indicates whether the pointer belongs to the pool.
+ */
+bool at_pool_contains(const at_pool_t *pool, const void *ptr)
+{
+    const unsigned char *p = ptr;
+    return p >= pool->base && p < pool->base + (unsigned int)pool->blksize * pool->count;
+}
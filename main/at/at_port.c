@@ -15,6 +15,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_heap_caps.h"
+#include "at_chat.h"
 
 /**
  * @brief Custom malloc for AT component.
@@ -44,4 +45,37 @@ unsigned int at_get_ms(void)
     unsigned int ms = ticks * 1000 / configTICK_RATE_HZ;
 
     return ms;
-}
\ No newline at end of file
+}
+
+#if AT_SYNC_EN
+#if AT_SYNC_NOTIFY_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES
+#error "AT_SYNC_NOTIFY_INDEX needs CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES > AT_SYNC_NOTIFY_INDEX"
+#endif
+/**
+ * @brief Gets the task calling a blocking AT interface (its notification AT_SYNC_NOTIFY_INDEX
+ *        is used, other users of the task keep the default notification).
+ */
+void *at_sync_waiter(void)
+{
+    return xTaskGetCurrentTaskHandle();
+}
+/**
+ * @brief Wakes up a task waiting in at_sync_wait (called by the AT task).
+ */
+void at_sync_signal(void *waiter)
+{
+    xTaskNotifyGiveIndexed((TaskHandle_t)waiter, AT_SYNC_NOTIFY_INDEX);
+}
+/**
+ * @brief Waits for at_sync_signal, returns 0 on timeout.
+ */
+int at_sync_wait(unsigned int ms)
+{
+    TickType_t ticks;
+    if (ms == AT_WAIT_FOREVER)
+        ticks = portMAX_DELAY;
+    else // 向上取整，pdMS_TO_TICKS向下取整，不足一个tick的等待会立即超时
+        ticks = (TickType_t)(((unsigned long long)ms * configTICK_RATE_HZ + 999) / 1000);
+    return ulTaskNotifyTakeIndexed(AT_SYNC_NOTIFY_INDEX, pdTRUE, ticks) != 0;
+}
+#endif
@@ -28,8 +28,10 @@ static const at_adapter_t at_adapter = {
     .lock = at_mutex_lock,     // 多任务上锁(非OS下填NULL)
     .unlock = at_mutex_unlock, // 多任务解锁(非OS下填NULL)
     .write = at_device_write,  // 数据写接口
+    .writev = at_device_writev, // 多段数据写接口(一次发送整帧)
     .read = at_device_read,    // 数据读接口
     .debug = at_debug,
+    .notify = at_device_notify,    // 命令提交时唤醒AT任务
     .recv_bufsize = UART_BUF_SIZE, // 接收缓冲区大小
     .urc_bufsize = UART_BUF_SIZE
 
@@ -167,28 +169,93 @@ static void mqtt_init_callback(at_response_t *r)
 {
     // printf("MQTT Init %s!\r\n", r->code == AT_RESP_OK ? "ok" : "error");
 }
+/**
+ * @brief  属性上报的载荷(静态存储，直接从该缓冲区写出，无需拷贝)
+ */
+static const char post_payload[] = "{\"id\":\"1\",\"version\":\"1.0\",\"params\":{},\"method\":\"thing.event.property.post\"}";
+
+/**
+ * @brief  发布结果回调(收到 +QMTPUBEX 结果URC后执行)
+ */
+static void mqtt_pub_callback(at_response_t *r)
+{
+    int client, msgid, result;
+    // +QMTPUBEX: <client_idx>,<msgid>,<result>，result 为 0 表示发布成功
+    if (r->code != AT_RESP_OK || sscanf(r->urc, "+QMTPUBEX: %d,%d,%d", &client, &msgid, &result) != 3 || result != 0)
+        ESP_LOGE(TAG, "MQTT publish failed!");
+}
+/**
+ * @brief  发布消息(QoS 0)，等待 '>' 提示符后写入载荷
+ * @param  data 载荷，需在发布完成前保持有效
+ */
+static bool mqtt_publish(at_obj_t *obj, const at_attr_t *attr, const char *topic, const void *data, unsigned int len)
+{
+    at_payload_t payload = {data, len, 0, 0};
+    return at_exec_payload(obj, attr, &payload, "AT+QMTPUBEX=0,0,0,0,\"%s\",%u", topic, len);
+}
+/**
+ * @brief  连接MQTT服务器回调(收到 +QMTCONN 结果URC后才回调)
+ */
+static void mqtt_conn_callback(at_response_t *r)
+{
+    int client, result;
+    at_attr_t attr;
+    // +QMTCONN: <client_idx>,<result>[,<ret_code>]，result 为 0 表示连接成功
+    if (r->code != AT_RESP_OK || sscanf(r->urc, "+QMTCONN: %d,%d", &client, &result) != 2 || result != 0)
+    {
+        ESP_LOGE(TAG, "MQTT connect failed!");
+        return;
+    }
+    ESP_LOGI(TAG, "MQTT connected");
+    at_attr_deinit(&attr);
+    attr.urc = "+QMTPUBEX: 0,"; // 载荷写入后模组先应答OK，发布结果由 +QMTPUBEX URC 上报
+    attr.cb = mqtt_pub_callback;
+    mqtt_publish(r->obj, &attr, "/sys/k0leyWHxYT1/Cat1/thing/event/property/post", post_payload,
+                 sizeof(post_payload) - 1);
+}
+/**
+ * @brief  打开MQTT网络回调(收到 +QMTOPEN 结果URC后才回调)
+ */
+static void mqtt_open_callback(at_response_t *r)
+{
+    int client, result;
+    at_attr_t attr;
+    // +QMTOPEN: <client_idx>,<result>，result 为 0 表示网络打开成功
+    if (r->code != AT_RESP_OK || sscanf(r->urc, "+QMTOPEN: %d,%d", &client, &result) != 2 || result != 0)
+    {
+        ESP_LOGE(TAG, "MQTT open failed!");
+        return;
+    }
+    // 网络打开后尽快连接服务器，否则可能返回 +QMTSTAT: 0,1
+    at_attr_deinit(&attr);
+    attr.urc = "+QMTCONN: 0,"; // 模组先应答OK，收到连接结果后命令才完成
+    attr.urc_timeout = 10000;
+    attr.cb = mqtt_conn_callback;
+    at_exec_cmd(r->obj, &attr, "AT+QMTCONN=0,0");
+}
 /*
  * @brief 模块初始化
  */
 static void mqtt_init(void)
 {
     at_attr_t attr;
-    attr.retry = 1;
     static const char *cmds[] = {
         "AT+QMTCFG=\"recv/mode\",0,0,1",
 
         "AT + QMTCFG = \"aliauth\",0,\"k0leyWHxYT1\",\"Cat1\",\"3af7bc8812cb475e042a0a5ae377c6a1\"",
 
-        "AT+QMTOPEN=0,\"iot-06z00i8mcbcop1x.mqtt.iothub.aliyuncs.com\",1883",
-
-        "AT+QMTCONN=0,0",
-
-        "AT + QMTPUBEX = 0,0,0,0,\"/sys/k0leyWHxYT1/Cat1/thing/event/property/post\",140",
-
         NULL};
     at_attr_deinit(&attr);
+    attr.retry = 1;
     attr.cb = mqtt_init_callback; // 设置命令回调
     at_send_multiline(at_obj, &attr, cmds);
+    /* AT+QMTOPEN 先应答OK，打开结果由 +QMTOPEN URC 上报，收到后命令才完成，
+     * 再由回调发出 AT+QMTCONN，避免在网络打开前连接服务器 */
+    at_attr_deinit(&attr);
+    attr.urc = "+QMTOPEN: 0,";
+    attr.urc_timeout = 60000;
+    attr.cb = mqtt_open_callback;
+    at_send_singlline(at_obj, &attr, "AT+QMTOPEN=0,\"iot-06z00i8mcbcop1x.mqtt.iothub.aliyuncs.com\",1883");
 }
 
 static void at_obj_init(void)
@@ -214,8 +281,13 @@ static void ec800_uart_task(void *pvParameters)
 {
     while (1)
     {
+#if AT_DEVICE_EVENT_EN
+        // 阻塞到串口收到数据、有命令提交或下一个超时到期(空闲时一直阻塞)
+        at_device_wait(at_obj_process_timed(at_obj));
+#else
         at_obj_process(at_obj);
         vTaskDelay(10 / portTICK_PERIOD_MS);
+#endif
     }
     vTaskDelete(NULL);
 }
@@ -229,21 +301,9 @@ static void ec800_uart_task(void *pvParameters)
  */
 static void ec800_uart_init(void) // Define the echo task function
 {
-    /* Configure parameters of an UART driver,
-     * communication pins and install the driver */
-    uart_config_t uart_config = {
-        // Define and initialize the UART configuration
-        .baud_rate = ec800M_BAND,        // Set the baud rate
-        .data_bits = UART_DATA_8_BITS,   // Set the data bits
-        .parity = UART_PARITY_DISABLE,   // Disable parity
-        .stop_bits = UART_STOP_BITS_1,   // Set the stop bits
-        .source_clk = UART_SCLK_DEFAULT, // Set the source clock
-    };
-    int intr_alloc_flags = 0; // Define the interrupt allocation flags
-
-    ESP_ERROR_CHECK(uart_driver_install(UART_PORT_NUM, UART_BUF_SIZE * 2, UART_BUF_SIZE * 2, 0, NULL, intr_alloc_flags)); // Install the UART driver
-    ESP_ERROR_CHECK(uart_param_config(UART_PORT_NUM, &uart_config));                                                      // Configure the UART parameters
-    ESP_ERROR_CHECK(uart_set_pin(UART_PORT_NUM, ec800M_TX, ec800M_RX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));           // Set the UART pins
+    /* UART参数配置、驱动及事件队列的安装由AT设备层完成,
+     * 事件队列用于在串口收到数据时唤醒AT任务 */
+    at_device_init();
 }
 
 /**
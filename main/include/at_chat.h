@@ -22,6 +22,49 @@
  *                             solve the problem of URC matching exception when 
  *                             receiving binary data from the modem.
  * 2023-10-27     roger.luo    Added the function of transparent data transmission.
+ * 2026-10-16     missing-shell Added the work submission notification for 
+ *                             event-driven processing.
+ * 2026-10-16     missing-shell Added at_obj_process_timed to report the next 
+ *                             pending deadline.
+ * 2026-10-16     missing-shell Replaced the linear URC table scan with a 
+ *                             multi-pattern automaton.
+ * 2026-10-16     missing-shell Match command responses incrementally, each received 
+ *                             byte is examined only once.
+ * 2026-10-16     missing-shell Work items and command buffers are allocated from a 
+ *                             fixed-block pool.
+ * 2026-10-16     missing-shell Format commands directly into the work item, the 
+ *                             command length is no longer limited.
+ * 2026-10-16     missing-shell Added the optional vectored write interface.
+ * 2026-10-16     missing-shell Added per-command latency histograms and counters.
+ * 2026-10-16     missing-shell Receive buffer overflow keeps the latest data and 
+ *                             is reported instead of silently clearing the buffer.
+ * 2026-10-16     missing-shell Drain all received data on each processing cycle.
+ * 2026-10-16     missing-shell Redesigned the transparent transmission pump (large 
+ *                             buffers, draining, zero-copy reading, streaming 
+ *                             exit command detection).
+ * 2026-10-16     missing-shell Binary-safe response and URC matching, '\0' is no 
+ *                             longer treated as a URC end mark.
+ * 2026-10-16     missing-shell Streaming URC payloads (header, data and end handlers),
+ *                             large payloads no longer need to fit in the URC buffer.
+ * 2026-10-16     missing-shell AT_PRIORITY_LEVELS priority levels with aging and optional
+ *                             per-work deadlines (earliest deadline first in a level).
+ * 2026-10-16     missing-shell Response cache of idempotent query commands (TTL, joining
+ *                             of identical queries in flight, URC invalidation).
+ * 2026-10-16     missing-shell Adaptive response timeouts and retry delays estimated from
+ *                             the measured response times, multiline commands honor 
+ *                             the timeout attribute.
+ * 2026-10-16     missing-shell Retry policies (exponential backoff with jitter, maximum 
+ *                             elapsed time, non-retryable +CME/+CMS ERROR codes), a 
+ *                             failed line ends a multiline command with an error.
+ * 2026-10-16     missing-shell Lock-free work submission, the AT task moves the 
+ *                             submitted work to its private queues without the lock.
+ * 2026-10-16     missing-shell Blocking command interfaces, the calling task sleeps 
+ *                             until the AT task signals the result.
+ * 2026-10-16     missing-shell Coroutine work, a multi-step flow awaits commands, URCs 
+ *                             and delays as one linear work item.
+ * 2026-10-16     missing-shell Result URC of commands, the work completes when the URC
+ *                             reporting the result of the command is received.
+ * 2026-10-16     missing-shell Prompt commands, the payload is written after the '>' prompt.
  ******************************************************************************/
 #ifndef _AT_CHAT_H_
 #define _AT_CHAT_H_
@@ -30,6 +73,11 @@
 #include <stdbool.h>
 #include <stdarg.h>
 
+/**
+ *@brief Returned by at_obj_process_timed when there is no pending deadline.
+ */
+#define AT_WAIT_FOREVER     0xFFFFFFFFu
+
 struct at_obj;                      
 struct at_adapter;                  
 struct at_response;                 
@@ -56,11 +104,12 @@ typedef enum {
 } at_resp_code;
 
 /**
- *@brief AT command request priority
+ *@brief AT command request priority, any level from AT_PRIORITY_LOW to AT_PRIORITY_HIGH 
+ *       can be used (higher levels run first).
  */
 typedef enum {
     AT_PRIORITY_LOW = 0,
-    AT_PRIORITY_HIGH   
+    AT_PRIORITY_HIGH = AT_PRIORITY_LEVELS - 1
 } at_cmd_priority;
 
 /**
@@ -68,7 +117,8 @@ typedef enum {
  */
 typedef enum {
     URC_RECV_OK = 0,               /* URC frame received successfully. */
-    URC_RECV_TIMEOUT               /* Receive timeout (The frame prefix is matched but the suffix is not matched within AT_URC_TIMEOUT) */
+    URC_RECV_TIMEOUT,              /* Receive timeout (The frame prefix is matched but the suffix is not matched within AT_URC_TIMEOUT) */
+    URC_RECV_OVERFLOW              /* The frame does not fit in the URC buffer, the received part is delivered and the rest is discarded */
 } urc_recv_status;
 
 /**
@@ -76,8 +126,9 @@ typedef enum {
  */
 typedef struct {
     urc_recv_status status;        /* URC frame receiving status.*/
-    char *urcbuf;                  /* URC frame buffer*/
-    int   urclen;                  /* URC frame buffer length*/
+    char *urcbuf;                  /* URC frame buffer (may contain binary data, it is followed by a '\0')*/
+    int   urclen;                  /* URC frame length (exact number of received bytes)*/
+    int   skip;                    /* (Streaming items) Bytes to discard before the payload, set by the handler*/
 } at_urc_info_t;
 
 /**
@@ -95,8 +146,30 @@ typedef struct {
      *                    to receive the remaining data and continues to call back this interface).
      */    
     int (*handler)(at_urc_info_t *info);
+    /**
+     * @brief   Streaming payload handler (optional, NULL: the frame is accumulated in the URC 
+     *          buffer). When it is set, 'handler' parses the frame header and its return value 
+     *          is the length of the payload that follows (0: no payload, URC_STREAM_MORE: the 
+     *          header is incomplete, call again at the next end mark). The payload is passed 
+     *          here in chunks as it is received, without being stored in the URC buffer, so 
+     *          its size is not limited by urc_bufsize.
+     * @params  buf    - Payload chunk.
+     * @params  len    - Chunk length.
+     */
+    void (*data)(const char *buf, unsigned int len);
+    /**
+     * @brief   End of the streamed payload (optional).
+     * @params  status - URC_RECV_OK when the whole payload has been received, URC_RECV_TIMEOUT
+     *                   when the data stopped for longer than AT_URC_TIMEOUT.
+     */
+    void (*end)(urc_recv_status status);
 } urc_item_t;
 
+/**
+ * @brief Streaming URC header handler return value: the header is incomplete.
+ */
+#define URC_STREAM_MORE  (-1)
+
 /**
  * @brief AT response information
  */
@@ -105,7 +178,7 @@ typedef struct {
     void           *params;         /* User parameters (referenced from ->at_attr_t.params)*/	
     at_resp_code    code;           /* AT command response code.*/    
 	unsigned short  recvcnt;        /* Receive data length*/    
-    char           *recvbuf;        /* Receive buffer (raw data)*/
+    char           *recvbuf;        /* Receive buffer (raw data, may contain '\0', use recvcnt)*/
     /* Pointer to the receiving content prefix, valid when code=AT_RESP_OK, 
        if no prefix is specified, it pointer to recvbuf
     */
@@ -114,6 +187,20 @@ typedef struct {
        if no suffix is specified, it pointer to recvbuf
     */
     char           *suffix;
+    /* Number of response bytes discarded because the receive buffer overflowed (the oldest 
+       data is discarded, 0 means the response is complete).
+    */
+    unsigned int    dropped;
+    /* Error code of a "+CME ERROR: <n>" or "+CMS ERROR: <n>" response, valid when 
+       code=AT_RESP_ERROR (-1 for a plain "ERROR" or a verbose error text).
+    */
+    int             error;
+#if AT_RESULT_URC_EN
+    /* Pointer to the result URC in the receive buffer (see at_attr_t.urc), valid when 
+       code=AT_RESP_OK, NULL if the command has no result URC.
+    */
+    char           *urc;
+#endif
 } at_response_t;
 
 /**
@@ -144,8 +231,33 @@ typedef struct {
      * @return      The length of the data actually read
      */    
     unsigned int (*read) (void *buf, unsigned int len);
+    /**
+     * @brief       Zero-copy reading interface (optional, takes precedence over 'read'), the 
+     *              data is written to the modem directly from the returned buffer and then 
+     *              released with 'consume', fill in NULL if not supported.
+     * @param       len   Returns the length of the readable data
+     * @return      Pointer to the readable data, NULL if there is none.
+     */    
+    const void  *(*peek)(unsigned int *len);
+    /**
+     * @brief       Release data obtained with 'peek'
+     * @param       len   Length of the data written to the modem
+     */    
+    void         (*consume)(unsigned int len);
+    /**
+     * @brief       Transparent transmission buffer size, 0 to use AT_RAW_BUF_SIZE.
+     */    
+    unsigned int bufsize;
 } at_raw_trans_conf_t;
 
+/**
+ * @brief Data segment of a vectored write.
+ */
+typedef struct {
+    const void   *base;             /* Segment data*/
+    unsigned int  len;              /* Segment length*/
+} at_iovec_t;
+
 /**
  * @brief AT interface adapter
  */
@@ -183,6 +295,22 @@ typedef struct  {
 #endif    
     //Command response receiving buffer size, set according to the actual maximum command response length
     unsigned short recv_bufsize;
+    /* Members added later are appended here, so that positional initializers of the
+     * members above keep working.*/
+    /**
+     * @brief       Work submission notification, used to wake up the task that runs
+     *              at_obj_process in event-driven mode, fill in NULL if not required.
+     */
+    void (*notify)(void);
+    /**
+     * @brief       Vectored data write operation (non-blocking), all segments of a frame
+     *              are written at once, fill in NULL if not supported (the 'write'
+     *              interface is then called for each segment).
+     * @param       iov    Data segments
+     * @param       iovcnt Number of segments
+     * @return      Indicates the total length of the written data
+     */
+    unsigned int (*writev)(const at_iovec_t *iov, int iovcnt);
 } at_adapter_t;
 
 /**
@@ -202,7 +330,7 @@ typedef struct at_env {
     bool        (*is_timeout)(struct at_env *self, unsigned int ms);
     //Formatted printout with newlines
     void        (*println)(struct at_env *self, const char *fmt, ...);
-    //Find a keyword from the received content      
+    //Find a keyword from the received content (binary safe)      
     char *      (*contains)(struct at_env *self, const char *str); 
     //Get receives buffer       
     char *      (*recvbuf)(struct at_env *self);                  
@@ -252,6 +380,154 @@ typedef struct {
 
 #endif
 
+#if AT_PAYLOAD_EN
+/**
+ *@brief Payload of a prompt command (see at_exec_payload).
+ */
+typedef struct {
+    const void    *data;          /* Payload data*/
+    unsigned int   len;           /* Payload length*/
+    unsigned short prompt_timeout;/* Prompt timeout (ms), 0: AT_DEF_PROMPT_TIMEOUT*/
+    unsigned char  copy;          /* 1: the payload is copied into the work item (the data can be
+                                     released at once), 0: it is borrowed and written from 'data',
+                                     which must stay valid until the work ends*/
+} at_payload_t;
+#endif
+
+#if AT_COROUTINE_EN
+/**
+ *@brief Coroutine work (stackless, protothread style). The body is an at_work_t function 
+ *       submitted with at_do_coroutine, written as a linear flow between AT_CO_BEGIN and 
+ *       AT_CO_END:
+ *
+ *       static int mqtt_open(at_env_t *env)
+ *       {
+ *           AT_CO_BEGIN(env);
+ *           AT_CO_CMD(env, NULL, "AT+QMTOPEN=0,\"%s\",%d", HOST, PORT);
+ *           if (at_co_result(env) != AT_RESP_OK)
+ *               AT_CO_EXIT(env, AT_RESP_ERROR);
+ *           AT_CO_URC(env, "+QMTOPEN: 0,", 75000);
+ *           if (at_co_result(env) != AT_RESP_OK || atoi(at_co_resp(env) + 12) != 0)
+ *               AT_CO_EXIT(env, AT_RESP_ERROR);
+ *           AT_CO_END(env);
+ *       }
+ *
+ *       The resume point is kept in env->state, so local variables do not survive an await
+ *       (keep the state in env->i, env->j or env->params) and an await cannot be placed in 
+ *       a switch statement of the body. The coroutine is not resumed until what it awaits 
+ *       ends, the AT task sleeps meanwhile. Each await takes its resume label from __COUNTER__
+ *       (offset by 1, 0 is AT_CO_BEGIN), so several awaits may share a source line.
+ */
+#define AT_CO_BEGIN(env)           switch ((env)->state) { case 0:
+#define AT_CO_END(env)             } return true
+
+/**
+ *@brief End the coroutine with a response code.
+ */
+#define AT_CO_EXIT(env, code)      do { (env)->finish((env), (code)); return true; } while (0)
+
+/**
+ *@brief Suspend the coroutine until 'expr' (an at_co_xxx await) returns false.
+ */
+#define AT_CO_AWAIT(env, expr)     AT_CO_AWAIT_AT(env, expr, __COUNTER__ + 1)
+
+/**
+ *@brief Give the other processing a cycle, the coroutine is resumed after AT_POLL_INTERVAL.
+ */
+#define AT_CO_YIELD(env)           AT_CO_YIELD_AT(env, __COUNTER__ + 1)
+
+/**
+ *@brief Send a command and await its result (at_co_result, at_co_resp), see at_co_vcmd.
+ */
+#define AT_CO_CMD(env, attr, ...)  AT_CO_AWAIT(env, at_co_cmd((env), (attr), __VA_ARGS__))
+
+/**
+ *@brief Await a URC line starting with 'prefix' for up to 'ms' milliseconds, see at_co_urc.
+ */
+#define AT_CO_URC(env, prefix, ms) AT_CO_AWAIT(env, at_co_urc((env), (prefix), (ms)))
+
+/**
+ *@brief Sleep for 'ms' milliseconds.
+ */
+#define AT_CO_SLEEP(env, ms)       AT_CO_AWAIT(env, at_co_sleep((env), (ms)))
+
+/**
+ *@brief Poll a condition every AT_POLL_INTERVAL until it holds or 'ms' milliseconds have passed.
+ */
+#define AT_CO_WAIT_UNTIL(env, cond, ms) do { (env)->reset_timer(env); \
+                                        AT_CO_AWAIT(env, !(cond) && !(env)->is_timeout((env), (ms))); } while (0)
+
+#define AT_CO_AWAIT_AT(env, expr, label) do { (env)->state = (label); AT_CO_FALLTHROUGH; case (label): \
+                                        if (expr) return false; } while (0)
+#define AT_CO_YIELD_AT(env, label)  do { (env)->state = (label); return false; case (label):; } while (0)
+
+#if defined(__GNUC__) && __GNUC__ >= 7
+#define AT_CO_FALLTHROUGH          __attribute__((fallthrough))
+#else
+#define AT_CO_FALLTHROUGH          ((void)0)
+#endif
+#endif
+
+#if AT_SYNC_EN
+/**
+ *@brief Result of a blocking command (see at_exec_cmd_sync).
+ */
+typedef struct {
+    unsigned int    wait;         /* Maximum waiting time (ms), AT_WAIT_FOREVER: until the work ends*/
+    char           *buf;          /* Receives a copy of the response ('\0' terminated), NULL if not required*/
+    unsigned short  bufsize;      /* Size of 'buf'*/
+    unsigned short  len;          /* Length of the copied response*/
+    at_resp_code    code;         /* Response code (same as the return value)*/
+    int             error;        /* +CME/+CMS ERROR code, -1 if none*/
+    char           *prefix;       /* Pointer to the response prefix in 'buf' (as at_response_t.prefix),
+                                     NULL if it was not copied*/
+#if AT_RESULT_URC_EN
+    char           *urc;          /* Pointer to the result URC in 'buf' (as at_response_t.urc), 
+                                     NULL if none or it was not copied*/
+#endif
+} at_sync_resp_t;
+#endif
+
+/**
+ *@brief Class of a failed command attempt.
+ */
+typedef enum {
+    AT_FAIL_TIMEOUT = 0,         /* No response within the response timeout*/
+    AT_FAIL_ERROR,               /* Plain "ERROR" response*/
+    AT_FAIL_CME,                 /* "+CME ERROR: <n>" (equipment/network error)*/
+    AT_FAIL_CMS                  /* "+CMS ERROR: <n>" (message service error)*/
+} at_fail_class;
+
+#if AT_RETRY_POLICY_EN
+/**
+ *@brief Retry policy (shared by any number of commands through at_attr_t.policy).
+ */
+typedef struct {
+    unsigned short base;         /* Delay before the first resend (ms), 0: the retry delay 
+                                    estimated for the command*/
+    unsigned short max_delay;    /* Upper bound of the resend delay (ms), 0: none*/
+    unsigned char  factor;       /* Delay multiplier of each further resend (0 or 1: constant)*/
+    unsigned char  jitter;       /* Random part of the delay (percent, 100: full jitter)*/
+    unsigned short max_elapsed;  /* No resend once this time has passed since the submission
+                                    of the command (ms), 0: no limit*/
+    const short   *fatal_cme;    /* Non-retryable +CME ERROR codes (terminated by -1), NULL: none*/
+    const short   *fatal_cms;    /* Non-retryable +CMS ERROR codes (terminated by -1), NULL: none*/
+    /**
+     * @brief   Retry filter (optional, it replaces the fatal code lists).
+     * @params  cls  - Class of the failed attempt.
+     * @params  code - +CME/+CMS ERROR code, -1 if none.
+     * @return  true if the command may be resent.
+     */
+    bool (*retryable)(at_fail_class cls, int code);
+} at_retry_policy_t;
+
+/**
+ *@brief Built-in policy: exponential backoff (x2, 50% jitter, up to 5 s) from the estimated 
+ *       retry delay, SIM, PIN and unsupported operation errors are not retried.
+ */
+extern const at_retry_policy_t at_retry_backoff;
+#endif
+
 /**
  *@brief AT attributes
  */
@@ -266,6 +542,23 @@ typedef struct {
     unsigned short timeout;      /* Response timeout(ms).. */
     unsigned char  retry;        /* Response error retries. */
     at_cmd_priority priority;    /* Command execution priority. */
+    unsigned short deadline;     /* Deadline (ms after submission), work of the same level runs
+                                    earliest deadline first, 0 if not required. */
+#if AT_RESULT_URC_EN
+    unsigned short urc_timeout;  /* Result URC timeout (ms after the response). */
+    const char    *urc;          /* Result URC prefix (such as "+QMTOPEN: 0,"), the command only 
+                                    completes once a line starting with it is received after the 
+                                    response (AT_RESP_TIMEOUT if it is not received within 
+                                    'urc_timeout', the command is not resent), NULL if not required. */
+#endif
+#if AT_RETRY_POLICY_EN
+    const at_retry_policy_t *policy; /* Retry policy (up to 'retry' resends), NULL: every error
+                                    and timeout is resent. */
+#endif
+    unsigned char  stop_on_error; /* Multiline commands: 1 - a line that still fails after its
+                                    resends ends the command with AT_RESP_ERROR, 0 - it is
+                                    skipped and the next line is sent, the command succeeds if
+                                    any line did (default). */
 } at_attr_t;
 
 /**
@@ -299,12 +592,24 @@ void at_obj_urc_set_enable(at_obj_t *at, int enable, unsigned short timeout);
 
 void at_obj_process(at_obj_t *at);
 
+unsigned int at_obj_process_timed(at_obj_t *at);
+
+void at_obj_set_rxbuf(at_obj_t *at, void *buf, unsigned int size);
+
+void at_obj_set_aging(at_obj_t *at, unsigned int interval);
+
 void at_attr_deinit(at_attr_t *attr);
 
 bool at_exec_cmd(at_obj_t *at, const at_attr_t *attr, const char *cmd, ...);
 
 bool at_exec_vcmd(at_obj_t *at, const at_attr_t *attr, const char *cmd, va_list va);
 
+#if AT_PAYLOAD_EN
+bool at_exec_payload(at_obj_t *at, const at_attr_t *attr, const at_payload_t *payload, const char *cmd, ...);
+
+bool at_exec_vpayload(at_obj_t *at, const at_attr_t *attr, const at_payload_t *payload, const char *cmd, va_list va);
+#endif
+
 bool at_send_singlline(at_obj_t *at, const at_attr_t *attr, const char *singlline);
 
 bool at_send_multiline(at_obj_t *at, const at_attr_t *attr, const char **multiline);
@@ -315,14 +620,153 @@ bool at_custom_cmd(at_obj_t *at, const at_attr_t *attr, void (*sender)(at_env_t
 
 bool at_do_work(at_obj_t *at,  void *params, at_work_t work);
 
+/**
+ *@brief Abort all AT work submitted so far. The abort is deferred: it is applied by the AT
+ *       task at its next processing cycle (the task is woken through the adapter notify).
+ *       Until then the aborted work still reads as pending (at_work_get_state), and the
+ *       callbacks of the aborted work (AT_RESP_ABORT) run later on the AT task. Work 
+ *       submitted after the call is not affected.
+ */
 void at_work_abort_all(at_obj_t *at);
 
+#if AT_COROUTINE_EN
+bool at_do_coroutine(at_obj_t *at, void *params, at_work_t co);
+
+bool at_co_cmd(at_env_t *env, const at_attr_t *attr, const char *cmd, ...);
+
+bool at_co_vcmd(at_env_t *env, const at_attr_t *attr, const char *cmd, va_list va);
+
+bool at_co_urc(at_env_t *env, const char *prefix, unsigned int timeout);
+
+bool at_co_sleep(at_env_t *env, unsigned int ms);
+
+at_resp_code at_co_result(at_env_t *env);
+
+char *at_co_resp(at_env_t *env);
+#endif
+
+#if AT_SYNC_EN
+void at_sync_resp_init(at_sync_resp_t *resp, void *buf, unsigned int bufsize, unsigned int wait);
+
+at_resp_code at_exec_cmd_sync(at_obj_t *at, const at_attr_t *attr, at_sync_resp_t *resp, const char *cmd, ...);
+
+at_resp_code at_exec_vcmd_sync(at_obj_t *at, const at_attr_t *attr, at_sync_resp_t *resp, const char *cmd, va_list va);
+
+at_resp_code at_send_multiline_sync(at_obj_t *at, const at_attr_t *attr, at_sync_resp_t *resp, const char **multiline);
+#endif
+
 #if AT_MEM_WATCH_EN
 unsigned int at_max_used_memory(void);
 
 unsigned int at_cur_used_memory(void);
 #endif
 
+#if AT_POOL_EN
+/**
+ *@brief Pool occupancy statistics of a size class.
+ */
+typedef struct {
+    unsigned short blksize;      /* Block size*/
+    unsigned short count;        /* Total number of blocks*/
+    unsigned short used;         /* Blocks currently in use*/
+    unsigned short max_used;     /* Peak number of blocks in use*/
+    unsigned int   fallback;     /* Requests of this class served by the heap (pool exhausted)*/
+} at_pool_stat_t;
+
+int at_pool_class_count(void);
+
+bool at_pool_get_stat(int index, at_pool_stat_t *stat);
+#endif
+
+#if AT_STATS_EN
+/**
+ *@brief Latency histogram type.
+ */
+typedef enum {
+    AT_STATS_QUEUE = 0,          /* Queue wait (submission -> execution start)*/
+    AT_STATS_MODEM,              /* Modem latency (command sent -> first response byte)*/
+    AT_STATS_TOTAL,              /* Total time (submission -> completion)*/
+    AT_STATS_KIND_MAX
+} at_stats_kind;
+
+/**
+ *@brief Statistics of a command name (the command text up to the first '=' or '?').
+ */
+typedef struct {
+    char         name[AT_STATS_NAME_LEN]; /* Command name, "*" collects the untracked ones*/
+    unsigned int count;          /* Completed executions*/
+    unsigned int errors;         /* Executions ended with an error response*/
+    unsigned int timeouts;       /* Executions ended with a response timeout*/
+    unsigned int retries;        /* Resends after an error response or a timeout*/
+    unsigned int max[AT_STATS_KIND_MAX]; /* Maximum time of each histogram (ms)*/
+} at_cmd_stats_t;
+
+int at_obj_stats_count(at_obj_t *at);
+
+bool at_obj_get_stats(at_obj_t *at, int index, at_cmd_stats_t *stats);
+
+bool at_obj_get_histogram(at_obj_t *at, int index, at_stats_kind kind, unsigned int buckets[AT_STATS_BUCKETS]);
+
+unsigned int at_obj_stats_percentile(at_obj_t *at, int index, at_stats_kind kind, unsigned int percent);
+
+unsigned int at_stats_bucket_limit(int bucket);
+
+void at_obj_stats_reset(at_obj_t *at);
+
+void at_obj_stats_print(at_obj_t *at);
+#endif
+
+#if AT_RTO_EN
+/**
+ *@brief Response time estimation of a command name (the command text up to the first '=' 
+ *       or '?').
+ */
+typedef struct {
+    char         name[AT_STATS_NAME_LEN]; /* Command name, "*" collects the untracked ones*/
+    unsigned int srtt;           /* Smoothed response time (ms)*/
+    unsigned int rttvar;         /* Response time variation (ms)*/
+    unsigned int rto;            /* Current response timeout (ms, 0: static timeout)*/
+    unsigned int samples;        /* Response time samples (responses to a first send)*/
+    unsigned int backoffs;       /* Timeouts, each one doubled the response timeout*/
+} at_rto_info_t;
+
+void at_obj_set_rto(at_obj_t *at, unsigned int min, unsigned int max);
+
+int at_obj_rto_count(at_obj_t *at);
+
+bool at_obj_get_rto(at_obj_t *at, int index, at_rto_info_t *info);
+
+void at_obj_rto_reset(at_obj_t *at);
+#endif
+
+#if AT_CACHE_EN
+/**
+ *@brief Cache rule of an idempotent query command.
+ */
+typedef struct {
+    const char    *cmd;          /* Command text, exact match (such as "AT+CREG?")*/
+    unsigned short ttl;          /* Time to live of a cached response (ms)*/
+    const char    *urc;          /* URC prefix invalidating the cached response (such as "+CREG:"),
+                                    NULL if none. It requires the URC buffer (urc_bufsize).*/
+} at_cache_rule_t;
+
+/**
+ *@brief Cache counters.
+ */
+typedef struct {
+    unsigned int hits;           /* Queries answered from the cache*/
+    unsigned int joins;          /* Queries joined to an identical query in flight*/
+    unsigned int misses;         /* Cached queries sent to the modem*/
+    unsigned int invalidations;  /* Cached responses dropped by a URC*/
+} at_cache_stat_t;
+
+bool at_obj_set_cache(at_obj_t *at, const at_cache_rule_t *tbl, int count);
+
+void at_obj_cache_flush(at_obj_t *at);
+
+void at_obj_get_cache_stat(at_obj_t *at, at_cache_stat_t *stat);
+#endif
+
 #if AT_WORK_CONTEXT_EN
 
 void at_context_init(at_context_t *ctx, void *respbuf, unsigned bufsize);
@@ -338,7 +782,7 @@ at_resp_code  at_work_get_result(at_context_t *ctx);
 #endif //End of AT_WORK_CONTEXT_EN
 
 #if AT_RAW_TRANSPARENT_EN
-void at_raw_transport_enter(at_obj_t *obj, const at_raw_trans_conf_t *conf);
+bool at_raw_transport_enter(at_obj_t *obj, const at_raw_trans_conf_t *conf);
 
 void at_raw_transport_exit(at_obj_t *obj);
 #endif //End of AT_RAW_TRANSPARENT_EN
@@ -0,0 +1,80 @@
+/******************************************************************************
+ * @brief        3GPP TS 27.010 multiplexer (CMUX, basic option)
+ *
+ * The physical port is split into virtual channels (DLCI 1 ~ AT_CMUX_CHANNELS), each of
+ * them is exposed as the read/write interface of an at_adapter_t, so that commands, URCs
+ * and data can run on their own AT object at the same time.
+ *
+ * Typical start sequence:
+ *   1. Send "AT+CMUX=0" through the plain AT object and wait for OK.
+ *   2. at_cmux_init(&port), at_cmux_open(0), at_cmux_open(1) ... at_cmux_open(n).
+ *   3. Call at_cmux_poll until at_cmux_is_open is true for every channel.
+ *   4. Create one AT object per channel with an adapter filled by at_cmux_adapter.
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#ifndef _AT_CMUX_H_
+#define _AT_CMUX_H_
+
+#include "at_chat.h"
+
+#if AT_CMUX_EN
+
+/**
+ * @brief Physical port of the multiplexer.
+ */
+typedef struct {
+    /* Lock of the physical port, required when the channels run in different tasks
+       (it must not be the lock of an AT object), fill in NULL if not required.
+    */
+    void (*lock)(void);
+    void (*unlock)(void);
+    /**
+     * @brief       Data write operation, a frame is only sent when it is written completely.
+     * @return      Indicates the length of the written data
+     */
+    unsigned int (*write)(const void *buf, unsigned int len);
+    /**
+     * @brief       Data read operation (non-blocking)
+     * @return      The length of the data actually read
+     */
+    unsigned int (*read)(void *buf, unsigned int len);
+    /**
+     * @brief       Log output interface, fill in NULL if not required.
+     */
+    void (*debug)(const char *fmt, ...);
+} at_cmux_port_t;
+
+/**
+ * @brief Multiplexer statistics.
+ */
+typedef struct {
+    unsigned int rx_frames;        /* Valid frames received*/
+    unsigned int tx_frames;        /* Frames sent*/
+    unsigned int fcs_errors;       /* Frames discarded because of a bad FCS or length*/
+    unsigned int dropped;          /* Data bytes discarded (channel not open)*/
+} at_cmux_stat_t;
+
+bool at_cmux_init(const at_cmux_port_t *port);
+
+bool at_cmux_open(int dlci);
+
+bool at_cmux_is_open(int dlci);
+
+void at_cmux_close(int dlci);
+
+void at_cmux_stop(void);
+
+void at_cmux_poll(void);
+
+bool at_cmux_adapter(int dlci, at_adapter_t *adapter);
+
+void at_cmux_get_stat(at_cmux_stat_t *stat);
+
+#endif //End of AT_CMUX_EN
+
+#endif //End of _AT_CMUX_H_
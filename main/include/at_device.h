@@ -1,6 +1,8 @@
 #ifndef __AT_DEVICE_H__
 #define __AT_DEVICE_H__
 
+#include "at_chat.h"
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -12,6 +14,10 @@ extern "C"
 #define UART_PORT_NUM (1) // 使用UART1
 #define UART_BUF_SIZE (1024)
 #define DEBUG_BUF_SIZE (512)
+#define UART_EVENT_QUEUE_SIZE (16)
+
+#define AT_DEVICE_EVENT_EN (1)              // 1: 串口事件/命令提交唤醒AT任务, 0: 固定周期轮询
+#define AT_DEVICE_WAIT_FOREVER (0xFFFFFFFFu) // 一直等待，直到有事件发生
 
     void at_mutex_init(void);
 
@@ -27,10 +33,16 @@ extern "C"
 
     unsigned int at_device_write(const void *buf, unsigned int len);
 
+    unsigned int at_device_writev(const at_iovec_t *iov, int iovcnt);
+
     unsigned int at_device_read(void *buf, unsigned int len);
 
     void at_debug(const char *fmt, ...);
 
+    void at_device_notify(void);
+
+    void at_device_wait(unsigned int ms);
+
     void at_device_emit_urc(const void *urc, int size);
 
 #ifdef __cplusplus
@@ -0,0 +1,42 @@
+/******************************************************************************
+ * @brief        Fixed-block memory pool for the AT component
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#ifndef _AT_POOL_H_
+#define _AT_POOL_H_
+
+#include <stdbool.h>
+
+/**
+ *@brief Round a block size up to the pool alignment.
+ */
+#define AT_POOL_ALIGN(size)  (((size) + 7u) & ~7u)
+
+/**
+ *@brief Fixed-block pool.
+ *@note  Allocation and release are O(1) and lock-free (the free list head is tagged to
+ *       avoid the ABA problem), so they can be called from any task.
+ */
+typedef struct {
+    unsigned char  *base;          /* Block storage*/
+    unsigned int    head;          /* Free list head: (tag << 16) | (block index + 1)*/
+    unsigned short  blksize;       /* Block size (aligned)*/
+    unsigned short  count;         /* Number of blocks*/
+    unsigned short  used;          /* Blocks currently in use*/
+    unsigned short  max_used;      /* Peak number of blocks in use*/
+} at_pool_t;
+
+void at_pool_init(at_pool_t *pool, void *storage, unsigned short blksize, unsigned short count);
+
+void *at_pool_alloc(at_pool_t *pool);
+
+bool at_pool_free(at_pool_t *pool, void *ptr);
+
+bool at_pool_contains(const at_pool_t *pool, const void *ptr);
+
+#endif
@@ -8,68 +8,366 @@
 #ifndef __AT_PORT_H__
 #define __AT_PORT_H__
 
+/* Every setting below can be overridden by the board (compiler definitions, such as
+ * -DAT_STATS_EN=1u).*/
+
 /**
  *@brief Default correct response identifier.
  */
-#define AT_DEF_RESP_OK    "OK"     
+#ifndef AT_DEF_RESP_OK
+#define AT_DEF_RESP_OK    "OK"
+#endif
 /**
  *@brief Default error response identifier.
  */
+#ifndef AT_DEF_RESP_ERR
 #define AT_DEF_RESP_ERR   "ERROR"
+#endif
 
 /**
  *@brief Default command timeout (ms)
  */
-#define AT_DEF_TIMEOUT    500  
+#ifndef AT_DEF_TIMEOUT
+#define AT_DEF_TIMEOUT    500
+#endif
 
 /**
  *@brief Number of retries when a command timeout/error occurs.
  */
-#define AT_DEF_RETRY      2   
+#ifndef AT_DEF_RETRY
+#define AT_DEF_RETRY      2
+#endif
+
+/**
+ *@brief Default timeout of the result URC of a command (ms, see at_attr_t.urc).
+ */
+#ifndef AT_DEF_URC_TIMEOUT
+#define AT_DEF_URC_TIMEOUT 15000
+#endif
+
+/**
+ *@brief Payload prompt of prompt commands (see at_exec_payload), matched without a line end.
+ */
+#ifndef AT_DEF_PROMPT
+#define AT_DEF_PROMPT     ">"
+#endif
+
+/**
+ *@brief Default payload prompt timeout (ms).
+ */
+#ifndef AT_DEF_PROMPT_TIMEOUT
+#define AT_DEF_PROMPT_TIMEOUT 1000
+#endif
 
 /**
  *@brief Default URC frame receive timeout (ms).
  */
+#ifndef AT_URC_TIMEOUT
 #define AT_URC_TIMEOUT    500
+#endif
+
+/**
+ *@brief Polling interval (ms) reported by at_obj_process_timed for work that has no known 
+ *       deadline (custom work and transparent transmission).
+ */
+#ifndef AT_POLL_INTERVAL
+#define AT_POLL_INTERVAL  10
+#endif
+
+/**
+ *@brief Size of the receive buffer on the stack of at_obj_process, received data is read in
+ *       chunks of this size (a larger buffer can be provided with at_obj_set_rxbuf).
+ */
+#ifndef AT_RX_CHUNK_SIZE
+#define AT_RX_CHUNK_SIZE  128
+#endif
 
 /**
- *@brief Maximum AT command send data length (only for variable parameter commands).
+ *@brief Maximum number of bytes ingested by one at_obj_process call (0: no limit), the
+ *       driver is otherwise drained until it is empty.
  */
-#define AT_MAX_CMD_LEN    256     
+#ifndef AT_RX_BUDGET
+#define AT_RX_BUDGET      4096
+#endif
+
+/**
+ *@brief Data capacity of the large pool blocks, formatted commands longer than this are 
+ *       allocated from the heap (there is no hard limit on the command length).
+ */
+#ifndef AT_MAX_CMD_LEN
+#define AT_MAX_CMD_LEN    256
+#endif
 
 /**
  *@brief Maximum number of work in queue (limit memory usage).
  */
-#define AT_LIST_WORK_COUNT 32     
+#ifndef AT_LIST_WORK_COUNT
+#define AT_LIST_WORK_COUNT 32
+#endif
  
+/**
+ *@brief Number of work priority levels (at least 2), see at_cmd_priority.
+ */
+#ifndef AT_PRIORITY_LEVELS
+#define AT_PRIORITY_LEVELS  4
+#endif
+
+/**
+ *@brief Default priority aging interval (ms): a queued work is raised by one level for 
+ *       each interval it waits, so that low priority work cannot starve (0: no aging).
+ */
+#ifndef AT_PRIORITY_AGING
+#define AT_PRIORITY_AGING   1000
+#endif
+
 /**
  *@brief Enable URC watcher.
  */
+#ifndef AT_URC_WARCH_EN
 #define AT_URC_WARCH_EN     1
+#endif
 
 /**
  *@brief A list of specified URC end marks (fill in as needed, the fewer the better).
  */
+#ifndef AT_URC_END_MARKS
 #define AT_URC_END_MARKS  ":,\n"
+#endif
+
+/**
+ *@brief Enable the multi-pattern URC matcher (an Aho-Corasick automaton built by 
+ *       at_obj_set_urc, it replaces the linear prefix scan of the URC table).
+ */
+#ifndef AT_URC_MATCHER_EN
+#define AT_URC_MATCHER_EN   1u
+#endif
 /**
  *@brief Enable memory watcher.
  */
+#ifndef AT_MEM_WATCH_EN
 #define AT_MEM_WATCH_EN     1u
+#endif
   
 /**
  *@brief Maximum memory usage limit (Valid when AT_MEM_WATCH_EN is enabled)
  */
+#ifndef AT_MEM_LIMIT_SIZE
 #define AT_MEM_LIMIT_SIZE   (3 * 1024)
+#endif
+
+/**
+ *@brief Enable the fixed-block pool for work items and command buffers (O(1), no heap 
+ *       fragmentation, requests larger than the biggest block fall back to the heap).
+ *       The pools are static RAM, reserved even when no AT object exists and not counted
+ *       in AT_MEM_LIMIT_SIZE: AT_POOL_SMALL_COUNT x (work item + AT_POOL_SMALL_SIZE) +
+ *       AT_POOL_LARGE_COUNT x (work item + AT_MAX_CMD_LEN) bytes, under 2 KB with the
+ *       defaults on a 32-bit target. Requests beyond them are served by the heap, within 
+ *       AT_MEM_LIMIT_SIZE.
+ */
+#ifndef AT_POOL_EN
+#define AT_POOL_EN          1u
+#endif
+
+/**
+ *@brief Data capacity of the small pool blocks.
+ */
+#ifndef AT_POOL_SMALL_SIZE
+#define AT_POOL_SMALL_SIZE  32
+#endif
+
+/**
+ *@brief Number of small pool blocks (work items without data and short commands).
+ */
+#ifndef AT_POOL_SMALL_COUNT
+#define AT_POOL_SMALL_COUNT 8
+#endif
+
+/**
+ *@brief Number of large pool blocks (with a data capacity of AT_MAX_CMD_LEN).
+ */
+#ifndef AT_POOL_LARGE_COUNT
+#define AT_POOL_LARGE_COUNT 2
+#endif
+
+/**
+ *@brief Enable per-command latency statistics (queue wait, modem latency and total time
+ *       histograms of each command name, with error, timeout and retry counters). Off by
+ *       default: the table takes about 6.5 KB of heap per AT object (AT_STATS_CMD_COUNT x 3
+ *       histograms x AT_STATS_BUCKETS), see AT_STATS_BUCKETS to shrink it.
+ */
+#ifndef AT_STATS_EN
+#define AT_STATS_EN         0u
+#endif
+
+/**
+ *@brief Number of command names tracked by the statistics (the last entry collects the
+ *       commands that no longer fit).
+ */
+#ifndef AT_STATS_CMD_COUNT
+#define AT_STATS_CMD_COUNT  8
+#endif
+
+/**
+ *@brief Number of buckets of a latency histogram (log-linear, 4 buckets per power of two,
+ *       the last bucket collects everything above about 131 s). Can be lowered to save
+ *       memory, 48 buckets still resolve up to about 8 s.
+ */
+#ifndef AT_STATS_BUCKETS
+#define AT_STATS_BUCKETS    64
+#endif
+
+/**
+ *@brief Maximum length of a tracked command name (such as "AT+QMTOPEN"), including '\0', 
+ *       used by the statistics and the adaptive timeouts.
+ */
+#ifndef AT_STATS_NAME_LEN
+#define AT_STATS_NAME_LEN   16
+#endif
+
+/**
+ *@brief Enable adaptive response timeouts: the response time of each command name is 
+ *       estimated (smoothed mean and variation, as the TCP retransmission timeout) and the 
+ *       response timeout and retry delay of the command are derived from it.
+ */
+#ifndef AT_RTO_EN
+#define AT_RTO_EN           1u
+#endif
+
+/**
+ *@brief Number of command names tracked by the adaptive timeouts (the last entry collects 
+ *       the commands that no longer fit, they keep their static timeout).
+ */
+#ifndef AT_RTO_CMD_COUNT
+#define AT_RTO_CMD_COUNT    8
+#endif
+
+/**
+ *@brief Default bounds of an adaptive timeout (ms), see at_obj_set_rto. The lower bound 
+ *       absorbs the latency bursts of a shared link (CMUX channels, URC storms), commands 
+ *       with a static timeout above the upper bound (such as a network search) keep it.
+ */
+#ifndef AT_RTO_MIN
+#define AT_RTO_MIN          200
+#endif
+#ifndef AT_RTO_MAX
+#define AT_RTO_MAX          10000
+#endif
+
+/**
+ *@brief Enable the retry policies of at_attr_t (exponential backoff with jitter, maximum 
+ *       elapsed time and non-retryable +CME/+CMS ERROR codes).
+ */
+#ifndef AT_RETRY_POLICY_EN
+#define AT_RETRY_POLICY_EN  1u
+#endif
+
+/**
+ *@brief Enable the response cache of idempotent query commands (see at_obj_set_cache).
+ */
+#ifndef AT_CACHE_EN
+#define AT_CACHE_EN         1u
+#endif
+
+/**
+ *@brief Maximum length of a cached response, longer responses are not cached.
+ */
+#ifndef AT_CACHE_RESP_SIZE
+#define AT_CACHE_RESP_SIZE  96
+#endif
 
 /**
  *@brief Enable AT work context interfaces.
  */
+#ifndef AT_WORK_CONTEXT_EN
 #define AT_WORK_CONTEXT_EN  1u
+#endif
+
+/**
+ *@brief Enable the blocking command interfaces (at_exec_cmd_sync...), the calling task 
+ *       sleeps until the AT task signals the result (it needs the at_sync_* functions).
+ */
+#ifndef AT_SYNC_EN
+#define AT_SYNC_EN          1u
+#endif
+
+/**
+ *@brief Task notification index the blocking interfaces wait on, no other code of the calling
+ *       tasks may use it (CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES must be greater).
+ */
+#ifndef AT_SYNC_NOTIFY_INDEX
+#define AT_SYNC_NOTIFY_INDEX 1
+#endif
+
+/**
+ *@brief Enable the coroutine work (at_do_coroutine, AT_CO_XXX macros): a multi-step flow 
+ *       runs as one work item that awaits commands, URCs and delays.
+ */
+#ifndef AT_COROUTINE_EN
+#define AT_COROUTINE_EN     1u
+#endif
+
+/**
+ *@brief Enable the result URC of commands (at_attr_t.urc): the work stays current after
+ *       the response until the URC is received, such as "+QMTOPEN: 0,0" after AT+QMTOPEN.
+ */
+#ifndef AT_RESULT_URC_EN
+#define AT_RESULT_URC_EN    1u
+#endif
+
+/**
+ *@brief Enable the prompt commands (at_exec_payload): the payload is written after the '>'
+ *       prompt, such as AT+QMTPUBEX, AT+CMGS, AT+QISEND or AT+QFUPL.
+ */
+#ifndef AT_PAYLOAD_EN
+#define AT_PAYLOAD_EN       1u
+#endif
 
 /**
  * @brief Supports raw data transparent transmission
  */
+#ifndef AT_RAW_TRANSPARENT_EN
 #define AT_RAW_TRANSPARENT_EN  1u
+#endif
+
+/**
+ * @brief Default transparent transmission buffer size (allocated when entering the mode, 
+ *        one half per direction), see at_raw_trans_conf_t.bufsize.
+ */
+#ifndef AT_RAW_BUF_SIZE
+#define AT_RAW_BUF_SIZE        1024
+#endif
+
+/**
+ * @brief Enable the 3GPP 27.010 multiplexer (CMUX), see at_cmux.h. Off by default: the
+ *        channels take AT_CMUX_CHANNELS x AT_CMUX_RX_SIZE of static RAM, and each of them
+ *        runs its own AT object, so AT_MEM_LIMIT_SIZE must be raised to hold one more 
+ *        object (at_info_t, receive and URC buffers) per channel.
+ */
+#ifndef AT_CMUX_EN
+#define AT_CMUX_EN             0u
+#endif
+
+/**
+ * @brief Number of CMUX virtual channels (DLCI 1 ~ AT_CMUX_CHANNELS, at most 4).
+ */
+#ifndef AT_CMUX_CHANNELS
+#define AT_CMUX_CHANNELS       3
+#endif
+
+/**
+ * @brief Maximum CMUX frame information length (N1, must match the AT+CMUX setting, 
+ *        the module default is 127).
+ */
+#ifndef AT_CMUX_FRAME_SIZE
+#define AT_CMUX_FRAME_SIZE     127
+#endif
+
+/**
+ * @brief Receive buffer size of each CMUX channel (at least AT_CMUX_FRAME_SIZE).
+ */
+#ifndef AT_CMUX_RX_SIZE
+#define AT_CMUX_RX_SIZE        1024
+#endif
 
 void *at_malloc(unsigned int nbytes);
 
@@ -77,4 +375,12 @@ void  at_free(void *ptr);
 
 unsigned int at_get_ms(void);
 
+#if AT_SYNC_EN
+void *at_sync_waiter(void);
+
+void  at_sync_signal(void *waiter);
+
+int   at_sync_wait(unsigned int ms);
+#endif
+
 #endif
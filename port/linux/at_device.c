@@ -0,0 +1,256 @@
+/******************************************************************************
+ * @brief        AT device interface for Linux (termios serial port)
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "at_device_linux.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <unistd.h>
+
+// Maximum number of segments passed to a single writev call.
+#define AT_LINUX_IOV_MAX 8
+
+/**
+ * @brief AT device (only one serial port, the adapter interfaces have no context).
+ */
+static struct
+{
+    int fd;
+    int wake[2]; /* Wakeup pipe, written by at_linux_notify*/
+    pthread_mutex_t mutex;
+} at_dev = {-1, {-1, -1}, PTHREAD_MUTEX_INITIALIZER};
+
+static speed_t baud_to_speed(unsigned int baudrate)
+{
+    switch (baudrate)
+    {
+    case 9600:
+        return B9600;
+    case 19200:
+        return B19200;
+    case 38400:
+        return B38400;
+    case 57600:
+        return B57600;
+    case 230400:
+        return B230400;
+    case 460800:
+        return B460800;
+    case 921600:
+        return B921600;
+    default:
+        return B115200;
+    }
+}
+
+/**
+ * @brief  Open the serial port (raw mode, 8N1, no flow control, non-blocking).
+ * @param  path     Serial device path (such as /dev/ttyUSB2, or a pseudo-terminal)
+ * @param  baudrate Baud rate
+ * @return 0 - success, -1 - failure (errno is set).
+ */
+int at_linux_open(const char *path, unsigned int baudrate)
+{
+    struct termios tio;
+    int fd, i;
+    fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cflag &= ~CRTSCTS;
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        cfsetispeed(&tio, baud_to_speed(baudrate));
+        cfsetospeed(&tio, baud_to_speed(baudrate));
+        tcsetattr(fd, TCSANOW, &tio);
+        tcflush(fd, TCIOFLUSH);
+    }
+    if (pipe(at_dev.wake) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    for (i = 0; i < 2; i++)
+        fcntl(at_dev.wake[i], F_SETFL, fcntl(at_dev.wake[i], F_GETFL) | O_NONBLOCK);
+    at_dev.fd = fd;
+    return 0;
+}
+
+/**
+ * @brief  Close the serial port.
+ */
+void at_linux_close(void)
+{
+    int i;
+    if (at_dev.fd >= 0)
+        close(at_dev.fd);
+    for (i = 0; i < 2; i++)
+    {
+        if (at_dev.wake[i] >= 0)
+            close(at_dev.wake[i]);
+        at_dev.wake[i] = -1;
+    }
+    at_dev.fd = -1;
+}
+
+/**
+ * @brief  Get the serial port file descriptor (for use with an external event loop).
+ */
+int at_linux_fd(void)
+{
+    return at_dev.fd;
+}
+
+void at_linux_lock(void)
+{
+    pthread_mutex_lock(&at_dev.mutex);
+}
+
+void at_linux_unlock(void)
+{
+    pthread_mutex_unlock(&at_dev.mutex);
+}
+
+/**
+ * @brief  Wait until the serial port can be written again.
+ */
+static bool wait_writable(void)
+{
+    struct pollfd pfd = {at_dev.fd, POLLOUT, 0};
+    return poll(&pfd, 1, -1) > 0 || errno == EINTR;
+}
+
+/**
+ * @brief  Write data (waits for the driver to accept the data).
+ * @return Indicates the length of the written data
+ */
+unsigned int at_linux_write(const void *buf, unsigned int len)
+{
+    const unsigned char *p = buf;
+    unsigned int total = 0;
+    ssize_t ret;
+    while (total < len)
+    {
+        ret = write(at_dev.fd, p + total, len - total);
+        if (ret > 0)
+            total += ret;
+        else if (ret < 0 && (errno == EAGAIN || errno == EINTR))
+        {
+            if (!wait_writable())
+                break;
+        }
+        else
+            break;
+    }
+    return total;
+}
+
+/**
+ * @brief  Write all segments of a frame with writev(2).
+ * @return Indicates the total length of the written data
+ */
+unsigned int at_linux_writev(const at_iovec_t *iov, int iovcnt)
+{
+    struct iovec vec[AT_LINUX_IOV_MAX];
+    unsigned int total = 0, skip;
+    ssize_t ret;
+    int i, n, cnt;
+    for (i = 0; i < iovcnt; i += cnt)
+    {
+        cnt = iovcnt - i < AT_LINUX_IOV_MAX ? iovcnt - i : AT_LINUX_IOV_MAX;
+        for (n = 0; n < cnt; n++)
+        {
+            vec[n].iov_base = (void *)iov[i + n].base;
+            vec[n].iov_len = iov[i + n].len;
+        }
+        do
+            ret = writev(at_dev.fd, vec, cnt);
+        while (ret < 0 && (errno == EINTR || (errno == EAGAIN && wait_writable())));
+        if (ret < 0)
+            return total;
+        total += ret;
+        // Partial write, the rest is written segment by segment.
+        for (n = 0, skip = ret; n < cnt; n++)
+        {
+            if (skip >= vec[n].iov_len)
+            {
+                skip -= vec[n].iov_len;
+                continue;
+            }
+            total += at_linux_write((unsigned char *)vec[n].iov_base + skip, vec[n].iov_len - skip);
+            skip = 0;
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief  Read data (non-blocking).
+ * @return The length of the data actually read
+ */
+unsigned int at_linux_read(void *buf, unsigned int len)
+{
+    ssize_t ret;
+    do
+        ret = read(at_dev.fd, buf, len);
+    while (ret < 0 && errno == EINTR);
+    return ret > 0 ? (unsigned int)ret : 0;
+}
+
+/**
+ * @brief  Debug output.
+ */
+void at_linux_debug(const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+}
+
+/**
+ * @brief  Wake up the task waiting in at_linux_wait (called by the AT component when work
+ *         is submitted).
+ */
+void at_linux_notify(void)
+{
+    char ch = 0;
+    if (write(at_dev.wake[1], &ch, 1) < 0)
+    {
+        // The pipe is full, the waiting task will be woken up anyway.
+    }
+}
+
+/**
+ * @brief  Wait for received data, a submission wakeup or the timeout.
+ * @param  ms Maximum waiting time (ms), AT_WAIT_FOREVER means waiting until an event occurs.
+ */
+void at_linux_wait(unsigned int ms)
+{
+    struct pollfd pfd[2] = {{at_dev.fd, POLLIN, 0}, {at_dev.wake[0], POLLIN, 0}};
+    char buf[32];
+    int timeout = ms == AT_WAIT_FOREVER ? -1 : (ms > INT_MAX ? INT_MAX : (int)ms);
+    if (poll(pfd, 2, timeout) <= 0)
+        return;
+    if (pfd[1].revents & POLLIN)
+    {
+        while (read(at_dev.wake[0], buf, sizeof(buf)) > 0)
+            ;
+    }
+}
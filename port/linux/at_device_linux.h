@@ -0,0 +1,46 @@
+/******************************************************************************
+ * @brief        AT device interface for Linux (termios serial port)
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#ifndef __AT_DEVICE_LINUX_H__
+#define __AT_DEVICE_LINUX_H__
+
+#include "at_chat.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+int at_linux_open(const char *path, unsigned int baudrate);
+
+void at_linux_close(void);
+
+int at_linux_fd(void);
+
+void at_linux_lock(void);
+
+void at_linux_unlock(void);
+
+unsigned int at_linux_write(const void *buf, unsigned int len);
+
+unsigned int at_linux_writev(const at_iovec_t *iov, int iovcnt);
+
+unsigned int at_linux_read(void *buf, unsigned int len);
+
+void at_linux_debug(const char *fmt, ...);
+
+void at_linux_notify(void);
+
+void at_linux_wait(unsigned int ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,135 @@
+/**
+ * @Brief: The AT component drives the interface implementation (Linux)
+ * @Author: missing-shell
+ * @Date: 2026-10-16
+ */
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include "at_chat.h"
+
+/**
+ * @brief Custom malloc for AT component.
+ */
+void *at_malloc(unsigned int nbytes)
+{
+    return malloc(nbytes);
+}
+
+/**
+ * @brief Custom free for AT component.
+ */
+void at_free(void *ptr)
+{
+    free(ptr);
+}
+
+/**
+ * @brief Gets the total number of milliseconds in the system.
+ */
+unsigned int at_get_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned int)(ts.tv_sec * 1000u + ts.tv_nsec / 1000000);
+}
+
+#if AT_SYNC_EN
+/**
+ * @brief Wakeup counter of a thread calling the blocking interfaces (the equivalent of a
+ *        FreeRTOS task notification), allocated on the first call of the thread and released
+ *        when the thread exits.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    unsigned int    count;
+} sync_waiter_t;
+
+static pthread_key_t  sync_key;
+static pthread_once_t sync_once = PTHREAD_ONCE_INIT;
+
+static void sync_waiter_destroy(void *arg)
+{
+    sync_waiter_t *w = arg;
+    pthread_cond_destroy(&w->cond);
+    pthread_mutex_destroy(&w->lock);
+    free(w);
+}
+
+static void sync_key_create(void)
+{
+    pthread_key_create(&sync_key, sync_waiter_destroy);
+}
+
+/**
+ * @brief Gets the waiter of the calling thread, NULL if it could not be allocated (the
+ *        blocking calls then time out at once).
+ */
+void *at_sync_waiter(void)
+{
+    pthread_condattr_t attr;
+    sync_waiter_t *w;
+    pthread_once(&sync_once, sync_key_create);
+    w = pthread_getspecific(sync_key);
+    if (w != NULL)
+        return w;
+    w = malloc(sizeof(sync_waiter_t));
+    if (w == NULL)
+        return NULL;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&w->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&w->lock, NULL);
+    w->count = 0;
+    if (pthread_setspecific(sync_key, w) != 0)
+    {
+        sync_waiter_destroy(w);
+        return NULL;
+    }
+    return w;
+}
+
+/**
+ * @brief Wakes up a thread waiting in at_sync_wait (called by the AT thread).
+ */
+void at_sync_signal(void *waiter)
+{
+    sync_waiter_t *w = waiter;
+    if (w == NULL)
+        return;
+    pthread_mutex_lock(&w->lock);
+    w->count++;
+    pthread_cond_signal(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+}
+
+/**
+ * @brief Waits for at_sync_signal, returns 0 on timeout.
+ */
+int at_sync_wait(unsigned int ms)
+{
+    sync_waiter_t *w = at_sync_waiter();
+    struct timespec ts;
+    int ret = 0;
+    if (w == NULL)
+        return 0;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_mutex_lock(&w->lock);
+    while (w->count == 0 && ret == 0)
+        ret = ms == AT_WAIT_FOREVER ? pthread_cond_wait(&w->cond, &w->lock)
+                                    : pthread_cond_timedwait(&w->cond, &w->lock, &ts);
+    ret = w->count != 0;
+    w->count = 0;
+    pthread_mutex_unlock(&w->lock);
+    return ret;
+}
+#endif
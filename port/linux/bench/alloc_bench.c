@@ -0,0 +1,195 @@
+/******************************************************************************
+ * @brief        Command submission allocation benchmark against the simulated EC800M
+ *
+ * Commands of three lengths are submitted one after the other:
+ *   short  - AT+CSQ                                    (small pool block)
+ *   topic  - AT+QMTSUB with a 160-byte MQTT topic       (large pool block)
+ *   auth   - AT+QMTCFG="aliauth" with 400 bytes of keys (longer than AT_MAX_CMD_LEN)
+ * with two submission methods:
+ *   direct  - at_exec_cmd formats the command into the work item
+ *   scratch - the command is first formatted into an AT_MAX_CMD_LEN heap buffer and
+ *             copied by at_exec_cmd (the former submission path, it truncates the
+ *             commands longer than the buffer)
+ * The heap allocations of the submitting thread (malloc is wrapped), the pool requests
+ * served by the heap because the pool was exhausted (at_pool_get_stat) and the time
+ * spent per submission (p50) are reported. The benchmark fails if a command fails, if a direct
+ * submission that fits a pool block allocates from the heap or if a longer one allocates
+ * more than once.
+ *
+ * Usage: alloc_bench [-n commands]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Command of a given length.
+ */
+typedef struct
+{
+    const char *name;
+    const char *fmt;
+    const char *arg;
+    bool pooled; /* Fits a pool block*/
+} cmd_kind_t;
+
+static char topic[161], secret[401];
+
+static const cmd_kind_t kinds[] = {
+    {"short", "AT+CSQ", "", true},
+    {"topic", "AT+QMTSUB=0,1,\"%s\",1", topic, true},
+    {"auth", "AT+QMTCFG=\"aliauth\",0,\"a1b2c3d4e5f\",\"gw-ec800m-0001\",\"%s\"", secret, false},
+};
+
+#define KIND_COUNT (int)(sizeof(kinds) / sizeof(kinds[0]))
+
+static at_obj_t *at_obj;
+static unsigned int done_count, fail_count;
+static __thread unsigned int heap_allocs;
+static unsigned long long *submit_ns;
+
+void *__real_malloc(size_t size);
+
+/**
+ * @brief  Count the heap allocations of the calling thread (linked with --wrap=malloc).
+ */
+void *__wrap_malloc(size_t size)
+{
+    heap_allocs++;
+    return __real_malloc(size);
+}
+
+static void on_response(at_response_t *r)
+{
+    if (r->code != AT_RESP_OK)
+        fail_count++;
+    bench_count(&done_count);
+}
+
+/**
+ * @brief  Former submission path: format into a scratch buffer, then copy it.
+ */
+static bool submit_scratch(const at_attr_t *attr, const char *fmt, ...)
+{
+    char *buf = malloc(AT_MAX_CMD_LEN);
+    va_list args;
+    bool ret;
+    if (buf == NULL)
+        return false;
+    va_start(args, fmt);
+    vsnprintf(buf, AT_MAX_CMD_LEN, fmt, args);
+    va_end(args);
+    ret = at_exec_cmd(at_obj, attr, "%s", buf);
+    free(buf);
+    return ret;
+}
+
+static int cmp_ull(const void *a, const void *b)
+{
+    unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+    return x < y ? -1 : x > y;
+}
+
+static unsigned int pool_fallbacks(void)
+{
+    unsigned int n = 0;
+    at_pool_stat_t pst;
+    int i;
+    for (i = 0; at_pool_get_stat(i, &pst); i++)
+        n += pst.fallback;
+    return n;
+}
+
+/**
+ * @brief  Submit the commands of one kind with one method and print the allocations.
+ * @return 1 if a command failed or a direct submission used the heap more than expected.
+ */
+static int run(const cmd_kind_t *k, bool scratch, unsigned int count)
+{
+    unsigned long long t0;
+    unsigned int i, allocs = 0, fb0 = pool_fallbacks();
+    at_attr_t attr;
+    int len = snprintf(NULL, 0, k->fmt, k->arg);
+    bool ok;
+    at_attr_deinit(&attr);
+    attr.cb = on_response;
+    attr.retry = 0;
+    done_count = fail_count = 0;
+    for (i = 0; i < count; i++)
+    {
+        heap_allocs = 0;
+        t0 = bench_now_ns();
+        ok = scratch ? submit_scratch(&attr, k->fmt, k->arg) : at_exec_cmd(at_obj, &attr, k->fmt, k->arg);
+        submit_ns[i] = bench_now_ns() - t0;
+        allocs += heap_allocs;
+        if (ok)
+            bench_wait_count(&done_count, done_count + 1, 2000);
+    }
+    qsort(submit_ns, count, sizeof(*submit_ns), cmp_ull);
+    printf("  %-6s %-8s %6d %8.2f %12.2f %10.2f %8u\n", k->name, scratch ? "scratch" : "direct", len,
+           (double)allocs / count,
+           (double)(pool_fallbacks() - fb0) / count, submit_ns[count / 2] / 1e3, fail_count);
+    return fail_count != 0 || (!scratch && allocs > (k->pooled ? 0 : count));
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {0, 0, 0, 10, 0, 0};
+    unsigned int count = 200;
+    int opt, i, errors = 0;
+    at_sim_t *sim;
+    while ((opt = getopt(argc, argv, "n:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            count = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n commands]\n  -n  Commands of each kind and method (default 200)\n",
+                    argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (count == 0)
+        count = 1;
+    submit_ns = calloc(count, sizeof(*submit_ns));
+    if (submit_ns == NULL)
+        return 1;
+    memset(topic, 't', sizeof(topic) - 1);
+    memset(secret, 's', sizeof(secret) - 1);
+    sim = bench_sim_open("alloc_bench", &conf);
+    if (sim == NULL)
+        return 1;
+    // The modem accepts any command line (the truncated ones of the scratch method too).
+    at_sim_add_rule(sim, "AT+QMTCFG=", "\r\nOK\r\n");
+    at_obj = bench_obj_create(NULL);
+    if (at_obj == NULL)
+        return 1;
+    bench_start();
+
+    printf("%u commands of each kind, command buffer %d bytes\n", count, AT_MAX_CMD_LEN);
+    printf("  %-6s %-8s %6s %8s %12s %10s %8s\n", "kind", "method", "length", "heap/cmd", "fallback/cmd",
+           "submit us", "failures");
+    for (i = 0; i < KIND_COUNT; i++)
+    {
+        errors += run(&kinds[i], true, count);
+        errors += run(&kinds[i], false, count);
+    }
+    errors += bench_check_pools();
+    printf("%s\n", errors != 0 ? "FAILED" : "ok");
+
+    bench_stop();
+    bench_close(sim);
+    free(submit_ns);
+    return errors != 0;
+}
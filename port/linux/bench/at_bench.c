@@ -0,0 +1,264 @@
+/******************************************************************************
+ * @brief        AT engine benchmark against the simulated EC800M
+ *
+ * Reports the sequential round-trip latency (p50/p99), pipelined commands per second,
+ * URC throughput, the CPU time of the AT thread per received byte and the delivery of a large
+ * streamed URC payload.
+ *
+ * Usage: at_bench [-b baudrate] [-n commands] [-u urcs] [-d delay_us] [-m event|poll] [-r rxbuf]
+ *                 [-p payload]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BENCH_URC "\r\n+QMTRECV: 0,1,\"topic/bench\",16,\"0123456789abcdef\"\r\n"
+
+static at_obj_t *at_obj;
+static int event_mode = 1;
+static unsigned int done_count, fail_count, urc_count;
+static unsigned int stream_bytes, stream_errors;
+static bool stream_verify;
+
+static const at_adapter_t adapter = {
+    .lock = at_linux_lock,
+    .unlock = at_linux_unlock,
+    .write = at_linux_write,
+    .writev = at_linux_writev,
+    .read = at_linux_read,
+    .notify = at_linux_notify,
+    .urc_bufsize = 256,
+    .recv_bufsize = 256,
+};
+
+static void on_response(at_response_t *r)
+{
+    if (r->code != AT_RESP_OK)
+        fail_count++;
+    bench_count(&done_count);
+}
+
+/**
+ * @brief  +QMTRECV: <client>,<msgid>,"<topic>",<length>,"<payload>" header, the payload is
+ *         streamed to on_qmtrecv_data.
+ */
+static int on_qmtrecv(at_urc_info_t *info)
+{
+    int len;
+    if (info->status != URC_RECV_OK)
+        return 0;
+    if (sscanf(info->urcbuf, "+QMTRECV: %*d,%*d,\"%*[^\"]\",%d,", &len) != 1)
+        return URC_STREAM_MORE;
+    stream_bytes = 0;
+    info->skip = 1; // Opening quote
+    return len;
+}
+
+static void on_qmtrecv_data(const char *buf, unsigned int len)
+{
+    unsigned int i;
+    // The payload of the stream test is a repeating "a..z" pattern.
+    for (i = 0; i < len && stream_verify; i++)
+    {
+        if (buf[i] != (char)('a' + (stream_bytes + i) % 26))
+            stream_errors++;
+    }
+    stream_bytes += len;
+}
+
+static void on_qmtrecv_end(urc_recv_status status)
+{
+    if (status != URC_RECV_OK)
+        stream_errors++;
+    bench_count(&urc_count);
+}
+
+static const urc_item_t urc_table[] = {
+    {"+QMTRECV:", ',', on_qmtrecv, on_qmtrecv_data, on_qmtrecv_end},
+};
+
+static bool submit(const at_attr_t *attr)
+{
+    // The work list is limited to AT_LIST_WORK_COUNT items, wait for room when it is full.
+    while (!at_exec_cmd(at_obj, attr, "AT+CSQ"))
+        usleep(100);
+    return true;
+}
+
+static int cmp_ull(const void *a, const void *b)
+{
+    unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-b baudrate] [-n commands] [-u urcs] [-d delay_us] [-m event|poll] [-r rxbuf]\n"
+            "          [-p payload]\n"
+            "  -b  Simulated serial rate (default 115200, 0: no pacing)\n"
+            "  -n  Number of commands of each command test (default 1000)\n"
+            "  -u  Number of URCs of the URC storm test (default 10000)\n"
+            "  -d  Simulated response latency of every command (default 0)\n"
+            "  -m  AT thread mode: event (at_obj_process_timed + wait) or poll (10ms)\n"
+            "  -r  Size of the ingest buffer given to at_obj_set_rxbuf (default AT_RX_CHUNK_SIZE)\n"
+            "  -p  Payload size of the streamed +QMTRECV test (default 65536, 0: skip)\n",
+            name);
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {115200, 0, 0, 10, 0, 0};
+    unsigned int cmds = 1000, urcs = 10000, rxbuf_size = 0, payload = 65536, i;
+    void *rxbuf = NULL;
+    char *frame;
+    int hlen;
+    unsigned long long *rtt, t0, t1, cpu0, cpu1;
+    at_sim_stat_t st0, st1;
+    at_sim_t *sim;
+    at_attr_t attr;
+    int opt, errors;
+    while ((opt = getopt(argc, argv, "b:n:u:d:m:r:p:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            conf.baudrate = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            cmds = strtoul(optarg, NULL, 0);
+            break;
+        case 'u':
+            urcs = strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            conf.resp_delay_us = strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            event_mode = strcmp(optarg, "poll") != 0;
+            break;
+        case 'r':
+            rxbuf_size = strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            payload = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (cmds == 0)
+        cmds = 1;
+    rtt = calloc(cmds, sizeof(*rtt));
+    sim = bench_sim_open("at_bench", &conf);
+    if (rtt == NULL || sim == NULL)
+        return 1;
+    at_obj = bench_obj_create(&adapter);
+    if (at_obj == NULL)
+        return 1;
+    at_obj_set_urc(at_obj, urc_table, sizeof(urc_table) / sizeof(urc_table[0]));
+    if (rxbuf_size != 0 && (rxbuf = malloc(rxbuf_size)) != NULL)
+        at_obj_set_rxbuf(at_obj, rxbuf, rxbuf_size);
+    bench_set_poll(!event_mode);
+    bench_start();
+
+    printf("mode %s, %u baud, response delay %u us\n", event_mode ? "event" : "poll",
+           conf.baudrate, conf.resp_delay_us);
+    at_attr_deinit(&attr);
+    attr.cb = on_response;
+    attr.prefix = "+CSQ:";
+    attr.timeout = 1000;
+    attr.retry = 0;
+
+    // Sequential round trip: one command in flight at a time.
+    for (i = 0; i < cmds; i++)
+    {
+        t0 = bench_now_ns();
+        submit(&attr);
+        bench_wait_count(&done_count, i + 1, 5000);
+        rtt[i] = bench_now_ns() - t0;
+    }
+    qsort(rtt, cmds, sizeof(*rtt), cmp_ull);
+    printf("sequential : %u cmds, rtt p50 %.1f us, p99 %.1f us, max %.1f us\n", cmds,
+           rtt[cmds / 2] / 1e3, rtt[cmds * 99 / 100] / 1e3, rtt[cmds - 1] / 1e3);
+
+    // Pipelined: the work list is kept full.
+    done_count = 0;
+    at_sim_get_stat(sim, &st0);
+    cpu0 = bench_thread_cpu_ns();
+    t0 = bench_now_ns();
+    for (i = 0; i < cmds; i++)
+        submit(&attr);
+    bench_wait_count(&done_count, cmds, 10000 + cmds * 10);
+    t1 = bench_now_ns();
+    cpu1 = bench_thread_cpu_ns();
+    at_sim_get_stat(sim, &st1);
+    printf("pipelined  : %u cmds, %.0f cmds/s, AT thread cpu %.1f ns/byte\n", done_count,
+           done_count * 1e9 / (t1 - t0),
+           (double)(cpu1 - cpu0) / (st1.tx_bytes - st0.tx_bytes + st1.rx_bytes - st0.rx_bytes));
+
+    // URC storm: back to back URCs, limited only by the serial rate.
+    at_sim_get_stat(sim, &st0);
+    cpu0 = bench_thread_cpu_ns();
+    t0 = bench_now_ns();
+    at_sim_urc_storm(sim, BENCH_URC, urcs, 0);
+    bench_wait_count(&urc_count, urcs, 5000);
+    t1 = bench_now_ns();
+    cpu1 = bench_thread_cpu_ns();
+    at_sim_get_stat(sim, &st1);
+    printf("urc storm  : %u/%u urcs, %.0f urcs/s, AT thread cpu %.1f ns/byte\n", urc_count, urcs,
+           urc_count * 1e9 / (t1 - t0), (double)(cpu1 - cpu0) / (st1.tx_bytes - st0.tx_bytes));
+    errors = urcs - urc_count;
+    printf("ingest     : %.0f bytes/s", (st1.tx_bytes - st0.tx_bytes) * 1e9 / (t1 - t0));
+    if (conf.baudrate != 0)
+        printf(" (%.0f%% of the line rate)", (st1.tx_bytes - st0.tx_bytes) * 1e9 / (t1 - t0) / (conf.baudrate / 10.0) * 100);
+    printf("\n");
+
+    // Streamed URC: a payload far larger than the 256-byte URC buffer.
+    if (payload != 0 && (frame = malloc(payload + 64)) != NULL)
+    {
+        hlen = sprintf(frame, "\r\n+QMTRECV: 0,2,\"topic/bench\",%u,\"", payload);
+        for (i = 0; i < payload; i++)
+            frame[hlen + i] = 'a' + i % 26;
+        memcpy(frame + hlen + payload, "\"\r\n", 3);
+        urc_count = 0;
+        stream_verify = true;
+        t0 = bench_now_ns();
+        at_sim_inject(sim, frame, hlen + payload + 3);
+        bench_wait_count(&urc_count, 1, 5000 + payload / 8);
+        t1 = bench_now_ns();
+        printf("urc stream : %u/%u bytes, %u errors, %.0f bytes/s\n", stream_bytes, payload,
+               stream_errors, stream_bytes * 1e9 / (t1 - t0));
+        stream_errors += stream_bytes != payload;
+        free(frame);
+    }
+    if (fail_count)
+        printf("failed     : %u cmds\n", fail_count);
+    errors += fail_count + stream_errors;
+#if AT_STATS_EN
+    at_cmd_stats_t st;
+    for (i = 0; at_obj_get_stats(at_obj, i, &st); i++)
+        printf("%-16s count %u, queue p99 %u ms, modem p50 %u ms p99 %u ms, total p99 %u ms\n",
+               st.name, st.count, at_obj_stats_percentile(at_obj, i, AT_STATS_QUEUE, 99),
+               at_obj_stats_percentile(at_obj, i, AT_STATS_MODEM, 50),
+               at_obj_stats_percentile(at_obj, i, AT_STATS_MODEM, 99),
+               at_obj_stats_percentile(at_obj, i, AT_STATS_TOTAL, 99));
+#endif
+    errors += bench_check_pools();
+    printf("%s\n", errors != 0 ? "FAILED" : "ok");
+
+    bench_stop();
+    bench_close(sim);
+    free(rtt);
+    free(rxbuf);
+    return errors != 0;
+}
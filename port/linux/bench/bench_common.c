@@ -0,0 +1,242 @@
+/******************************************************************************
+ * @brief        Common parts of the benchmarks
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+const at_adapter_t bench_adapter = {
+    .lock = at_linux_lock,
+    .unlock = at_linux_unlock,
+    .write = at_linux_write,
+    .read = at_linux_read,
+    .notify = at_linux_notify,
+    .recv_bufsize = 256,
+};
+
+static at_obj_t *objs[BENCH_OBJ_MAX];
+static int obj_count;
+static pthread_t at_thread;
+static volatile int running;
+static volatile bool poll_mode;
+static volatile unsigned long wakeups;
+
+static pthread_mutex_t count_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t count_cond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief  Run the AT objects: wait until the serial port receives data, work is submitted
+ *         or the next deadline expires (or every AT_POLL_INTERVAL in poll mode).
+ */
+static void *at_thread_entry(void *arg)
+{
+    unsigned int wait, ms;
+    int i;
+    while (running)
+    {
+        wait = AT_WAIT_FOREVER;
+        for (i = 0; i < obj_count; i++)
+        {
+            ms = at_obj_process_timed(objs[i]);
+            if (ms < wait)
+                wait = ms;
+        }
+        if (poll_mode)
+            usleep(AT_POLL_INTERVAL * 1000);
+        else
+            at_linux_wait(wait);
+        wakeups++;
+    }
+    return NULL;
+}
+
+/**
+ * @brief  Create the simulated modem and open its serial port.
+ * @param  name Name of the benchmark (error messages).
+ * @return NULL on failure (the error is printed).
+ */
+at_sim_t *bench_sim_open(const char *name, const at_sim_conf_t *conf)
+{
+    at_sim_t *sim = at_sim_create(conf);
+    if (sim == NULL || at_linux_open(at_sim_path(sim), conf->baudrate) != 0)
+    {
+        perror(name);
+        if (sim != NULL)
+            at_sim_destroy(sim);
+        return NULL;
+    }
+    return sim;
+}
+
+/**
+ * @brief  Close the serial port and destroy the simulated modem (NULL: none).
+ */
+void bench_close(at_sim_t *sim)
+{
+    at_linux_close();
+    if (sim != NULL)
+        at_sim_destroy(sim);
+}
+
+/**
+ * @brief  Create an AT object run by the AT thread.
+ * @param  adapter Adapter, NULL for bench_adapter.
+ * @return NULL on failure (the error is printed).
+ */
+at_obj_t *bench_obj_create(const at_adapter_t *adapter)
+{
+    at_obj_t *obj;
+    if (obj_count >= BENCH_OBJ_MAX)
+        return NULL;
+    obj = at_obj_create(adapter != NULL ? adapter : &bench_adapter);
+    if (obj == NULL)
+    {
+        fprintf(stderr, "at_obj_create failed\n");
+        return NULL;
+    }
+    objs[obj_count++] = obj;
+    return obj;
+}
+
+/**
+ * @brief  Select the mode of the AT thread (also while it runs, from its next cycle):
+ *         process every AT_POLL_INTERVAL instead of sleeping until the next event.
+ */
+void bench_set_poll(bool poll)
+{
+    poll_mode = poll;
+}
+
+/**
+ * @brief  Start the AT thread.
+ */
+void bench_start(void)
+{
+    running = 1;
+    pthread_create(&at_thread, NULL, at_thread_entry, NULL);
+}
+
+/**
+ * @brief  Stop the AT thread and destroy the AT objects.
+ */
+void bench_stop(void)
+{
+    if (running)
+    {
+        running = 0;
+        at_linux_notify();
+        pthread_join(at_thread, NULL);
+    }
+    while (obj_count > 0)
+        at_obj_destroy(objs[--obj_count]);
+}
+
+/**
+ * @brief  Wait until the AT objects have no work left (the result of a work is delivered
+ *         before the work is recycled).
+ */
+void bench_wait_idle(void)
+{
+    int i;
+    for (i = 0; i < obj_count; i++)
+    {
+        while (at_obj_busy(objs[i]))
+            usleep(1000);
+    }
+}
+
+/**
+ * @brief  Wait until the AT objects are idle and print the memory pools.
+ * @return Number of pools with blocks still in use (leaked work).
+ */
+unsigned int bench_check_pools(void)
+{
+    at_pool_stat_t pst;
+    unsigned int errors = 0;
+    int i;
+    bench_wait_idle();
+    for (i = 0; at_pool_get_stat(i, &pst); i++)
+    {
+        printf("  pool %-10u : %u blocks in use (peak %u of %u), %u heap fallbacks\n", pst.blksize, pst.used,
+               pst.max_used, pst.count, pst.fallback);
+        errors += pst.used != 0;
+    }
+    return errors;
+}
+
+unsigned long long bench_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+
+unsigned long long bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief  CPU time consumed by the AT thread (ns).
+ */
+unsigned long long bench_thread_cpu_ns(void)
+{
+    struct timespec ts;
+    clockid_t cid;
+    if (!running || pthread_getcpuclockid(at_thread, &cid) != 0 || clock_gettime(cid, &ts) != 0)
+        return 0;
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief  Number of times the AT thread has woken up.
+ */
+unsigned long bench_wakeups(void)
+{
+    return wakeups;
+}
+
+/**
+ * @brief  Increment a completion counter (from a callback of the AT thread).
+ */
+void bench_count(unsigned int *counter)
+{
+    pthread_mutex_lock(&count_lock);
+    (*counter)++;
+    pthread_cond_broadcast(&count_cond);
+    pthread_mutex_unlock(&count_lock);
+}
+
+/**
+ * @brief  Wait until a completion counter reaches the target value.
+ * @return false on timeout.
+ */
+bool bench_wait_count(unsigned int *counter, unsigned int target, unsigned int timeout_ms)
+{
+    struct timespec ts;
+    bool ok = true;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (timeout_ms % 1000) * 1000000l;
+    if (ts.tv_nsec >= 1000000000l)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000l;
+    }
+    pthread_mutex_lock(&count_lock);
+    while (*counter < target && ok)
+        ok = pthread_cond_timedwait(&count_cond, &count_lock, &ts) == 0;
+    ok = *counter >= target;
+    pthread_mutex_unlock(&count_lock);
+    return ok;
+}
@@ -0,0 +1,69 @@
+/******************************************************************************
+ * @brief        Common parts of the benchmarks
+ *
+ * The simulated EC800M on its pseudo-terminal, the AT thread running the AT objects,
+ * the clocks, the completion counters and the check of the memory pools.
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#ifndef __BENCH_COMMON_H__
+#define __BENCH_COMMON_H__
+
+#include "at_chat.h"
+#include "at_device_linux.h"
+#include "at_sim.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Maximum number of AT objects run by the AT thread.
+ */
+#define BENCH_OBJ_MAX 4
+
+/**
+ * @brief Adapter of the AT objects created with a NULL adapter (the serial port of the
+ *        simulator, 256-byte receive buffer, no URC buffer).
+ */
+extern const at_adapter_t bench_adapter;
+
+at_sim_t *bench_sim_open(const char *name, const at_sim_conf_t *conf);
+
+void bench_close(at_sim_t *sim);
+
+at_obj_t *bench_obj_create(const at_adapter_t *adapter);
+
+void bench_set_poll(bool poll);
+
+void bench_start(void);
+
+void bench_stop(void);
+
+void bench_wait_idle(void);
+
+unsigned int bench_check_pools(void);
+
+unsigned long long bench_now_us(void);
+
+unsigned long long bench_now_ns(void);
+
+unsigned long long bench_thread_cpu_ns(void);
+
+unsigned long bench_wakeups(void);
+
+void bench_count(unsigned int *counter);
+
+bool bench_wait_count(unsigned int *counter, unsigned int target, unsigned int timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
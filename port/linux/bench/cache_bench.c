@@ -0,0 +1,229 @@
+/******************************************************************************
+ * @brief        Query cache benchmark against the simulated EC800M
+ *
+ * Several application modules poll the same status queries (AT+CSQ, AT+CREG?,
+ * AT+CGATT?, AT+QMTOPEN?) on their own schedule, while the modem reports "+CREG:"
+ * URCs. The load is run without and with the query cache, the number of commands
+ * received by the modem and the response time seen by the modules are compared.
+ * The benchmark fails if a query fails or gets another response than without the
+ * cache, or if the cache does not save any command.
+ *
+ * Usage: cache_bench [-m modules] [-t duration_ms] [-i interval_ms] [-d delay_us] [-s]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_MODULES 16
+#define QUERY_COUNT 4
+
+/**
+ * @brief Outstanding query of a module.
+ */
+typedef struct
+{
+    int query;
+    volatile int busy;
+    unsigned long long submit;
+} query_slot_t;
+
+static const at_cache_rule_t cache_rules[QUERY_COUNT] = {
+    {"AT+CSQ", 1000, NULL},
+    {"AT+CREG?", 5000, "+CREG:"},
+    {"AT+CGATT?", 2000, NULL},
+    {"AT+QMTOPEN?", 2000, "+QMTSTAT:"},
+};
+
+static const char *const query_prefix[QUERY_COUNT] = {"+CSQ:", "+CREG:", "+CGATT:", NULL};
+
+static query_slot_t slots[MAX_MODULES][QUERY_COUNT];
+static at_obj_t *at_obj;
+static int in_phase;
+static unsigned long responses, failures, bad_responses;
+static unsigned long long latency_sum, latency_max;
+
+static const at_adapter_t adapter = {
+    .lock = at_linux_lock,
+    .unlock = at_linux_unlock,
+    .write = at_linux_write,
+    .read = at_linux_read,
+    .notify = at_linux_notify,
+    .urc_bufsize = 128,
+    .recv_bufsize = 256,
+};
+
+static void on_response(at_response_t *r)
+{
+    query_slot_t *s = r->params;
+    unsigned long long us = bench_now_us() - s->submit;
+    const char *prefix = query_prefix[s->query];
+    if (r->code != AT_RESP_OK)
+        failures++;
+    else if (prefix != NULL && strncmp(r->prefix, prefix, strlen(prefix)) != 0)
+        bad_responses++; // The callers must see the same response as without the cache.
+    responses++;
+    latency_sum += us;
+    if (us > latency_max)
+        latency_max = us;
+    s->busy = 0;
+}
+
+/**
+ * @brief  Run the modules for a while, each of them polls every query once per interval
+ *         (spread over the interval, or all at the same time with -s), then wait until 
+ *         the queue is drained.
+ */
+static void run_load(int modules, unsigned int duration_ms, unsigned int interval_ms, at_sim_t *sim)
+{
+    static const char creg_urc[] = "\r\n+CREG: 1\r\n";
+    unsigned long long start = bench_now_us(), now, next_urc = start;
+    unsigned long long next[MAX_MODULES];
+    at_attr_t attr;
+    int m, q;
+    for (m = 0; m < modules; m++)
+        next[m] = in_phase ? start : start + m * interval_ms * 1000ull / modules;
+    at_attr_deinit(&attr);
+    attr.cb = on_response;
+    attr.timeout = 1000;
+    while ((now = bench_now_us()) - start < duration_ms * 1000ull)
+    {
+        for (m = 0; m < modules; m++)
+        {
+            if (now < next[m])
+                continue;
+            next[m] += interval_ms * 1000ull;
+            for (q = 0; q < QUERY_COUNT; q++)
+            {
+                query_slot_t *s = &slots[m][q];
+                if (s->busy)
+                    continue;
+                s->query = q;
+                s->busy = 1;
+                s->submit = bench_now_us();
+                attr.params = s;
+                attr.prefix = query_prefix[q];
+                if (!at_exec_cmd(at_obj, &attr, cache_rules[q].cmd))
+                    s->busy = 0;
+            }
+        }
+        if (now >= next_urc) // The registration state changes every second.
+        {
+            at_sim_inject(sim, creg_urc, sizeof(creg_urc) - 1);
+            next_urc += 1000000ull;
+        }
+        usleep(500);
+    }
+    bench_wait_idle();
+    for (m = 0; m < modules; m++)
+    {
+        for (q = 0; q < QUERY_COUNT; q++)
+        {
+            while (slots[m][q].busy)
+                usleep(1000);
+        }
+    }
+}
+
+/**
+ * @brief  Print the result of a run and reset the counters.
+ * @param  sent Commands received by the modem during the run.
+ * @return Number of failed and bad responses.
+ */
+static unsigned long print_result(const char *name, at_sim_t *sim, const at_sim_stat_t *st0,
+                                  unsigned long *sent)
+{
+    unsigned long errors = failures + bad_responses;
+    at_sim_stat_t st;
+    at_sim_get_stat(sim, &st);
+    *sent = st.commands - st0->commands;
+    printf("%-9s: %lu queries (%lu failed, %lu bad), %lu modem commands, response avg %.2f ms max %.2f ms\n",
+           name, responses, failures, bad_responses, st.commands - st0->commands,
+           responses ? latency_sum / 1000.0 / responses : 0, latency_max / 1000.0);
+    responses = failures = bad_responses = 0;
+    latency_sum = latency_max = 0;
+    return errors;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-m modules] [-t duration_ms] [-i interval_ms] [-d delay_us] [-s]\n"
+            "  -m  Number of application modules polling the queries (default 4)\n"
+            "  -t  Duration of each run (default 5000)\n"
+            "  -i  Polling interval of each module (default 200)\n"
+            "  -d  Simulated response latency of every command (default 5000)\n"
+            "  -s  The modules poll at the same time (identical queries in flight are joined)\n",
+            name);
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {115200, 5000, 0, 10, 0, 0};
+    unsigned int duration = 5000, interval = 200;
+    int modules = 4, opt;
+    unsigned long errors, uncached, cached;
+    at_cache_stat_t cst;
+    at_sim_stat_t st0;
+    at_sim_t *sim;
+    while ((opt = getopt(argc, argv, "m:t:i:d:sh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'm':
+            modules = atoi(optarg);
+            if (modules < 1 || modules > MAX_MODULES)
+                modules = 4;
+            break;
+        case 't':
+            duration = strtoul(optarg, NULL, 0);
+            break;
+        case 'i':
+            interval = strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            conf.resp_delay_us = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            in_phase = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    sim = bench_sim_open("cache_bench", &conf);
+    if (sim == NULL)
+        return 1;
+    at_obj = bench_obj_create(&adapter);
+    if (at_obj == NULL)
+        return 1;
+    bench_start();
+
+    printf("%d modules, 4 queries every %u ms, %u ms:\n", modules, interval, duration);
+    at_sim_get_stat(sim, &st0);
+    run_load(modules, duration, interval, sim);
+    errors = print_result("no cache", sim, &st0, &uncached);
+
+    at_obj_set_cache(at_obj, cache_rules, QUERY_COUNT);
+    at_sim_get_stat(sim, &st0);
+    run_load(modules, duration, interval, sim);
+    errors += print_result("cache", sim, &st0, &cached);
+    at_obj_get_cache_stat(at_obj, &cst);
+    printf("cache    : %u hits, %u joins, %u misses, %u invalidations\n", cst.hits, cst.joins,
+           cst.misses, cst.invalidations);
+    errors += cached >= uncached;
+    errors += bench_check_pools();
+    printf("%s\n", errors != 0 ? "FAILED" : "ok");
+
+    bench_stop();
+    bench_close(sim);
+    return errors != 0;
+}
@@ -0,0 +1,233 @@
+/******************************************************************************
+ * @brief        CMUX benchmark against the simulated EC800M
+ *
+ * The module is switched to CMUX mode and three AT objects run on their own channels:
+ * DLCI 1 runs pipelined commands, DLCI 2 a command that never completes (it blocks its
+ * channel until the timeout) and DLCI 3 receives a URC storm, all at the same time.
+ *
+ * Usage: cmux_bench [-b baudrate] [-n commands] [-u urcs]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "at_cmux.h"
+#include "bench_common.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BENCH_URC "\r\n+QMTRECV: 0,1,\"topic/bench\",16,\"0123456789abcdef\"\r\n"
+#define BENCH_CHANNELS 3
+
+static at_obj_t *at_objs[BENCH_CHANNELS];
+static unsigned int done_count, fail_count, urc_count, block_count;
+static at_resp_code block_code;
+static unsigned long long block_time;
+
+static const at_cmux_port_t cmux_port = {
+    .write = at_linux_write,
+    .read = at_linux_read,
+};
+
+static at_adapter_t adapters[BENCH_CHANNELS];
+static at_sim_t *sim;
+static unsigned int urcs = 1000;
+
+static void on_response(at_response_t *r)
+{
+    if (r->code != AT_RESP_OK)
+        fail_count++;
+    bench_count(&done_count);
+}
+
+static void on_blocked(at_response_t *r)
+{
+    block_code = r->code;
+    block_time = bench_now_ns();
+    bench_count(&block_count);
+}
+
+static int on_qmtrecv(at_urc_info_t *info)
+{
+    bench_count(&urc_count);
+    return 0;
+}
+
+static const urc_item_t urc_table[] = {
+    {"+QMTRECV:", '\n', on_qmtrecv, NULL, NULL},
+};
+
+static void *storm_thread_entry(void *arg)
+{
+    at_sim_urc_storm(sim, BENCH_URC, urcs, 0);
+    return NULL;
+}
+
+/**
+ * @brief  Switch the module to CMUX mode with a plain AT object and open the channels.
+ */
+static bool cmux_start(void)
+{
+    static const at_adapter_t plain = {
+        .lock = at_linux_lock,
+        .unlock = at_linux_unlock,
+        .write = at_linux_write,
+        .read = at_linux_read,
+        .recv_bufsize = 128,
+    };
+    at_obj_t *obj = at_obj_create(&plain);
+    at_attr_t attr;
+    unsigned long long t0;
+    unsigned int wait;
+    int i;
+    if (obj == NULL)
+        return false;
+    at_attr_deinit(&attr);
+    attr.cb = on_response;
+    attr.retry = 0;
+    at_exec_cmd(obj, &attr, "AT+CMUX=0");
+    while (done_count == 0)
+    {
+        wait = at_obj_process_timed(obj);
+        if (done_count == 0)
+            at_linux_wait(wait);
+    }
+    at_obj_destroy(obj);
+    if (fail_count != 0 || !at_cmux_init(&cmux_port))
+        return false;
+    at_cmux_open(0);
+    for (t0 = bench_now_ns(); !at_cmux_is_open(0) && bench_now_ns() - t0 < 1000000000ull;)
+    {
+        at_linux_wait(10);
+        at_cmux_poll();
+    }
+    for (i = 1; i <= BENCH_CHANNELS; i++)
+        at_cmux_open(i);
+    for (t0 = bench_now_ns(); bench_now_ns() - t0 < 1000000000ull;)
+    {
+        for (i = 1; i <= BENCH_CHANNELS && at_cmux_is_open(i); i++)
+            ;
+        if (i > BENCH_CHANNELS)
+            return true;
+        at_linux_wait(10);
+        at_cmux_poll();
+    }
+    return false;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-b baudrate] [-n commands] [-u urcs]\n"
+            "  -b  Simulated serial rate (default 115200, 0: no pacing)\n"
+            "  -n  Number of commands run on DLCI 1 (default 1000)\n"
+            "  -u  Number of URCs sent on DLCI 3 (default 1000)\n",
+            name);
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {115200, 0, 0, 10, 0, 3};
+    unsigned int cmds = 1000, i;
+    unsigned long long t0, t1, t2, cpu0, cpu1;
+    pthread_t storm_thread;
+    at_sim_stat_t st0, st1;
+    at_cmux_stat_t cst;
+    at_attr_t attr;
+    int opt, errors;
+    while ((opt = getopt(argc, argv, "b:n:u:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            conf.baudrate = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            cmds = strtoul(optarg, NULL, 0);
+            break;
+        case 'u':
+            urcs = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    sim = bench_sim_open("cmux_bench", &conf);
+    if (sim == NULL)
+        return 1;
+    // DLCI 2: a command without response, it blocks the channel until its timeout.
+    at_sim_add_rule(sim, "AT+QIDNSGIP", "");
+    if (!cmux_start())
+    {
+        fprintf(stderr, "failed to start CMUX\n");
+        return 1;
+    }
+    for (i = 0; i < BENCH_CHANNELS; i++)
+    {
+        adapters[i].lock = at_linux_lock;
+        adapters[i].unlock = at_linux_unlock;
+        adapters[i].notify = at_linux_notify;
+        adapters[i].urc_bufsize = 256;
+        adapters[i].recv_bufsize = 256;
+        at_cmux_adapter(i + 1, &adapters[i]);
+        at_objs[i] = bench_obj_create(&adapters[i]);
+        if (at_objs[i] == NULL)
+            return 1;
+    }
+    at_obj_set_urc(at_objs[2], urc_table, sizeof(urc_table) / sizeof(urc_table[0]));
+    bench_start();
+
+    printf("cmux, %u baud, URCs on DLCI %d\n", conf.baudrate, conf.urc_dlci);
+    done_count = fail_count = 0;
+    at_attr_deinit(&attr);
+    attr.cb = on_blocked;
+    attr.timeout = 5000;
+    attr.retry = 0;
+    t0 = bench_now_ns();
+    at_exec_cmd(at_objs[1], &attr, "AT+QIDNSGIP=1,\"example.com\"");
+
+    at_sim_get_stat(sim, &st0);
+    cpu0 = bench_thread_cpu_ns();
+    pthread_create(&storm_thread, NULL, storm_thread_entry, NULL);
+    attr.cb = on_response;
+    attr.prefix = "+CSQ:";
+    attr.timeout = 1000;
+    for (i = 0; i < cmds; i++)
+    {
+        while (!at_exec_cmd(at_objs[0], &attr, "AT+CSQ"))
+            usleep(100);
+    }
+    bench_wait_count(&done_count, cmds, 10000 + cmds * 10);
+    t1 = bench_now_ns();
+    bench_wait_count(&urc_count, urcs, 10000 + urcs * 10);
+    t2 = bench_now_ns();
+    pthread_join(storm_thread, NULL);
+    cpu1 = bench_thread_cpu_ns();
+    at_sim_get_stat(sim, &st1);
+    printf("DLCI 1     : %u/%u cmds (%u failed) in %.0f ms, %.0f cmds/s\n", done_count, cmds,
+           fail_count, (t1 - t0) / 1e6, done_count * 1e9 / (t1 - t0));
+    printf("DLCI 3     : %u/%u urcs in %.0f ms\n", urc_count, urcs, (t2 - t0) / 1e6);
+    bench_wait_count(&block_count, 1, 10000);
+    printf("DLCI 2     : %s after %.0f ms\n", block_code == AT_RESP_TIMEOUT ? "timeout" : "response",
+           (block_time - t0) / 1e6);
+    at_cmux_get_stat(&cst);
+    printf("frames     : %u rx, %u tx, %u bad (host), %lu bad (module)\n", cst.rx_frames,
+           cst.tx_frames, cst.fcs_errors, st1.bad_frames);
+    printf("AT thread  : %.1f ns/byte\n",
+           (double)(cpu1 - cpu0) / (st1.tx_bytes - st0.tx_bytes + st1.rx_bytes - st0.rx_bytes));
+    // DLCI 1 and 3 must not be held up by the blocked DLCI 2.
+    errors = (cmds - done_count) + fail_count + (urcs - urc_count) + (block_code != AT_RESP_TIMEOUT);
+    errors += bench_check_pools();
+    printf("%s\n", errors != 0 ? "FAILED" : "ok");
+
+    bench_stop();
+    at_cmux_stop();
+    bench_close(sim);
+    return errors != 0;
+}
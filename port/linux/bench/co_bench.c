@@ -0,0 +1,206 @@
+/******************************************************************************
+ * @brief        Coroutine work benchmark against the simulated EC800M
+ *
+ * The MQTT bring-up flow (AT+CGATT?, AT+CGACT, AT+QMTOPEN, AT+QMTCONN and AT+QMTSUB,
+ * the last three completed by their result URC) is run as a hand-written state machine
+ * (at_do_work, polled on every cycle) and as a coroutine (at_do_coroutine, resumed when
+ * what it awaits ends). The time of a flow and the wakeups of the AT thread are
+ * compared, then a failing step and the pools are checked.
+ *
+ * Usage: co_bench [-n flows] [-r result_delay_ms]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Step of the flow, 'urc' is the expected result URC (NULL: the response is enough).
+ */
+typedef struct
+{
+    const char *cmd;
+    const char *prefix;
+    const char *urc;
+} step_t;
+
+static const step_t steps[] = {
+    {"AT+CGATT?", "+CGATT: 1", NULL},
+    {"AT+CGACT=1,1", NULL, NULL},
+    {"AT+QMTOPEN=0,\"iot.example.com\",1883", "+QMTOPEN: 0,", "+QMTOPEN: 0,0"},
+    {"AT+QMTCONN=0,\"ec800m\"", "+QMTCONN: 0,", "+QMTCONN: 0,0,0"},
+    {"AT+QMTSUB=0,1,\"cmd\",1", "+QMTSUB: 0,", "+QMTSUB: 0,1,0"},
+};
+
+#define STEP_COUNT   (int)(sizeof(steps) / sizeof(steps[0]))
+#define STEP_TIMEOUT 2000
+
+static at_obj_t *at_obj;
+static volatile int result;          /* Failed step + 1, 0 while running, -1 on success*/
+/**
+ * @brief  The flow as a state machine: env->i is the step, env->state the phase of the step.
+ */
+static int flow_fsm(at_env_t *env)
+{
+    const step_t *s = &steps[env->i];
+    switch (env->state)
+    {
+    case 0:
+        env->recvclr(env);
+        env->println(env, s->cmd);
+        env->reset_timer(env);
+        env->state = 1;
+        break;
+    case 1:
+        if (env->contains(env, "OK"))
+        {
+            if (s->prefix != NULL && s->urc == NULL && !env->contains(env, s->prefix))
+                break;
+            env->reset_timer(env);
+            env->state = s->urc != NULL ? 2 : 3;
+        }
+        else if (env->contains(env, "ERROR") || env->is_timeout(env, STEP_TIMEOUT))
+        {
+            result = env->i + 1;
+            return true;
+        }
+        break;
+    case 2:
+        if (env->contains(env, s->urc))
+            env->state = 3;
+        else if (env->is_timeout(env, STEP_TIMEOUT))
+        {
+            result = env->i + 1;
+            return true;
+        }
+        break;
+    }
+    if (env->state == 3)
+    {
+        env->state = 0;
+        if (++env->i == STEP_COUNT)
+        {
+            result = -1;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief  The flow as a coroutine.
+ */
+static int flow_co(at_env_t *env)
+{
+    at_attr_t attr;
+    at_attr_deinit(&attr);
+    attr.timeout = STEP_TIMEOUT;
+    attr.retry = 0;
+    AT_CO_BEGIN(env);
+    for (env->i = 0; env->i < STEP_COUNT; env->i++)
+    {
+        attr.prefix = steps[env->i].urc == NULL ? steps[env->i].prefix : NULL;
+        AT_CO_CMD(env, &attr, "%s", steps[env->i].cmd);
+        if (at_co_result(env) != AT_RESP_OK)
+            break;
+        if (steps[env->i].urc == NULL)
+            continue;
+        AT_CO_URC(env, steps[env->i].prefix, STEP_TIMEOUT);
+        if (at_co_result(env) != AT_RESP_OK ||
+            strncmp(at_co_resp(env), steps[env->i].urc, strlen(steps[env->i].urc)) != 0)
+            break;
+    }
+    result = env->i < STEP_COUNT ? env->i + 1 : -1;
+    AT_CO_END(env);
+}
+
+/**
+ * @brief  Run the flow several times and print the time and the wakeups per flow.
+ * @return Number of failed flows.
+ */
+static unsigned int run_flows(const char *name, at_work_t flow, unsigned int count)
+{
+    unsigned long long t0, us, sum = 0, max = 0;
+    unsigned long w0, w = 0;
+    unsigned int i, failures = 0;
+    for (i = 0; i < count; i++)
+    {
+        result = 0;
+        w0 = bench_wakeups();
+        t0 = bench_now_us();
+        if (!(flow == flow_co ? at_do_coroutine(at_obj, NULL, flow) : at_do_work(at_obj, NULL, flow)))
+            continue;
+        while (result == 0)
+            usleep(200);
+        us = bench_now_us() - t0;
+        w += bench_wakeups() - w0;
+        sum += us;
+        if (us > max)
+            max = us;
+        failures += result != -1;
+    }
+    printf("  %-10s %8u %10.2f %10.2f %10.1f\n", name, failures, sum / 1000.0 / count, max / 1000.0,
+           (double)w / count);
+    return failures;
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {115200, 2000, 0, 50, 0, 0};
+    unsigned int count = 20, errors;
+    at_sim_t *sim;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            count = strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            conf.result_delay_ms = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-n flows] [-r result_delay_ms]\n"
+                    "  -n  Number of flows of each run (default 20)\n"
+                    "  -r  Delay of the result URCs (default 50)\n",
+                    argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    sim = bench_sim_open("co_bench", &conf);
+    if (sim == NULL)
+        return 1;
+    at_obj = bench_obj_create(NULL);
+    if (at_obj == NULL)
+        return 1;
+    bench_start();
+
+    printf("%u flows of %d steps, result URC delay %u ms\n", count, STEP_COUNT, conf.result_delay_ms);
+    printf("  %-10s %8s %10s %10s %10s\n", "work", "failures", "avg ms", "max ms", "wakeups");
+    errors = run_flows("at_do_work", flow_fsm, count);
+    errors += run_flows("coroutine", flow_co, count);
+    printf("checks:\n");
+    // The connection is refused: the flow stops at AT+QMTCONN.
+    at_sim_add_rule(sim, "AT+QMTCONN=", "\r\nOK\r\n\r\n+QMTCONN: 0,0,5\r\n");
+    result = 0;
+    at_do_coroutine(at_obj, NULL, flow_co);
+    while (result == 0)
+        usleep(200);
+    printf("  refused         : step %d (expected 4)\n", result);
+    errors += result != 4;
+    errors += bench_check_pools();
+    printf("%s\n", errors != 0 ? "FAILED" : "ok");
+
+    bench_stop();
+    bench_close(sim);
+    return errors != 0;
+}
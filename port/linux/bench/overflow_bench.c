@@ -0,0 +1,197 @@
+/******************************************************************************
+ * @brief        Receive buffer overflow check against the simulated EC800M
+ *
+ * The AT object uses 1024-byte receive and URC buffers (the UART_BUF_SIZE of the ESP32
+ * application). AT+QFLST is answered with a file listing larger than the receive buffer:
+ * the command must still complete with OK, report the discarded bytes in
+ * at_response_t.dropped and keep the latest data (the last listing line). An injected
+ * +QMTRECV URC larger than the URC buffer must reach its handler as URC_RECV_OVERFLOW.
+ * The next command and the next URC must then be received normally.
+ *
+ * Usage: overflow_bench [-b baudrate] [-n commands] [-s size]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BUF_SIZE 1024
+
+static at_obj_t *at_obj;
+static unsigned int done_count, bad_count, urc_count;
+static unsigned int last_dropped;
+static const char *expect;
+static urc_recv_status urc_status;
+static int urc_len;
+
+static const at_adapter_t adapter = {
+    .lock = at_linux_lock,
+    .unlock = at_linux_unlock,
+    .write = at_linux_write,
+    .read = at_linux_read,
+    .notify = at_linux_notify,
+    .urc_bufsize = BUF_SIZE,
+    .recv_bufsize = BUF_SIZE,
+};
+
+static int on_qmtrecv(at_urc_info_t *info)
+{
+    urc_status = info->status;
+    urc_len = info->urclen;
+    bench_count(&urc_count);
+    return 0;
+}
+
+static const urc_item_t urc_table[] = {
+    {"+QMTRECV:", '\n', on_qmtrecv, NULL, NULL},
+};
+
+static void on_response(at_response_t *r)
+{
+    last_dropped = r->dropped;
+    if (r->code != AT_RESP_OK || r->recvcnt >= BUF_SIZE || r->prefix < r->recvbuf ||
+        r->prefix > r->recvbuf + r->recvcnt || strstr(r->recvbuf, expect) == NULL)
+        bad_count++;
+    bench_count(&done_count);
+}
+
+/**
+ * @brief  Build a file listing of about 'size' bytes.
+ * @param  last Last line of the listing (output).
+ */
+static char *build_listing(unsigned int size, char *last)
+{
+    char *resp = malloc(size + 64), line[48];
+    unsigned int len = 2, i = 0;
+    if (resp == NULL)
+        return NULL;
+    strcpy(resp, "\r\n");
+    while (len < size)
+    {
+        sprintf(line, "+QFLST: \"UFS:log_%04u.txt\",%u\r\n", i, 1000 + i * 37);
+        strcpy(resp + len, line);
+        len += strlen(line);
+        strcpy(last, line);
+        i++;
+    }
+    strcpy(resp + len, "\r\nOK\r\n");
+    return resp;
+}
+
+/**
+ * @brief  Run one command and check its response.
+ * @param  overflow The response is larger than the receive buffer.
+ * @return 1 if the command failed or the overflow was not reported as expected.
+ */
+static int run_cmd(const char *cmd, const char *prefix, const char *last, bool overflow)
+{
+    at_attr_t attr;
+    at_attr_deinit(&attr);
+    attr.cb = on_response;
+    attr.prefix = prefix;
+    attr.timeout = 3000;
+    attr.retry = 0;
+    expect = last;
+    done_count = bad_count = 0;
+    at_exec_cmd(at_obj, &attr, cmd);
+    if (!bench_wait_count(&done_count, 1, 5000))
+    {
+        printf("  %-12s no response\n", cmd);
+        return 1;
+    }
+    printf("  %-12s %s, %u bytes dropped\n", cmd, bad_count ? "bad response" : "ok", last_dropped);
+    return bad_count != 0 || (last_dropped != 0) != overflow;
+}
+
+/**
+ * @brief  Inject a +QMTRECV URC with a payload of 'size' bytes and check its status.
+ */
+static int run_urc(at_sim_t *sim, unsigned int size, urc_recv_status expect_status)
+{
+    char *urc = malloc(size + 64);
+    int len;
+    if (urc == NULL)
+        return 1;
+    len = sprintf(urc, "\r\n+QMTRECV: 0,1,\"topic/bench\",\"");
+    memset(urc + len, 'x', size);
+    len += size;
+    len += sprintf(urc + len, "\"\r\n");
+    urc_count = 0;
+    urc_status = URC_RECV_OK;
+    at_sim_inject(sim, urc, len);
+    free(urc);
+    if (!bench_wait_count(&urc_count, 1, 2000))
+    {
+        printf("  urc %5u    not delivered\n", size);
+        return 1;
+    }
+    printf("  urc %5u    status %d, %d bytes delivered\n", size, urc_status, urc_len);
+    return urc_status != expect_status || urc_len >= BUF_SIZE;
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {115200, 0, 0, 10, 0, 0};
+    unsigned int count = 5, size = 2560, errors = 0, i;
+    char *listing, last[48];
+    at_sim_t *sim;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:n:s:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            conf.baudrate = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            count = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            size = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-b baudrate] [-n commands] [-s size]\n"
+                    "  -b  Simulated serial rate (default 115200, 0: no pacing)\n"
+                    "  -n  Number of oversized responses (default 5)\n"
+                    "  -s  Size of the oversized response and URC (bytes, default 2560)\n",
+                    argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (size < BUF_SIZE * 2)
+        size = BUF_SIZE * 2;
+    listing = build_listing(size, last);
+    sim = bench_sim_open("overflow_bench", &conf);
+    if (listing == NULL || sim == NULL)
+        return 1;
+    at_sim_add_rule(sim, "AT+QFLST", listing);
+    at_obj = bench_obj_create(&adapter);
+    if (at_obj == NULL)
+        return 1;
+    at_obj_set_urc(at_obj, urc_table, sizeof(urc_table) / sizeof(urc_table[0]));
+    bench_start();
+
+    printf("%u byte response and URC, %d byte buffers, %u baud\n", size, BUF_SIZE, conf.baudrate);
+    for (i = 0; i < count; i++)
+    {
+        errors += run_cmd("AT+QFLST", "+QFLST:", last, true);
+        errors += run_cmd("AT+CSQ", "+CSQ:", "+CSQ: 24,99", false);
+    }
+    errors += run_urc(sim, size, URC_RECV_OVERFLOW);
+    errors += run_urc(sim, 16, URC_RECV_OK);
+    errors += bench_check_pools();
+    printf("%s\n", errors != 0 ? "FAILED" : "ok");
+
+    bench_stop();
+    bench_close(sim);
+    free(listing);
+    return errors != 0;
+}
@@ -0,0 +1,216 @@
+/******************************************************************************
+ * @brief        Prompt command benchmark against the simulated EC800M
+ *
+ * AT+QMTPUBEX answers with the '>' prompt, reads the payload, answers OK and reports
+ * the result with "+QMTPUBEX: 0,<msgid>,0". Messages are published:
+ *   line     - the command line alone (as mqtt_init did), the modem then takes the
+ *              next commands as payload
+ *   two-step - the command (suffix ">") and the payload (at_send_data) as two works
+ *   copy     - at_exec_payload, payload copied into the work item
+ *   borrow   - at_exec_payload, payload written from the caller's buffer
+ * Each message is followed by an AT+CSQ, the failed publications and queries and the
+ * time per message are compared, any failure of the methods other than line fails the
+ * benchmark. It then checks a missing prompt, an error instead of the prompt and the
+ * pools.
+ *
+ * Usage: payload_bench [-n messages] [-s payload_size]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define PAYLOAD_MAX 1024
+
+/**
+ * @brief Publication method.
+ */
+typedef enum
+{
+    PUB_LINE = 0,
+    PUB_TWO_STEP,
+    PUB_COPY,
+    PUB_BORROW
+} pub_method;
+
+static const char *const method_names[] = {"line", "two-step", "copy", "borrow"};
+
+static at_obj_t *at_obj;
+static volatile int done;
+static unsigned int pub_failures, csq_failures;
+static char payload[PAYLOAD_MAX];
+
+static void on_publish(at_response_t *r)
+{
+    if (r->code != AT_RESP_OK)
+        pub_failures++;
+}
+
+static void on_csq(at_response_t *r)
+{
+    if (r->code != AT_RESP_OK || strncmp(r->prefix, "+CSQ:", 5) != 0)
+        csq_failures++;
+    done = 1;
+}
+
+/**
+ * @brief  Publish a message with a method, the command is followed by an AT+CSQ.
+ */
+static void publish(pub_method method, unsigned int id, unsigned int size)
+{
+    at_payload_t pl = {payload, size, 0, method == PUB_COPY};
+    at_attr_t attr;
+    at_attr_deinit(&attr);
+    attr.cb = on_publish;
+    attr.retry = 0;
+    attr.timeout = 1000;
+    switch (method)
+    {
+    case PUB_LINE:
+        at_exec_cmd(at_obj, &attr, "AT+QMTPUBEX=0,%u,1,0,\"up\",%u", id, size);
+        break;
+    case PUB_TWO_STEP:
+        attr.suffix = ">";
+        at_exec_cmd(at_obj, &attr, "AT+QMTPUBEX=0,%u,1,0,\"up\",%u", id, size);
+        attr.suffix = "OK";
+        attr.urc = "+QMTPUBEX: 0,";
+        at_send_data(at_obj, &attr, payload, size);
+        break;
+    default:
+        attr.urc = "+QMTPUBEX: 0,";
+        at_exec_payload(at_obj, &attr, &pl, "AT+QMTPUBEX=0,%u,1,0,\"up\",%u", id, size);
+        break;
+    }
+    at_attr_deinit(&attr);
+    attr.cb = on_csq;
+    attr.prefix = "+CSQ:";
+    attr.retry = 0;
+    at_exec_cmd(at_obj, &attr, "AT+CSQ");
+}
+
+/**
+ * @brief  Publish the messages with a method and print the failures and the time.
+ * @return Failed publications and queries, 0 for the line method (expected to fail).
+ */
+static unsigned int run_method(pub_method method, unsigned int count, unsigned int size)
+{
+    unsigned long long t0;
+    unsigned int i;
+    at_attr_t attr;
+    if (method == PUB_LINE && count > 2)
+        count = 2; // Every command times out, two show it.
+    pub_failures = csq_failures = 0;
+    t0 = bench_now_us();
+    for (i = 0; i < count; i++)
+    {
+        done = 0;
+        publish(method, i % 65535 + 1, size);
+        while (done == 0)
+            usleep(200);
+    }
+    t0 = bench_now_us() - t0;
+    printf("  %-10s %8u %8u %10.2f\n", method_names[method], pub_failures, csq_failures, t0 / 1000.0 / count);
+    if (method == PUB_LINE)
+    { // End the payload the modem is still waiting for, then the partial command line.
+        at_attr_deinit(&attr);
+        attr.retry = 0;
+        at_send_data(at_obj, &attr, payload, size);
+        at_exec_cmd(at_obj, &attr, "AT");
+    }
+    bench_wait_idle();
+    usleep(300000); // Let the late URCs arrive.
+    return method == PUB_LINE ? 0 : pub_failures + csq_failures;
+}
+
+/**
+ * @brief  Corner cases of the prompt commands, returns the number of failed checks.
+ */
+static int run_checks(at_sim_t *sim)
+{
+    at_payload_t pl = {payload, 16, 100, 1};
+    at_sync_resp_t resp;
+    at_resp_code code;
+    at_attr_t attr;
+    char buf[64];
+    int errors = 0;
+    at_attr_deinit(&attr);
+    attr.cb = on_publish;
+    attr.retry = 0;
+    // No prompt: the command times out after the prompt timeout and the next one works.
+    at_sim_add_rule(sim, "AT+QMTPUBEX=0,9,", "");
+    pub_failures = 0;
+    at_exec_payload(at_obj, &attr, &pl, "AT+QMTPUBEX=0,9,1,0,\"up\",16");
+    at_sync_resp_init(&resp, buf, sizeof(buf), AT_WAIT_FOREVER);
+    code = at_exec_cmd_sync(at_obj, NULL, &resp, "AT+CSQ");
+    printf("  no prompt       : %u failed, next %d (expected 1 failed, next %d)\n", pub_failures, code,
+           AT_RESP_OK);
+    errors += pub_failures != 1 || code != AT_RESP_OK;
+    // An error instead of the prompt: the payload is not written.
+    at_sim_add_rule(sim, "AT+QMTPUBEX=0,8,", "\r\n+CME ERROR: 3\r\n");
+    pub_failures = 0;
+    at_exec_payload(at_obj, &attr, &pl, "AT+QMTPUBEX=0,8,1,0,\"up\",16");
+    code = at_exec_cmd_sync(at_obj, NULL, &resp, "AT+CSQ");
+    printf("  error           : %u failed, next %d (expected 1 failed, next %d)\n", pub_failures, code,
+           AT_RESP_OK);
+    errors += pub_failures != 1 || code != AT_RESP_OK;
+    return errors + bench_check_pools();
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {115200, 2000, 0, 20, 0, 0};
+    unsigned int count = 50, size = 140, i;
+    at_sim_t *sim;
+    int opt, errors;
+    while ((opt = getopt(argc, argv, "n:s:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            count = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            size = strtoul(optarg, NULL, 0);
+            if (size == 0 || size > PAYLOAD_MAX)
+                size = 140;
+            break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-n messages] [-s payload_size]\n"
+                    "  -n  Number of messages of each method (default 50)\n"
+                    "  -s  Payload size (default 140, up to 1024)\n",
+                    argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    for (i = 0; i < size; i++)
+        payload[i] = 'a' + i % 26;
+    sim = bench_sim_open("payload_bench", &conf);
+    if (sim == NULL)
+        return 1;
+    at_obj = bench_obj_create(NULL);
+    if (at_obj == NULL)
+        return 1;
+    bench_start();
+
+    printf("%u messages of %u bytes, each followed by AT+CSQ\n", count, size);
+    printf("  %-10s %8s %8s %10s\n", "method", "pub fail", "csq fail", "avg ms");
+    errors = run_method(PUB_LINE, count, size);
+    errors += run_method(PUB_TWO_STEP, count, size);
+    errors += run_method(PUB_COPY, count, size);
+    errors += run_method(PUB_BORROW, count, size);
+    printf("checks:\n");
+    errors += run_checks(sim);
+    printf("%s\n", errors != 0 ? "FAILED" : "ok");
+
+    bench_stop();
+    bench_close(sim);
+    return errors != 0;
+}
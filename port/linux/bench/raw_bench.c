@@ -0,0 +1,210 @@
+/******************************************************************************
+ * @brief        Transparent transmission throughput benchmark
+ *
+ * The modem is replaced by a loopback pseudo-terminal (everything sent to it is sent back),
+ * the host side generates a counting pattern and verifies it when it comes back. The
+ * benchmark fails if the data does not all come back unchanged.
+ *
+ * Usage: raw_bench [-s size_kb] [-B bufsize] [-m event|poll] [-z]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+static at_obj_t *at_obj;
+static volatile int looping = 1;
+static int event_mode = 1;
+static int loop_fd;
+
+static unsigned int total_size;
+static unsigned int tx_count, rx_count, rx_errors;
+static unsigned char pattern[4096];
+
+static const at_adapter_t adapter = {
+    .lock = at_linux_lock,
+    .unlock = at_linux_unlock,
+    .write = at_linux_write,
+    .writev = at_linux_writev,
+    .read = at_linux_read,
+    .notify = at_linux_notify,
+    .urc_bufsize = 256,
+    .recv_bufsize = 256,
+};
+
+/**
+ * @brief  Host side reading interface: the counting pattern, total_size bytes in all.
+ */
+static unsigned int host_read(void *buf, unsigned int len)
+{
+    unsigned int off = tx_count % sizeof(pattern);
+    if (len > total_size - tx_count)
+        len = total_size - tx_count;
+    if (len > sizeof(pattern) - off)
+        len = sizeof(pattern) - off;
+    memcpy(buf, pattern + off, len);
+    tx_count += len;
+    return len;
+}
+
+/**
+ * @brief  Zero-copy variant of host_read.
+ */
+static const void *host_peek(unsigned int *len)
+{
+    unsigned int off = tx_count % sizeof(pattern);
+    *len = total_size - tx_count;
+    if (*len > sizeof(pattern) - off)
+        *len = sizeof(pattern) - off;
+    return pattern + off;
+}
+
+static void host_consume(unsigned int len)
+{
+    tx_count += len;
+}
+
+/**
+ * @brief  Host side writing interface: verifies the returned pattern.
+ */
+static unsigned int host_write(const void *buf, unsigned int len)
+{
+    const unsigned char *p = buf;
+    unsigned int i;
+    for (i = 0; i < len; i++)
+    {
+        if (p[i] != pattern[(rx_count + i) % sizeof(pattern)])
+            rx_errors++;
+    }
+    __atomic_add_fetch(&rx_count, len, __ATOMIC_RELEASE);
+    return len;
+}
+
+/**
+ * @brief  Loopback modem: everything received is sent back. Everything is queued (the total
+ *         amount is known), so the loopback never stops reading while the host is blocked
+ *         writing, as a UART receiving in the background would.
+ */
+static void *loopback_entry(void *arg)
+{
+    unsigned char *queue = malloc(total_size);
+    struct pollfd pfd = {loop_fd, 0, 0};
+    unsigned int head = 0, tail = 0;
+    ssize_t ret;
+    fcntl(loop_fd, F_SETFL, fcntl(loop_fd, F_GETFL) | O_NONBLOCK);
+    while (looping && queue != NULL)
+    {
+        pfd.events = (head < total_size ? POLLIN : 0) | (head != tail ? POLLOUT : 0);
+        if (poll(&pfd, 1, 100) <= 0)
+            continue;
+        if (pfd.revents & POLLIN)
+        {
+            ret = read(loop_fd, queue + head, total_size - head);
+            if (ret > 0)
+                head += ret;
+        }
+        if (pfd.revents & POLLOUT)
+        {
+            ret = write(loop_fd, queue + tail, head - tail);
+            if (ret > 0)
+                tail += ret;
+        }
+    }
+    free(queue);
+    return NULL;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-s size_kb] [-B bufsize] [-m event|poll] [-z]\n"
+            "  -s  Amount of data sent through the loopback (KB, default 4096)\n"
+            "  -B  Transparent transmission buffer size (default AT_RAW_BUF_SIZE)\n"
+            "  -m  AT thread mode: event (at_obj_process_timed + wait) or poll (10ms)\n"
+            "  -z  Use the zero-copy reading interface (peek/consume)\n",
+            name);
+}
+
+int main(int argc, char *argv[])
+{
+    at_raw_trans_conf_t conf = {.write = host_write, .read = host_read};
+    unsigned long long t0, t1;
+    pthread_t loop_thread;
+    char path[64];
+    struct termios tio;
+    unsigned int i;
+    int opt;
+    total_size = 4096 * 1024;
+    while ((opt = getopt(argc, argv, "s:B:m:zh")) != -1)
+    {
+        switch (opt)
+        {
+        case 's':
+            total_size = strtoul(optarg, NULL, 0) * 1024;
+            break;
+        case 'B':
+            conf.bufsize = strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            event_mode = strcmp(optarg, "poll") != 0;
+            break;
+        case 'z':
+            conf.peek = host_peek;
+            conf.consume = host_consume;
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    for (i = 0; i < sizeof(pattern); i++)
+        pattern[i] = (unsigned char)(i * 7 + i / 256);
+    loop_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (loop_fd < 0 || grantpt(loop_fd) != 0 || unlockpt(loop_fd) != 0 ||
+        ptsname_r(loop_fd, path, sizeof(path)) != 0 || at_linux_open(path, 921600) != 0)
+    {
+        perror("raw_bench");
+        return 1;
+    }
+    // at_linux_open has switched the line to raw mode, the master side has no line discipline.
+    if (tcgetattr(loop_fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(loop_fd, TCSANOW, &tio);
+    }
+    at_obj = bench_obj_create(&adapter);
+    if (at_obj == NULL || !at_raw_transport_enter(at_obj, &conf))
+    {
+        fprintf(stderr, "at_raw_transport_enter failed\n");
+        return 1;
+    }
+    pthread_create(&loop_thread, NULL, loopback_entry, NULL);
+    bench_set_poll(!event_mode);
+    t0 = bench_now_ns();
+    bench_start();
+    while (__atomic_load_n(&rx_count, __ATOMIC_ACQUIRE) < total_size && bench_now_ns() - t0 < 60000000000ull)
+        usleep(1000);
+    t1 = bench_now_ns();
+    at_raw_transport_exit(at_obj);
+    bench_stop();
+    looping = 0;
+    pthread_join(loop_thread, NULL);
+    printf("mode %s%s, buffer %u: %u/%u bytes looped back in %.3f s, %.2f MB/s, %u errors\n",
+           event_mode ? "event" : "poll", conf.peek ? " zero-copy" : "",
+           conf.bufsize ? conf.bufsize : AT_RAW_BUF_SIZE, rx_count, total_size, (t1 - t0) / 1e9,
+           rx_count / ((t1 - t0) / 1e9) / 1e6, rx_errors);
+    bench_close(NULL);
+    close(loop_fd);
+    return rx_count != total_size || rx_errors != 0;
+}
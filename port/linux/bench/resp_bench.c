@@ -0,0 +1,167 @@
+/******************************************************************************
+ * @brief        Long response benchmark against the simulated EC800M
+ *
+ * AT+QFLST (file listing) is answered with 1, 2 and 4 KB of "+QFLST:" lines before the
+ * final OK. The responses arrive in many chunks at the serial rate, each chunk is
+ * matched from where the previous one stopped, so the CPU time of the AT thread per
+ * response byte stays the same as the response grows. The round trip and the CPU time
+ * per byte are reported for each size, the benchmark fails if a response is lost or
+ * truncated.
+ *
+ * Usage: resp_bench [-b baudrate] [-n commands]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const unsigned int sizes[] = {1024, 2048, 4096};
+
+#define SIZE_COUNT (int)(sizeof(sizes) / sizeof(sizes[0]))
+
+static at_obj_t *at_obj;
+static unsigned int done_count, bad_count;
+static const char *last_line;
+
+static const at_adapter_t adapter = {
+    .lock = at_linux_lock,
+    .unlock = at_linux_unlock,
+    .write = at_linux_write,
+    .read = at_linux_read,
+    .notify = at_linux_notify,
+    .recv_bufsize = 4608,
+};
+
+static void on_response(at_response_t *r)
+{
+    if (r->code != AT_RESP_OK || r->dropped != 0 || strncmp(r->prefix, "+QFLST:", 7) != 0 ||
+        memmem(r->recvbuf, r->recvcnt, last_line, strlen(last_line)) == NULL)
+        bad_count++;
+    bench_count(&done_count);
+}
+
+/**
+ * @brief  Build a file listing of about 'size' bytes.
+ * @param  last Last line of the listing (output).
+ */
+static char *build_listing(unsigned int size, char *last)
+{
+    char *resp = malloc(size + 64), line[48];
+    unsigned int len = 2, i = 0;
+    if (resp == NULL)
+        return NULL;
+    strcpy(resp, "\r\n");
+    while (len < size)
+    {
+        sprintf(line, "+QFLST: \"UFS:log_%04u.txt\",%u\r\n", i, 1000 + i * 37);
+        strcpy(resp + len, line);
+        len += strlen(line);
+        strcpy(last, line);
+        i++;
+    }
+    strcpy(resp + len, "\r\nOK\r\n");
+    return resp;
+}
+
+/**
+ * @brief  Run the listing of one size several times.
+ * @return Number of lost or bad responses.
+ */
+static unsigned int run_size(at_sim_t *sim, const char *cmd, unsigned int size, const char *last,
+                             unsigned int count)
+{
+    unsigned long long t0, us = 0, cpu0;
+    at_sim_stat_t st0, st1;
+    at_attr_t attr;
+    unsigned int i;
+    at_attr_deinit(&attr);
+    attr.cb = on_response;
+    attr.prefix = "+QFLST:";
+    attr.timeout = 3000;
+    attr.retry = 0;
+    last_line = last;
+    done_count = bad_count = 0;
+    at_sim_get_stat(sim, &st0);
+    cpu0 = bench_thread_cpu_ns();
+    for (i = 0; i < count; i++)
+    {
+        t0 = bench_now_us();
+        at_exec_cmd(at_obj, &attr, cmd);
+        bench_wait_count(&done_count, i + 1, 5000);
+        us += bench_now_us() - t0;
+    }
+    cpu0 = bench_thread_cpu_ns() - cpu0;
+    at_sim_get_stat(sim, &st1);
+    printf("  %6u %8u %8u %10.2f %12.2f\n", size, done_count, bad_count, us / 1000.0 / count,
+           (double)cpu0 / (st1.tx_bytes - st0.tx_bytes));
+    return (count - done_count) + bad_count;
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {921600, 0, 0, 10, 0, 0};
+    static char last[SIZE_COUNT][48];
+    char *listing[SIZE_COUNT], cmd[SIZE_COUNT][16];
+    unsigned int count = 20, errors = 0;
+    at_sim_t *sim;
+    int opt, i;
+    while ((opt = getopt(argc, argv, "b:n:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            conf.baudrate = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            count = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-b baudrate] [-n commands]\n"
+                    "  -b  Simulated serial rate (default 921600, 0: no pacing)\n"
+                    "  -n  Number of commands of each size (default 20)\n",
+                    argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (count == 0)
+        count = 1;
+    sim = bench_sim_open("resp_bench", &conf);
+    if (sim == NULL)
+        return 1;
+    for (i = 0; i < SIZE_COUNT; i++)
+    {
+        listing[i] = build_listing(sizes[i], last[i]);
+        if (listing[i] == NULL)
+            return 1;
+        sprintf(cmd[i], "AT+QFLST=%d", i);
+        at_sim_add_rule(sim, cmd[i], listing[i]);
+    }
+    at_obj = bench_obj_create(&adapter);
+    if (at_obj == NULL)
+        return 1;
+    // Static timeouts: the sizes share the command name, the long listings would be cut at
+    // the response time learned from the short ones.
+    at_obj_set_rto(at_obj, 0, 0);
+    bench_start();
+
+    printf("%u commands of each size, %u baud\n", count, conf.baudrate);
+    printf("  %6s %8s %8s %10s %12s\n", "bytes", "done", "bad", "avg ms", "cpu ns/byte");
+    for (i = 0; i < SIZE_COUNT; i++)
+        errors += run_size(sim, cmd[i], sizes[i], last[i], count);
+    errors += bench_check_pools();
+    printf("%s\n", errors != 0 ? "FAILED" : "ok");
+
+    bench_stop();
+    bench_close(sim);
+    for (i = 0; i < SIZE_COUNT; i++)
+        free(listing[i]);
+    return errors != 0;
+}
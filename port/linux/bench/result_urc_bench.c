@@ -0,0 +1,183 @@
+/******************************************************************************
+ * @brief        Result URC benchmark against the simulated EC800M
+ *
+ * AT+QMTOPEN answers OK at once and reports the result later with "+QMTOPEN: 0,0", the
+ * modem rejects AT+QMTCONN until then. The open/connect sequence is run as plain
+ * commands submitted back to back (the command completes on OK) and with the result
+ * URC of the commands (at_attr_t.urc, AT+QMTCONN submitted from the callback of
+ * AT+QMTOPEN). The successful connections and the time per connection are compared.
+ * It then checks a result URC arriving with the response, a URC timeout (the command
+ * is not resent), the URC of a blocking command and the pools.
+ *
+ * Usage: result_urc_bench [-n connections] [-r result_delay_ms]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static at_obj_t *at_obj;
+static volatile int done;            /* 1: connected, -1: failed, 0: running*/
+
+/**
+ * @brief  Plain commands: the open completes on OK, only the connect result is known.
+ */
+static void plain_conn_callback(at_response_t *r)
+{
+    done = r->code == AT_RESP_OK ? 1 : -1;
+}
+
+static void urc_conn_callback(at_response_t *r)
+{
+    int client, result;
+    done = r->code == AT_RESP_OK && sscanf(r->urc, "+QMTCONN: %d,%d", &client, &result) == 2 &&
+           result == 0 ? 1 : -1;
+}
+
+/**
+ * @brief  The network is open ("+QMTOPEN: 0,0"), connect.
+ */
+static void urc_open_callback(at_response_t *r)
+{
+    int client, result;
+    at_attr_t attr;
+    if (r->code != AT_RESP_OK || sscanf(r->urc, "+QMTOPEN: %d,%d", &client, &result) != 2 || result != 0)
+    {
+        done = -1;
+        return;
+    }
+    at_attr_deinit(&attr);
+    attr.urc = "+QMTCONN: 0,";
+    attr.urc_timeout = 2000;
+    attr.cb = urc_conn_callback;
+    if (!at_exec_cmd(r->obj, &attr, "AT+QMTCONN=0,\"ec800m\""))
+        done = -1;
+}
+
+/**
+ * @brief  Open the network and connect several times, print the connections and the time.
+ */
+static void run_connect(unsigned int count, int urc)
+{
+    unsigned long long t0, us, sum = 0;
+    unsigned int i, ok = 0;
+    at_attr_t attr;
+    for (i = 0; i < count; i++)
+    {
+        done = 0;
+        t0 = bench_now_us();
+        at_attr_deinit(&attr);
+        attr.retry = 0;
+        if (urc)
+        {
+            attr.urc = "+QMTOPEN: 0,";
+            attr.urc_timeout = 2000;
+            attr.cb = urc_open_callback;
+            at_exec_cmd(at_obj, &attr, "AT+QMTOPEN=0,\"iot.example.com\",1883");
+        }
+        else
+        {
+            at_exec_cmd(at_obj, &attr, "AT+QMTOPEN=0,\"iot.example.com\",1883");
+            attr.cb = plain_conn_callback;
+            at_exec_cmd(at_obj, &attr, "AT+QMTCONN=0,\"ec800m\"");
+        }
+        while (done == 0)
+            usleep(200);
+        us = bench_now_us() - t0;
+        sum += us;
+        ok += done == 1;
+        usleep(200000); // Let the late result URCs arrive.
+    }
+    printf("  %-10s %8u %8u %10.2f\n", urc ? "result urc" : "plain", ok, count - ok, sum / 1000.0 / count);
+}
+
+/**
+ * @brief  Corner cases of the result URC, returns the number of failed checks.
+ */
+static int run_checks(at_sim_t *sim)
+{
+    at_sim_stat_t st0, st1;
+    at_sync_resp_t resp;
+    at_resp_code code;
+    at_attr_t attr;
+    char buf[96];
+    int errors = 0;
+    at_attr_deinit(&attr);
+    attr.urc = "+QMTSUB: 0,";
+    attr.urc_timeout = 300;
+    // The result URC comes in the same burst as the response.
+    at_sim_add_rule(sim, "AT+QMTSUB=0,1,", "\r\nOK\r\n\r\n+QMTSUB: 0,1,0,0\r\n");
+    at_sync_resp_init(&resp, buf, sizeof(buf), AT_WAIT_FOREVER);
+    code = at_exec_cmd_sync(at_obj, &attr, &resp, "AT+QMTSUB=0,1,\"cmd\",1");
+    printf("  same burst      : %d, urc '%.16s' (expected %d, +QMTSUB: 0,1,0,0)\n", code,
+           resp.urc != NULL ? resp.urc : "", AT_RESP_OK);
+    errors += code != AT_RESP_OK || resp.urc == NULL || strncmp(resp.urc, "+QMTSUB: 0,1,0,0", 16) != 0;
+    // The URC never comes: timeout after urc_timeout, without a resend.
+    at_sim_add_rule(sim, "AT+QMTSUB=0,2,", "\r\nOK\r\n");
+    at_sim_get_stat(sim, &st0);
+    code = at_exec_cmd_sync(at_obj, &attr, &resp, "AT+QMTSUB=0,2,\"cmd\",1");
+    at_sim_get_stat(sim, &st1);
+    printf("  no urc          : %d, %lu sent (expected %d, 1 sent)\n", code, st1.commands - st0.commands,
+           AT_RESP_TIMEOUT);
+    errors += code != AT_RESP_TIMEOUT || st1.commands - st0.commands != 1;
+    // The command fails: no URC is waited for.
+    at_sim_add_rule(sim, "AT+QMTSUB=0,3,", "\r\n+CME ERROR: 30\r\n");
+    attr.retry = 0;
+    code = at_exec_cmd_sync(at_obj, &attr, &resp, "AT+QMTSUB=0,3,\"cmd\",1");
+    printf("  error           : %d, error %d (expected %d, error 30)\n", code, resp.error, AT_RESP_ERROR);
+    errors += code != AT_RESP_ERROR || resp.error != 30 || resp.urc != NULL;
+    return errors + bench_check_pools();
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {115200, 2000, 0, 50, 0, 0};
+    unsigned int count = 10;
+    at_sim_t *sim;
+    int opt, errors;
+    while ((opt = getopt(argc, argv, "n:r:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            count = strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            conf.result_delay_ms = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-n connections] [-r result_delay_ms]\n"
+                    "  -n  Number of connections of each run (default 10)\n"
+                    "  -r  Delay of the result URCs (default 50)\n",
+                    argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    sim = bench_sim_open("result_urc_bench", &conf);
+    if (sim == NULL)
+        return 1;
+    at_obj = bench_obj_create(NULL);
+    if (at_obj == NULL)
+        return 1;
+    bench_start();
+
+    printf("%u connections, result URC delay %u ms\n", count, conf.result_delay_ms);
+    printf("  %-10s %8s %8s %10s\n", "commands", "ok", "failed", "avg ms");
+    run_connect(count, 0);
+    run_connect(count, 1);
+    printf("checks:\n");
+    errors = run_checks(sim);
+    printf("%s\n", errors != 0 ? "FAILED" : "ok");
+
+    bench_stop();
+    bench_close(sim);
+    return errors != 0;
+}
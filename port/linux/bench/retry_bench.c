@@ -0,0 +1,148 @@
+/******************************************************************************
+ * @brief        Retry policy benchmark against the simulated EC800M
+ *
+ * Three failure scenarios are run without a retry policy and with the exponential
+ * backoff policy (at_retry_backoff, limited to 2 s per command):
+ *   sim    - AT+CGATT=1 answers "+CME ERROR: 10" (SIM not inserted, not retryable)
+ *   outage - AT+QIACT=1 is never answered (network outage)
+ *   flaky  - AT+CSQ, 30% of the commands are never answered
+ * The commands received by the modem, the bytes written to the UART and the time
+ * spent per command are compared. The benchmark fails if the backoff policy resends
+ * the command that is not retryable.
+ *
+ * Usage: retry_bench [-n commands] [-r retries]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Failure scenario, 'retryable' is 0 when the policy must not resend the command.
+ */
+typedef struct
+{
+    const char *name;
+    const char *cmd;
+    unsigned int timeout;
+    int retryable;
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    {"sim", "AT+CGATT=1", 500, 0},
+    {"outage", "AT+QIACT=1", 300, 1},
+    {"flaky", "AT+CSQ", 300, 1},
+};
+
+#define SCENARIO_COUNT (int)(sizeof(scenarios) / sizeof(scenarios[0]))
+
+static at_obj_t *at_obj;
+static volatile int done;
+static unsigned int failures, cme_errors;
+
+static void on_response(at_response_t *r)
+{
+    if (r->code != AT_RESP_OK)
+        failures++;
+    if (r->error >= 0)
+        cme_errors++;
+    done = 1;
+}
+
+/**
+ * @brief  Run the command of a scenario several times, one after the other.
+ * @return 1 if the policy resent a command that is not retryable.
+ */
+static int run_scenario(at_sim_t *sim, const scenario_t *sc, const at_retry_policy_t *policy,
+                         unsigned int count, unsigned int retries)
+{
+    unsigned long long t0;
+    at_sim_stat_t st0, st1;
+    at_attr_t attr;
+    unsigned int i;
+    at_attr_deinit(&attr);
+    attr.cb = on_response;
+    attr.timeout = sc->timeout;
+    attr.retry = retries;
+    attr.policy = policy;
+    failures = cme_errors = 0;
+    at_sim_get_stat(sim, &st0);
+    t0 = bench_now_us();
+    for (i = 0; i < count; i++)
+    {
+        done = 0;
+        if (!at_exec_cmd(at_obj, &attr, sc->cmd))
+            continue;
+        while (!done)
+            usleep(200);
+    }
+    t0 = bench_now_us() - t0;
+    usleep(300000); // Let late responses arrive before the next run.
+    at_sim_get_stat(sim, &st1);
+    printf("  %-8s %-8s %8lu %8lu %8u %6u %7.1f ms\n", sc->name, policy != NULL ? "backoff" : "none",
+           st1.commands - st0.commands, st1.rx_bytes - st0.rx_bytes, failures, cme_errors,
+           t0 / 1000.0 / count);
+    return policy != NULL && !sc->retryable && (st1.commands - st0.commands != count || cme_errors != count);
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {115200, 5000, 0, 10, 0, 0};
+    at_retry_policy_t policy = at_retry_backoff;
+    unsigned int count = 20, retries = 5;
+    at_sim_t *sim;
+    int opt, i, errors = 0;
+    while ((opt = getopt(argc, argv, "n:r:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            count = strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            retries = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-n commands] [-r retries]\n"
+                    "  -n  Number of commands of each run (default 20)\n"
+                    "  -r  Resends allowed per command (default 5)\n",
+                    argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    sim = bench_sim_open("retry_bench", &conf);
+    if (sim == NULL)
+        return 1;
+    at_sim_add_rule(sim, "AT+CGATT=1", "\r\n+CME ERROR: 10\r\n");
+    at_sim_set_latency(sim, "AT+QIACT=1", 5000, 0, 1000);
+    at_sim_set_latency(sim, "AT+CSQ", 5000, 5000, 300);
+    at_obj = bench_obj_create(NULL);
+    if (at_obj == NULL)
+        return 1;
+    at_obj_set_rto(at_obj, 0, 0); // Static timeouts, only the retry policy differs.
+    bench_start();
+
+    policy.max_elapsed = 2000;
+    printf("%u commands per run, up to %u resends\n", count, retries);
+    printf("  %-8s %-8s %8s %8s %8s %6s %10s\n", "scenario", "policy", "sent", "bytes", "failures",
+           "cme", "avg time");
+    for (i = 0; i < SCENARIO_COUNT; i++)
+    {
+        run_scenario(sim, &scenarios[i], NULL, count, retries);
+        errors += run_scenario(sim, &scenarios[i], &policy, count, retries);
+    }
+    errors += bench_check_pools();
+    printf("%s\n", errors != 0 ? "FAILED" : "ok");
+
+    bench_stop();
+    bench_close(sim);
+    return errors != 0;
+}
@@ -0,0 +1,181 @@
+/******************************************************************************
+ * @brief        Adaptive timeout benchmark against the simulated EC800M
+ *
+ * Three command classes with their own latency distribution are run in rounds:
+ *   slow   - AT+CIMI   350 ~ 650 ms (often longer than the 500 ms default timeout)
+ *   medium - AT+CGATT? 50 ~ 100 ms
+ *   lossy  - AT+CSQ    5 ~ 15 ms, 10% of the commands are never answered
+ * The load is run with the static timeouts and with the adaptive ones, the resends,
+ * the commands received by the modem and the time spent per class are compared.
+ * The benchmark fails if a response is taken by the wrong command with the adaptive
+ * timeouts.
+ *
+ * Usage: rto_bench [-n rounds]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Command class.
+ */
+typedef struct
+{
+    const char *name;
+    const char *cmd;
+    const char *prefix;
+    unsigned int delay_us, jitter_us, drop_permille;
+    unsigned int failures, bad;
+    unsigned long long busy_us; /* Total submission -> completion time*/
+} cmd_class_t;
+
+static cmd_class_t classes[] = {
+    {"slow", "AT+CIMI", NULL, 350000, 300000, 0, 0, 0, 0},
+    {"medium", "AT+CGATT?", "+CGATT:", 50000, 50000, 0, 0, 0, 0},
+    {"lossy", "AT+CSQ", "+CSQ:", 5000, 10000, 100, 0, 0, 0},
+};
+
+#define CLASS_COUNT (int)(sizeof(classes) / sizeof(classes[0]))
+
+static at_obj_t *at_obj;
+static volatile int done;
+static unsigned long long submit_us;
+
+static void on_response(at_response_t *r)
+{
+    cmd_class_t *c = r->params;
+    c->busy_us += bench_now_us() - submit_us;
+    if (r->code != AT_RESP_OK)
+        c->failures++;
+    else if (c->prefix != NULL && strncmp(r->prefix, c->prefix, strlen(c->prefix)) != 0)
+        c->bad++; // A late response of another command was taken.
+    else if (c->prefix == NULL && strstr(r->recvbuf, "460") == NULL)
+        c->bad++;
+    done = 1;
+}
+
+/**
+ * @brief  Run the commands of every class one after the other, for some rounds.
+ */
+static void run_load(unsigned int rounds)
+{
+    at_attr_t attr;
+    unsigned int i;
+    int c;
+    at_attr_deinit(&attr);
+    attr.cb = on_response;
+    for (i = 0; i < rounds; i++)
+    {
+        for (c = 0; c < CLASS_COUNT; c++)
+        {
+            attr.params = &classes[c];
+            attr.prefix = classes[c].prefix;
+            done = 0;
+            submit_us = bench_now_us();
+            if (!at_exec_cmd(at_obj, &attr, classes[c].cmd))
+                continue;
+            while (!done)
+                usleep(200);
+        }
+    }
+    usleep(800000); // Let late responses arrive before the next run.
+}
+
+/**
+ * @brief  Print the result of a run and reset the counters of the classes.
+ * @return Number of responses taken by the wrong command.
+ */
+static unsigned int print_result(const char *title, at_sim_t *sim, const at_sim_stat_t *st0, unsigned int rounds)
+{
+    unsigned int wrong = 0;
+    at_cmd_stats_t st;
+    at_sim_stat_t st1;
+    int i, c;
+    at_sim_get_stat(sim, &st1);
+    printf("%s: %u commands, %lu received by the modem (%lu unanswered)\n", title, rounds * CLASS_COUNT,
+           st1.commands - st0->commands, st1.dropped - st0->dropped);
+    printf("  %-8s %-10s %7s %8s %8s %7s %10s\n", "class", "command", "resends", "timeouts", "failures",
+           "wrong", "avg time");
+    for (c = 0; c < CLASS_COUNT; c++)
+    {
+        for (i = 0; at_obj_get_stats(at_obj, i, &st); i++)
+        {
+            if (strncmp(classes[c].cmd, st.name, strlen(st.name)) == 0)
+                break;
+        }
+        printf("  %-8s %-10s %7u %8u %8u %7u %7.1f ms\n", classes[c].name, classes[c].cmd, st.retries,
+               st.timeouts, classes[c].failures, classes[c].bad, classes[c].busy_us / 1000.0 / rounds);
+        wrong += classes[c].bad;
+        classes[c].failures = classes[c].bad = 0;
+        classes[c].busy_us = 0;
+    }
+    return wrong;
+}
+
+static void print_rto(void)
+{
+    at_rto_info_t info;
+    int i;
+    printf("  %-10s %8s %8s %8s %8s %8s\n", "command", "srtt", "rttvar", "rto", "samples", "backoffs");
+    for (i = 0; at_obj_get_rto(at_obj, i, &info); i++)
+        printf("  %-10s %5u ms %5u ms %5u ms %8u %8u\n", info.name, info.srtt, info.rttvar, info.rto,
+               info.samples, info.backoffs);
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {115200, 0, 0, 10, 0, 0};
+    unsigned int rounds = 30, errors;
+    at_sim_stat_t st0;
+    at_sim_t *sim;
+    int opt, c;
+    while ((opt = getopt(argc, argv, "n:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            rounds = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n rounds]\n  -n  Number of rounds of each run (default 30)\n",
+                    argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    sim = bench_sim_open("rto_bench", &conf);
+    if (sim == NULL)
+        return 1;
+    for (c = 0; c < CLASS_COUNT; c++)
+        at_sim_set_latency(sim, classes[c].cmd, classes[c].delay_us, classes[c].jitter_us,
+                           classes[c].drop_permille);
+    at_obj = bench_obj_create(NULL);
+    if (at_obj == NULL)
+        return 1;
+    bench_start();
+
+    at_obj_set_rto(at_obj, 0, 0);
+    at_sim_get_stat(sim, &st0);
+    run_load(rounds);
+    print_result("static timeouts", sim, &st0, rounds);
+
+    at_obj_stats_reset(at_obj);
+    at_obj_set_rto(at_obj, AT_RTO_MIN, AT_RTO_MAX);
+    at_sim_get_stat(sim, &st0);
+    run_load(rounds);
+    errors = print_result("adaptive timeouts", sim, &st0, rounds);
+    print_rto();
+    errors += bench_check_pools();
+    printf("%s\n", errors != 0 ? "FAILED" : "ok");
+
+    bench_stop();
+    bench_close(sim);
+    return errors != 0;
+}
@@ -0,0 +1,186 @@
+/******************************************************************************
+ * @brief        Work scheduler benchmark against the simulated EC800M
+ *
+ * A mixed load is run twice, with strict priorities and with priority aging:
+ *   alarm  - AT+CREG?  highest level, always kept queued (saturates the modem)
+ *   poll   - AT+CSQ    level 1, every 20 ms
+ *   urgent - AT+CGATT? level 1 with a 20 ms deadline, every 20 ms
+ *   bulk   - AT+CIMI   lowest level, every 50 ms
+ * The queue wait of each class is reported from the command statistics. The benchmark
+ * fails if a command fails or if a class is starved with priority aging.
+ *
+ * Usage: sched_bench [-t duration_ms] [-a aging_ms] [-d delay_us]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Load class.
+ */
+typedef struct
+{
+    const char *name;
+    const char *cmd;
+    const char *prefix;
+    at_cmd_priority priority;
+    unsigned short deadline;
+    unsigned int period_ms;  /* Submission period, 0: kept queued*/
+    unsigned int max_queued; /* Maximum outstanding commands*/
+    volatile unsigned int queued;
+    unsigned long long next;
+} load_class_t;
+
+static load_class_t classes[] = {
+    {"alarm", "AT+CREG?", "+CREG:", AT_PRIORITY_HIGH, 0, 0, 3, 0, 0},
+    {"poll", "AT+CSQ", "+CSQ:", 1, 0, 20, 4, 0, 0},
+    {"urgent", "AT+CGATT?", "+CGATT:", 1, 20, 20, 4, 0, 0},
+    {"bulk", "AT+CIMI", NULL, AT_PRIORITY_LOW, 0, 50, 4, 0, 0},
+};
+
+#define CLASS_COUNT (int)(sizeof(classes) / sizeof(classes[0]))
+
+static at_obj_t *at_obj;
+static unsigned int failures;
+
+static void on_response(at_response_t *r)
+{
+    load_class_t *c = r->params;
+    if (r->code != AT_RESP_OK)
+        failures++;
+    __atomic_sub_fetch(&c->queued, 1, __ATOMIC_RELAXED);
+}
+
+static bool submit(load_class_t *c)
+{
+    at_attr_t attr;
+    at_attr_deinit(&attr);
+    attr.cb = on_response;
+    attr.params = c;
+    attr.prefix = c->prefix;
+    attr.priority = c->priority;
+    attr.deadline = c->deadline;
+    attr.timeout = 5000;
+    attr.retry = 0;
+    __atomic_add_fetch(&c->queued, 1, __ATOMIC_RELAXED);
+    if (at_exec_cmd(at_obj, &attr, c->cmd))
+        return true;
+    __atomic_sub_fetch(&c->queued, 1, __ATOMIC_RELAXED);
+    return false;
+}
+
+/**
+ * @brief  Run the mixed load, then wait until the queues are drained.
+ */
+static void run_load(unsigned int duration_ms)
+{
+    unsigned long long start = bench_now_us() / 1000, now;
+    int i;
+    for (i = 0; i < CLASS_COUNT; i++)
+        classes[i].next = start;
+    while ((now = bench_now_us() / 1000) - start < duration_ms)
+    {
+        for (i = 0; i < CLASS_COUNT; i++)
+        {
+            load_class_t *c = &classes[i];
+            if (c->queued >= c->max_queued || now < c->next)
+                continue;
+            if (submit(c) && c->period_ms != 0)
+                c->next += c->period_ms;
+        }
+        usleep(500);
+    }
+    bench_wait_idle();
+}
+
+/**
+ * @brief  Print the queue wait of each class.
+ * @return Number of classes that completed no command.
+ */
+static int print_stats(void)
+{
+    at_cmd_stats_t st;
+    int i, j, starved = CLASS_COUNT;
+    printf("  %-8s %-10s %5s %6s %10s %10s %10s\n", "class", "command", "level", "count",
+           "queue p50", "queue p99", "queue max");
+    for (i = 0; at_obj_get_stats(at_obj, i, &st); i++)
+    {
+        for (j = 0; j < CLASS_COUNT && strncmp(classes[j].cmd, st.name, strlen(st.name)) != 0; j++)
+            ;
+        printf("  %-8s %-10s %5d %6u %7u ms %7u ms %7u ms\n", j < CLASS_COUNT ? classes[j].name : "?",
+               st.name, j < CLASS_COUNT ? (int)classes[j].priority : -1, st.count,
+               at_obj_stats_percentile(at_obj, i, AT_STATS_QUEUE, 50),
+               at_obj_stats_percentile(at_obj, i, AT_STATS_QUEUE, 99), st.max[AT_STATS_QUEUE]);
+        starved -= j < CLASS_COUNT && st.count != 0;
+    }
+    return starved;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-t duration_ms] [-a aging_ms] [-d delay_us]\n"
+            "  -t  Duration of the load of each run (default 3000)\n"
+            "  -a  Priority aging interval of the second run (default 200)\n"
+            "  -d  Simulated response latency of every command (default 2000)\n",
+            name);
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {115200, 2000, 0, 10, 0, 0};
+    unsigned int duration = 3000, aging = 200;
+    at_sim_t *sim;
+    int opt, errors;
+    while ((opt = getopt(argc, argv, "t:a:d:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            duration = strtoul(optarg, NULL, 0);
+            break;
+        case 'a':
+            aging = strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            conf.resp_delay_us = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    sim = bench_sim_open("sched_bench", &conf);
+    if (sim == NULL)
+        return 1;
+    at_obj = bench_obj_create(NULL);
+    if (at_obj == NULL)
+        return 1;
+    bench_start();
+
+    printf("strict priorities, %u ms:\n", duration);
+    at_obj_set_aging(at_obj, 0);
+    run_load(duration);
+    print_stats();
+
+    printf("aging %u ms, %u ms:\n", aging, duration);
+    at_obj_stats_reset(at_obj);
+    at_obj_set_aging(at_obj, aging);
+    run_load(duration);
+    errors = print_stats();
+    printf("failures: %u\n", failures);
+    errors += failures + bench_check_pools();
+    printf("%s\n", errors != 0 ? "FAILED" : "ok");
+
+    bench_stop();
+    bench_close(sim);
+    return errors != 0;
+}
@@ -0,0 +1,195 @@
+/******************************************************************************
+ * @brief        Multi-producer submission stress test against the simulated EC800M
+ *
+ * Several producer threads submit commands to the same AT object as fast as the
+ * queue accepts them, while the AT thread runs them (optionally with another thread
+ * aborting the queued work periodically). It checks that every command of a producer
+ * completes at most once and in submission order, that nothing is left queued or
+ * allocated at the end, and reports the submission latency and the throughput.
+ *
+ * Usage: submit_bench [-p producers] [-n commands] [-a abort_interval_ms]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_PRODUCERS 16
+
+/**
+ * @brief Producer state.
+ */
+typedef struct
+{
+    pthread_t thread;
+    int id;
+    unsigned int submitted, full;     /* Accepted submissions, rejections (queue full)*/
+    unsigned long long submit_ns;     /* Total time spent in at_exec_cmd*/
+    unsigned long long submit_max_ns;
+    /* Written by the AT thread*/
+    unsigned int done, failed, disorder, last;
+} producer_t;
+
+static producer_t producers[MAX_PRODUCERS];
+static int producer_count = 4;
+static unsigned int commands = 2000;
+static unsigned int abort_interval;
+static at_obj_t *at_obj;
+static volatile int producing = 1;
+
+/**
+ * @brief  The parameter of a command encodes its producer and its sequence number.
+ */
+static void on_response(at_response_t *r)
+{
+    uintptr_t tag = (uintptr_t)r->params;
+    producer_t *p = &producers[tag >> 24];
+    unsigned int seq = tag & 0xFFFFFF;
+    if (r->code != AT_RESP_OK)
+        p->failed++;
+    if (seq <= p->last && p->done != 0)
+        p->disorder++;
+    p->last = seq;
+    p->done++;
+}
+
+static void *producer_entry(void *arg)
+{
+    producer_t *p = arg;
+    unsigned long long t0, ns;
+    at_attr_t attr;
+    unsigned int i;
+    at_attr_deinit(&attr);
+    attr.cb = on_response;
+    attr.prefix = "+CSQ:";
+    attr.timeout = 1000;
+    for (i = 1; i <= commands; i++)
+    {
+        attr.params = (void *)(((uintptr_t)p->id << 24) | i);
+        for (;;)
+        {
+            t0 = bench_now_ns();
+            if (at_exec_cmd(at_obj, &attr, "AT+CSQ"))
+                break;
+            p->full++;
+            sched_yield();
+        }
+        ns = bench_now_ns() - t0;
+        p->submit_ns += ns;
+        if (ns > p->submit_max_ns)
+            p->submit_max_ns = ns;
+        p->submitted++;
+    }
+    return NULL;
+}
+
+static void *abort_entry(void *arg)
+{
+    unsigned int *count = arg;
+    while (producing)
+    {
+        usleep(abort_interval * 1000);
+        at_work_abort_all(at_obj);
+        (*count)++;
+    }
+    return NULL;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-p producers] [-n commands] [-a abort_interval_ms]\n"
+            "  -p  Number of producer threads (default 4, up to 16)\n"
+            "  -n  Commands submitted by each producer (default 2000)\n"
+            "  -a  Abort all the queued work at this interval (default 0: never)\n",
+            name);
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {0, 0, 0, 10, 0, 0};
+    unsigned int done = 0, failed = 0, disorder = 0, full = 0, submitted = 0, aborts = 0;
+    unsigned long long t0, t1, submit_ns = 0, submit_max_ns = 0;
+    pthread_t abort_thread;
+    unsigned int leaks;
+    at_sim_t *sim;
+    int opt, i;
+    while ((opt = getopt(argc, argv, "p:n:a:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            producer_count = atoi(optarg);
+            if (producer_count < 1 || producer_count > MAX_PRODUCERS)
+                producer_count = 4;
+            break;
+        case 'n':
+            commands = strtoul(optarg, NULL, 0);
+            break;
+        case 'a':
+            abort_interval = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    sim = bench_sim_open("submit_bench", &conf);
+    if (sim == NULL)
+        return 1;
+    at_obj = bench_obj_create(NULL);
+    if (at_obj == NULL)
+        return 1;
+    bench_start();
+
+    t0 = bench_now_ns();
+    for (i = 0; i < producer_count; i++)
+    {
+        producers[i].id = i;
+        pthread_create(&producers[i].thread, NULL, producer_entry, &producers[i]);
+    }
+    if (abort_interval != 0)
+        pthread_create(&abort_thread, NULL, abort_entry, &aborts);
+    for (i = 0; i < producer_count; i++)
+        pthread_join(producers[i].thread, NULL);
+    producing = 0;
+    if (abort_interval != 0)
+        pthread_join(abort_thread, NULL);
+    bench_wait_idle();
+    t1 = bench_now_ns();
+
+    for (i = 0; i < producer_count; i++)
+    {
+        producer_t *p = &producers[i];
+        submitted += p->submitted;
+        full += p->full;
+        done += p->done;
+        failed += p->failed;
+        disorder += p->disorder;
+        submit_ns += p->submit_ns;
+        if (p->submit_max_ns > submit_max_ns)
+            submit_max_ns = p->submit_max_ns;
+    }
+    printf("%d producers x %u commands, %u aborts\n", producer_count, commands, aborts);
+    printf("submitted  : %u (%u rejected, queue full)\n", submitted, full);
+    printf("completed  : %u (%u failed, %u aborted, %u out of order)\n", done, failed, submitted - done,
+           disorder);
+    printf("submission : avg %.2f us, max %.1f us\n", submitted ? submit_ns / 1e3 / submitted : 0,
+           submit_max_ns / 1e3);
+    printf("throughput : %.0f cmds/s\n", done * 1e9 / (t1 - t0));
+    leaks = bench_check_pools();
+
+    bench_stop();
+    bench_close(sim);
+    return disorder != 0 || leaks != 0 || (abort_interval == 0 && done != submitted) ? 1 : 0;
+}
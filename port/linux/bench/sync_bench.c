@@ -0,0 +1,192 @@
+/******************************************************************************
+ * @brief        Blocking command benchmark against the simulated EC800M
+ *
+ * A caller thread runs commands one after the other and waits for each result, by
+ * polling the work context (at_work_is_finish, sleeping for the poll interval between
+ * checks) and with at_exec_cmd_sync. The time from submission to the return of the
+ * result and the CPU time of the caller are compared. It then checks the corner cases
+ * of the blocking interfaces: a wait shorter than the command (the abandoned work is
+ * released by the AT thread), at_work_abort_all and a command answered by an error.
+ *
+ * Usage: sync_bench [-n commands] [-p poll_interval_ms] [-d delay_us]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static at_obj_t *at_obj;
+
+static unsigned long long clock_us(clockid_t id)
+{
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief  Run the commands and print the latency and the CPU time of the caller.
+ * @param  poll Poll interval (ms), 0 for the blocking interface.
+ */
+static void run_load(unsigned int count, unsigned int poll)
+{
+    unsigned long long t0, cpu0, us, sum = 0, max = 0;
+    unsigned int i, failures = 0, bad = 0;
+    char buf[64];
+    at_context_t ctx;
+    at_sync_resp_t resp;
+    at_attr_t attr;
+    at_attr_deinit(&attr);
+    attr.prefix = "+CSQ:";
+    attr.timeout = 1000;
+    cpu0 = clock_us(CLOCK_THREAD_CPUTIME_ID);
+    for (i = 0; i < count; i++)
+    {
+        t0 = clock_us(CLOCK_MONOTONIC);
+        if (poll == 0)
+        {
+            at_sync_resp_init(&resp, buf, sizeof(buf), AT_WAIT_FOREVER);
+            if (at_exec_cmd_sync(at_obj, &attr, &resp, "AT+CSQ") != AT_RESP_OK)
+                failures++;
+            else if (resp.prefix == NULL || strncmp(resp.prefix, "+CSQ:", 5) != 0)
+                bad++;
+        }
+        else
+        {
+            at_context_init(&ctx, buf, sizeof(buf));
+            at_context_attach(&attr, &ctx);
+            if (!at_exec_cmd(at_obj, &attr, "AT+CSQ"))
+                continue;
+            while (!at_work_is_finish(&ctx))
+                usleep(poll * 1000);
+            if (at_work_get_result(&ctx) != AT_RESP_OK)
+                failures++;
+            else if (strstr(buf, "+CSQ:") == NULL)
+                bad++;
+            attr.ctx = NULL;
+        }
+        us = clock_us(CLOCK_MONOTONIC) - t0;
+        sum += us;
+        if (us > max)
+            max = us;
+    }
+    printf("  %-12s %8u %8u %10.2f %10.2f %12.1f\n", poll != 0 ? "poll" : "sync", failures, bad,
+           sum / 1000.0 / count, max / 1000.0, (clock_us(CLOCK_THREAD_CPUTIME_ID) - cpu0) / (double)count);
+}
+
+static void *abort_entry(void *arg)
+{
+    usleep(50000);
+    at_work_abort_all(at_obj);
+    return NULL;
+}
+
+/**
+ * @brief  Corner cases of the blocking interfaces, returns the number of failed checks.
+ */
+static int run_checks(at_sim_t *sim)
+{
+    static const char *const lines[] = {"AT+CSQ", "AT+CGATT=1", NULL};
+    at_sync_resp_t resp;
+    at_resp_code code;
+    pthread_t thread;
+    at_attr_t attr;
+    char buf[64];
+    int errors = 0;
+    at_attr_deinit(&attr);
+    attr.retry = 0;
+    // The modem answers after 300 ms, the caller gives up after 50 ms.
+    at_sync_resp_init(&resp, buf, sizeof(buf), 50);
+    code = at_exec_cmd_sync(at_obj, &attr, &resp, "AT+CGACT=1,1");
+    printf("  wait 50 ms      : %d (expected %d)\n", code, AT_RESP_TIMEOUT);
+    errors += code != AT_RESP_TIMEOUT;
+    // Queued behind it and abandoned before it starts: it is dropped.
+    code = at_exec_cmd_sync(at_obj, &attr, &resp, "AT+CGACT=1,1");
+    printf("  wait 50 ms      : %d (expected %d)\n", code, AT_RESP_TIMEOUT);
+    errors += code != AT_RESP_TIMEOUT;
+    // Another thread aborts the work while the command is queued behind a running one.
+    at_exec_cmd(at_obj, &attr, "AT+CGACT=1,1");
+    pthread_create(&thread, NULL, abort_entry, NULL);
+    at_sync_resp_init(&resp, buf, sizeof(buf), AT_WAIT_FOREVER);
+    code = at_exec_cmd_sync(at_obj, &attr, &resp, "AT+CGACT=1,1");
+    pthread_join(thread, NULL);
+    printf("  abort           : %d (expected %d)\n", code, AT_RESP_ABORT);
+    errors += code != AT_RESP_ABORT;
+    bench_wait_idle();
+    usleep(400000); // Let the late responses arrive.
+    // A failed line of a multiline command is skipped by default.
+    at_sync_resp_init(&resp, buf, sizeof(buf), AT_WAIT_FOREVER);
+    code = at_send_multiline_sync(at_obj, &attr, &resp, (const char **)lines);
+    printf("  skipped line    : %d (expected %d)\n", code, AT_RESP_OK);
+    errors += code != AT_RESP_OK;
+    // Error code of a failed line of a multiline command that stops on it.
+    at_sync_resp_init(&resp, buf, sizeof(buf), AT_WAIT_FOREVER);
+    attr.stop_on_error = 1;
+    code = at_send_multiline_sync(at_obj, &attr, &resp, (const char **)lines);
+    printf("  +CME ERROR      : %d, error %d (expected %d, error 10)\n", code, resp.error, AT_RESP_ERROR);
+    errors += code != AT_RESP_ERROR || resp.error != 10;
+    return errors + bench_check_pools();
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {115200, 2000, 0, 10, 0, 0};
+    unsigned int count = 200, poll = 10;
+    at_sim_t *sim;
+    int opt, errors;
+    while ((opt = getopt(argc, argv, "n:p:d:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            count = strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            poll = strtoul(optarg, NULL, 0);
+            if (poll == 0)
+                poll = 1;
+            break;
+        case 'd':
+            conf.resp_delay_us = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-n commands] [-p poll_interval_ms] [-d delay_us]\n"
+                    "  -n  Number of commands of each run (default 200)\n"
+                    "  -p  Poll interval of the work context (default 10)\n"
+                    "  -d  Simulated response latency (default 2000)\n",
+                    argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    sim = bench_sim_open("sync_bench", &conf);
+    if (sim == NULL)
+        return 1;
+    at_sim_add_rule(sim, "AT+CGATT=1", "\r\n+CME ERROR: 10\r\n");
+    at_sim_set_latency(sim, "AT+CGACT=1,1", 300000, 0, 0);
+    at_obj = bench_obj_create(NULL);
+    if (at_obj == NULL)
+        return 1;
+    bench_start();
+
+    printf("%u commands, poll interval %u ms, modem latency %u us\n", count, poll, conf.resp_delay_us);
+    printf("  %-12s %8s %8s %10s %10s %12s\n", "wait", "failures", "bad", "avg ms", "max ms", "cpu us/cmd");
+    run_load(count, poll);
+    run_load(count, 0);
+    printf("checks:\n");
+    errors = run_checks(sim);
+    printf("%s\n", errors != 0 ? "FAILED" : "ok");
+
+    bench_stop();
+    bench_close(sim);
+    return errors != 0;
+}
@@ -0,0 +1,172 @@
+/******************************************************************************
+ * @brief        URC matching microbenchmark
+ *
+ * URC traffic is fed from memory to at_obj_process (no serial port, no modem), so only
+ * the URC receive path is measured: the prefixes of a URC table of -t items are found
+ * by the Aho-Corasick automaton (AT_URC_MATCHER_EN, urc_bench) or by the linear scan
+ * of the table at each end mark (urc_bench_linear, the same source built with
+ * AT_URC_MATCHER_EN=0). The traffic cycles through the whole table, half of the lines
+ * are unknown to it. The CPU time per received byte is reported, the benchmark fails if
+ * a URC is lost.
+ *
+ * Usage: urc_bench [-t items] [-s size_kb]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_ITEMS 64
+
+static const char *const known[] = {
+    "+QMTRECV:", "+QMTSTAT:", "+QIURC:", "+CREG:", "+CGREG:", "+CEREG:", "+CPIN:", "+QIND:",
+    "+QMTPUBEX:", "+QMTOPEN:", "+QMTCONN:", "+QMTSUB:", "+CMTI:", "+QPING:", "RDY", "+CFUN:",
+};
+
+#define KNOWN_COUNT (int)(sizeof(known) / sizeof(known[0]))
+
+static char prefixes[MAX_ITEMS][16];
+static urc_item_t urc_table[MAX_ITEMS];
+static unsigned int urc_count;
+
+static char *traffic;
+static unsigned int traffic_size, traffic_pos;
+
+static unsigned int feed_read(void *buf, unsigned int len)
+{
+    if (len > traffic_size - traffic_pos)
+        len = traffic_size - traffic_pos;
+    memcpy(buf, traffic + traffic_pos, len);
+    traffic_pos += len;
+    return len;
+}
+
+static unsigned int feed_write(const void *buf, unsigned int len)
+{
+    return len;
+}
+
+static const at_adapter_t adapter = {
+    .lock = at_linux_lock,
+    .unlock = at_linux_unlock,
+    .write = feed_write,
+    .read = feed_read,
+    .urc_bufsize = 256,
+    .recv_bufsize = 256,
+};
+
+static int on_urc(at_urc_info_t *info)
+{
+    urc_count++;
+    return 0;
+}
+
+/**
+ * @brief  Build the URC table, the real EC800M URCs first then generated ones.
+ */
+static void build_table(int items)
+{
+    int i;
+    for (i = 0; i < items; i++)
+    {
+        urc_item_t item = {prefixes[i], '\n', on_urc, NULL, NULL};
+        if (i < KNOWN_COUNT)
+            strcpy(prefixes[i], known[i]);
+        else
+            sprintf(prefixes[i], "+QX%02d:", i);
+        memcpy(&urc_table[i], &item, sizeof(item)); // The members are read-only.
+    }
+}
+
+/**
+ * @brief  Generate the traffic: lines of every table item in turn, each followed by an
+ *         unknown line (such as the echo of other channels or traces).
+ * @return Number of URC lines of the table.
+ */
+static unsigned int build_traffic(int items, unsigned int size)
+{
+    unsigned int lines = 0;
+    int n, i = 0;
+    traffic = malloc(size + 128);
+    if (traffic == NULL)
+        return 0;
+    traffic_size = 0;
+    while (traffic_size < size)
+    {
+        n = sprintf(traffic + traffic_size, "\r\n%s 0,1,\"topic/bench\",16,\"0123456789abcdef\"\r\n", prefixes[i]);
+        n += sprintf(traffic + traffic_size + n, "\r\n+TRACE: %d,unknown line\r\n", i);
+        traffic_size += n;
+        lines++;
+        i = (i + 1) % items;
+    }
+    return lines;
+}
+
+static unsigned long long cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int size = 4096, lines;
+    unsigned long long t0, c0;
+    int items = 16, opt;
+    at_obj_t *at_obj;
+    while ((opt = getopt(argc, argv, "t:s:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            items = atoi(optarg);
+            if (items < 1 || items > MAX_ITEMS)
+                items = 16;
+            break;
+        case 's':
+            size = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-t items] [-s size_kb]\n"
+                    "  -t  Number of items of the URC table (default 16, up to 64)\n"
+                    "  -s  Amount of URC traffic (KB, default 4096)\n",
+                    argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    build_table(items);
+    lines = build_traffic(items, size * 1024);
+    if (lines == 0)
+        return 1;
+    at_obj = at_obj_create(&adapter);
+    if (at_obj == NULL)
+    {
+        fprintf(stderr, "at_obj_create failed\n");
+        return 1;
+    }
+    at_obj_set_urc(at_obj, urc_table, items);
+
+    t0 = bench_now_ns();
+    c0 = cpu_ns();
+    while (traffic_pos < traffic_size)
+        at_obj_process(at_obj);
+    c0 = cpu_ns() - c0;
+    t0 = bench_now_ns() - t0;
+    printf("%s, %d items, %u bytes: %u/%u urcs, %.2f ns/byte, %.0f MB/s\n",
+           AT_URC_MATCHER_EN ? "automaton" : "linear scan", items, traffic_size, urc_count, lines,
+           (double)c0 / traffic_size, traffic_size / (t0 / 1e3));
+
+    at_obj_destroy(at_obj);
+    free(traffic);
+    return urc_count != lines;
+}
@@ -0,0 +1,176 @@
+/******************************************************************************
+ * @brief        Event wakeup latency check against the simulated EC800M
+ *
+ * The same AT thread is run in event mode (at_obj_process_timed + at_linux_wait, woken
+ * by the serial port and by work submission) and in poll mode (processing every
+ * AT_POLL_INTERVAL). The round trip of single commands and the delivery time of
+ * injected URCs are measured in both modes. The check fails if the AT thread is not
+ * woken by the events: the event mode p50 must be at least a quarter of the poll
+ * interval lower than the poll mode p50 of the same run (a busy host slows both modes
+ * alike), for the round trip and for the URC delivery. The p99 only has a generous
+ * limit of 5 poll intervals, it depends on the host scheduling.
+ *
+ * Usage: wakeup_bench [-n samples]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "bench_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define BENCH_URC "\r\n+QMTSTAT: 0,1\r\n"
+
+static at_obj_t *at_obj;
+static unsigned int done_count, fail_count, urc_count;
+
+static const at_adapter_t adapter = {
+    .lock = at_linux_lock,
+    .unlock = at_linux_unlock,
+    .write = at_linux_write,
+    .read = at_linux_read,
+    .notify = at_linux_notify,
+    .urc_bufsize = 128,
+    .recv_bufsize = 256,
+};
+
+static void on_response(at_response_t *r)
+{
+    if (r->code != AT_RESP_OK)
+        fail_count++;
+    bench_count(&done_count);
+}
+
+static int on_qmtstat(at_urc_info_t *info)
+{
+    bench_count(&urc_count);
+    return 0;
+}
+
+/**
+ * @brief Latency percentiles of one mode (us).
+ */
+typedef struct
+{
+    unsigned long long rtt_p50, rtt_p99, urc_p50, urc_p99;
+} mode_result_t;
+
+static const urc_item_t urc_table[] = {
+    {"+QMTSTAT:", '\n', on_qmtstat, NULL, NULL},
+};
+
+static int cmp_ull(const void *a, const void *b)
+{
+    unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * @brief  Measure the command round trip and the URC delivery time in one mode.
+ * @param  us Latency samples (us), 2 x count.
+ */
+static void run_mode(bool poll, unsigned long long *us, unsigned int count, at_sim_t *sim, mode_result_t *res)
+{
+    unsigned long long *urc_us = us + count, t0;
+    at_attr_t attr;
+    unsigned int i;
+    bench_set_poll(poll);
+    usleep(AT_POLL_INTERVAL * 2000); // Let the AT thread enter the new mode.
+    at_attr_deinit(&attr);
+    attr.cb = on_response;
+    attr.prefix = "+CSQ:";
+    attr.retry = 0;
+    done_count = urc_count = 0;
+    for (i = 0; i < count; i++)
+    {
+        usleep(1000 + rand() % 1000); // Start at a random point of the poll period.
+        t0 = bench_now_us();
+        at_exec_cmd(at_obj, &attr, "AT+CSQ");
+        bench_wait_count(&done_count, i + 1, 2000);
+        us[i] = bench_now_us() - t0;
+    }
+    for (i = 0; i < count; i++)
+    {
+        usleep(1000 + rand() % 1000);
+        t0 = bench_now_us();
+        at_sim_inject(sim, BENCH_URC, sizeof(BENCH_URC) - 1);
+        bench_wait_count(&urc_count, i + 1, 2000);
+        urc_us[i] = bench_now_us() - t0;
+    }
+    qsort(us, count, sizeof(*us), cmp_ull);
+    qsort(urc_us, count, sizeof(*urc_us), cmp_ull);
+    res->rtt_p50 = us[count / 2];
+    res->rtt_p99 = us[count * 99 / 100];
+    res->urc_p50 = urc_us[count / 2];
+    res->urc_p99 = urc_us[count * 99 / 100];
+    printf("  %-6s %10.2f %10.2f %10.2f %10.2f\n", poll ? "poll" : "event", res->rtt_p50 / 1e3,
+           res->rtt_p99 / 1e3, res->urc_p50 / 1e3, res->urc_p99 / 1e3);
+}
+
+/**
+ * @brief  Compare the event mode latency to the poll mode one.
+ * @return 1 if the event mode p50 is not lower by the margin or its p99 is over the limit.
+ */
+static int check(const char *name, unsigned long long event_p50, unsigned long long event_p99,
+                 unsigned long long poll_p50)
+{
+    unsigned long long margin = AT_POLL_INTERVAL * 1000ull / 4, p99_limit = AT_POLL_INTERVAL * 5000ull;
+    bool ok = event_p50 + margin <= poll_p50 && event_p99 <= p99_limit;
+    printf("%s: event p50 %.2f ms (limit %.2f), p99 %.2f ms (limit %.2f) %s\n", name, event_p50 / 1e3,
+           poll_p50 > margin ? (poll_p50 - margin) / 1e3 : 0.0, event_p99 / 1e3, p99_limit / 1e3,
+           ok ? "ok" : "FAILED");
+    return !ok;
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {115200, 0, 0, 10, 0, 0};
+    mode_result_t event, poll;
+    unsigned long long *us;
+    unsigned int count = 200, errors;
+    at_sim_t *sim;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            count = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n samples]\n  -n  Commands and URCs measured in each mode (default 200)\n",
+                    argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (count == 0)
+        count = 1;
+    us = calloc(count * 2, sizeof(*us));
+    sim = bench_sim_open("wakeup_bench", &conf);
+    if (us == NULL || sim == NULL)
+        return 1;
+    at_obj = bench_obj_create(&adapter);
+    if (at_obj == NULL)
+        return 1;
+    at_obj_set_urc(at_obj, urc_table, sizeof(urc_table) / sizeof(urc_table[0]));
+    bench_start();
+
+    printf("%u samples, poll interval %d ms, %u baud\n", count, AT_POLL_INTERVAL, conf.baudrate);
+    printf("  %-6s %10s %10s %10s %10s (ms)\n", "mode", "rtt p50", "rtt p99", "urc p50", "urc p99");
+    run_mode(false, us, count, sim, &event);
+    run_mode(true, us, count, sim, &poll);
+    errors = fail_count;
+    errors += check("rtt", event.rtt_p50, event.rtt_p99, poll.rtt_p50);
+    errors += check("urc", event.urc_p50, event.urc_p99, poll.urc_p50);
+    errors += bench_check_pools();
+    printf("%s\n", errors != 0 ? "FAILED" : "ok");
+
+    bench_stop();
+    bench_close(sim);
+    free(us);
+    return errors != 0;
+}
@@ -0,0 +1,942 @@
+/******************************************************************************
+ * @brief        Simulated EC800M modem over a pseudo-terminal
+ *
+ * The modem answers the commands used by this project (ATE0, AT+CIMI, AT+CREG,
+ * AT+CGDCONT, AT+QMTCFG, AT+QMTOPEN, AT+QMTCONN, AT+QMTPUBEX with its '>' prompt...),
+ * extra commands can be scripted. All output is paced at the configured serial rate.
+ *
+ * AT+CMUX=0 switches to the 3GPP 27.010 multiplexer (basic option), each DLCI then has
+ * its own command line state and URCs are sent on conf.urc_dlci.
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "at_sim.h"
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SIM_LINE_MAX 1024
+#define SIM_RULE_MAX 64
+#define SIM_EVENT_MAX 16
+#define SIM_LATENCY_MAX 16
+#define SIM_EVENT_LEN 128
+// Output is written in small chunks so that the pacing resembles a real serial line.
+#define SIM_TX_CHUNK 16
+// The TX line is considered idle when nothing was sent for this time (us).
+#define SIM_IDLE_US 1000
+// Number of DLCIs in CMUX mode (DLCI 0 is the control channel).
+#define SIM_DLC_MAX 8
+// Maximum frame information length sent by the module (N1).
+#define SIM_MUX_N1 127
+// Maximum frame information length accepted from the host.
+#define SIM_MUX_FRAME_MAX 1024
+
+#define MUX_FLAG 0xF9
+#define MUX_EA   0x01
+#define MUX_CR   0x02
+#define MUX_PF   0x10
+#define MUX_SABM 0x2F
+#define MUX_UA   0x63
+#define MUX_DM   0x0F
+#define MUX_DISC 0x43
+#define MUX_UIH  0xEF
+#define MUX_UI   0x03
+#define MUX_MSG_NSC  0x10
+#define MUX_MSG_TEST 0x20
+#define MUX_MSG_CLD  0xC0
+#define MUX_MSG_MSC  0xE0
+
+/**
+ * @brief Scripted response rule.
+ */
+typedef struct
+{
+    char *prefix;
+    char *response;
+} sim_rule_t;
+
+/**
+ * @brief Response latency profile of a command.
+ */
+typedef struct
+{
+    char *prefix;
+    unsigned int delay_us;
+    unsigned int jitter_us;
+    unsigned int drop_permille; /* Commands left unanswered (per mille)*/
+} sim_latency_t;
+
+/**
+ * @brief Delayed output (result URCs).
+ */
+typedef struct
+{
+    unsigned long long due; /* Due time (us), 0: unused*/
+    char text[SIM_EVENT_LEN];
+} sim_event_t;
+
+/**
+ * @brief Command line state of a channel (DLCI 0 outside CMUX mode).
+ */
+typedef struct
+{
+    char line[SIM_LINE_MAX];
+    unsigned int line_len;
+    unsigned int payload_remain; /* Bytes of payload still expected after a '>' prompt*/
+    int skip_lf;                 /* The line just ended with '\r', a following '\n' belongs to it*/
+    char payload_result[SIM_EVENT_LEN];
+    int echo;
+    int open; /* Data link connection established (CMUX mode)*/
+} sim_dlc_t;
+
+struct at_sim
+{
+    at_sim_conf_t conf;
+    int master, slave;
+    char path[64];
+    pthread_t thread;
+    pthread_mutex_t tx_lock;
+    volatile int running;
+    unsigned long long line_free; /* Time (us) when the simulated TX line becomes idle*/
+    sim_dlc_t dlc[SIM_DLC_MAX];
+    int cur;            /* DLCI of the command being processed*/
+    volatile int mux;   /* CMUX mode*/
+    int mux_state;      /* Frame decoder state*/
+    unsigned char mux_hdr[4];
+    unsigned int mux_hlen, mux_len, mux_cnt;
+    unsigned char mux_frame[SIM_MUX_FRAME_MAX];
+    int creg_mode;
+    int mqtt_open;
+    unsigned long long mqtt_ready; /* Time (us) when the MQTT network is open (+QMTOPEN reported)*/
+    unsigned int seed;
+    sim_rule_t rules[SIM_RULE_MAX];
+    int rule_count;
+    sim_latency_t latency[SIM_LATENCY_MAX];
+    int latency_count;
+    sim_event_t events[SIM_EVENT_MAX];
+    at_sim_stat_t stat;
+};
+
+static unsigned long long mono_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+
+static void sleep_until(unsigned long long us)
+{
+    struct timespec ts = {us / 1000000, (us % 1000000) * 1000};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+static void write_all(int fd, const void *buf, size_t len)
+{
+    const unsigned char *p = buf;
+    ssize_t ret;
+    while (len > 0)
+    {
+        ret = write(fd, p, len);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return;
+        p += ret;
+        len -= ret;
+    }
+}
+
+/**
+ * @brief  Write to the line, paced at the configured serial rate (8N1, 10 bits per byte),
+ *         the caller holds tx_lock.
+ */
+static void sim_write(at_sim_t *sim, const void *buf, size_t len)
+{
+    const unsigned char *p = buf;
+    size_t n;
+    unsigned long long now;
+    sim->stat.tx_bytes += len;
+    while (len > 0)
+    {
+        n = len > SIM_TX_CHUNK ? SIM_TX_CHUNK : len;
+        write_all(sim->master, p, n);
+        if (sim->conf.baudrate != 0)
+        {
+            // The line only restarts from now when it has been idle, wakeup latencies of
+            // the pacing sleep must not lower the rate of a continuous transmission.
+            now = mono_us();
+            if (sim->line_free + SIM_IDLE_US < now)
+                sim->line_free = now;
+            sim->line_free += n * 10000000ull / sim->conf.baudrate;
+            sleep_until(sim->line_free);
+        }
+        p += n;
+        len -= n;
+    }
+}
+
+/**
+ * @brief  FCS calculation (CRC-8, bitwise, independent of the table used by the host).
+ */
+static unsigned char mux_crc(unsigned char fcs, const unsigned char *p, size_t len)
+{
+    int i;
+    while (len--)
+    {
+        fcs ^= *p++;
+        for (i = 0; i < 8; i++)
+            fcs = fcs & 1 ? (fcs >> 1) ^ 0xE0 : fcs >> 1;
+    }
+    return fcs;
+}
+
+/**
+ * @brief  Send a CMUX frame (information length <= SIM_MUX_N1), the caller holds tx_lock.
+ */
+static void mux_write_frame(at_sim_t *sim, int dlci, int cr, unsigned char ctrl, const void *data, size_t len)
+{
+    unsigned char frame[SIM_MUX_N1 + 6];
+    unsigned char fcs;
+    frame[0] = MUX_FLAG;
+    frame[1] = (dlci << 2) | (cr ? MUX_CR : 0) | MUX_EA;
+    frame[2] = ctrl;
+    frame[3] = (len << 1) | MUX_EA;
+    if (len > 0)
+        memcpy(&frame[4], data, len);
+    fcs = mux_crc(0xFF, &frame[1], 3);
+    if ((ctrl & ~MUX_PF) == MUX_UI)
+        fcs = mux_crc(fcs, &frame[4], len);
+    frame[4 + len] = 0xFF - fcs;
+    frame[5 + len] = MUX_FLAG;
+    sim_write(sim, frame, len + 6);
+}
+
+/**
+ * @brief  Send data to the host on a channel (DLCI 0: plain serial output).
+ */
+static void sim_send_dlc(at_sim_t *sim, int dlci, const void *buf, size_t len)
+{
+    const unsigned char *p = buf;
+    size_t n;
+    pthread_mutex_lock(&sim->tx_lock);
+    if (!sim->mux)
+        sim_write(sim, buf, len);
+    while (sim->mux && len > 0)
+    {
+        n = len > SIM_MUX_N1 ? SIM_MUX_N1 : len;
+        mux_write_frame(sim, dlci, 0, MUX_UIH, p, n);
+        p += n;
+        len -= n;
+    }
+    pthread_mutex_unlock(&sim->tx_lock);
+}
+
+/**
+ * @brief  Send data on the channel of the command being processed.
+ */
+static void sim_send(at_sim_t *sim, const void *buf, size_t len)
+{
+    sim_send_dlc(sim, sim->cur, buf, len);
+}
+
+/**
+ * @brief  Send URC data (on the URC channel in CMUX mode).
+ */
+static void sim_send_urc(at_sim_t *sim, const void *buf, size_t len)
+{
+    sim_send_dlc(sim, sim->conf.urc_dlci > 0 && sim->conf.urc_dlci < SIM_DLC_MAX ? sim->conf.urc_dlci : 1,
+                 buf, len);
+}
+
+static void sim_printf(at_sim_t *sim, const char *fmt, ...)
+{
+    char buf[SIM_LINE_MAX];
+    va_list args;
+    int len;
+    va_start(args, fmt);
+    len = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (len > (int)sizeof(buf) - 1)
+        len = sizeof(buf) - 1;
+    if (len > 0)
+        sim_send(sim, buf, len);
+}
+
+/**
+ * @brief  Schedule a delayed output.
+ */
+static void sim_schedule(at_sim_t *sim, unsigned int delay_ms, const char *fmt, ...)
+{
+    va_list args;
+    int i;
+    for (i = 0; i < SIM_EVENT_MAX; i++)
+    {
+        if (sim->events[i].due == 0)
+        {
+            va_start(args, fmt);
+            vsnprintf(sim->events[i].text, SIM_EVENT_LEN, fmt, args);
+            va_end(args);
+            sim->events[i].due = mono_us() + delay_ms * 1000ull + 1;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief  Emit the due delayed outputs.
+ * @return Time (ms) until the next delayed output, -1 if there is none.
+ */
+static int sim_run_events(at_sim_t *sim)
+{
+    unsigned long long now = mono_us(), next = 0;
+    int i;
+    for (i = 0; i < SIM_EVENT_MAX; i++)
+    {
+        if (sim->events[i].due == 0)
+            continue;
+        if (sim->events[i].due <= now)
+        {
+            sim_send_urc(sim, sim->events[i].text, strlen(sim->events[i].text));
+            sim->events[i].due = 0;
+        }
+        else if (next == 0 || sim->events[i].due < next)
+        {
+            next = sim->events[i].due;
+        }
+    }
+    return next == 0 ? -1 : (int)((next - now + 999) / 1000);
+}
+
+/**
+ * @brief  Get the n-th (from 0) comma separated integer parameter of a command.
+ */
+static int sim_param(const char *line, int n)
+{
+    const char *p = strchr(line, '=');
+    if (p == NULL)
+        return 0;
+    for (p++; n > 0 && p != NULL; n--)
+    {
+        p = strchr(p, ',');
+        if (p)
+            p++;
+    }
+    return p ? atoi(p) : 0;
+}
+
+static int sim_last_param(const char *line)
+{
+    const char *p = strrchr(line, ',');
+    return p ? atoi(p + 1) : 0;
+}
+
+static int starts_with(const char *s, const char *prefix)
+{
+    return strncasecmp(s, prefix, strlen(prefix)) == 0;
+}
+
+/**
+ * @brief  Simulate the command processing latency (the latency profile of the command, or 
+ *         the configured one).
+ * @return 0 - the command is answered, -1 - it is dropped.
+ */
+static int sim_latency(at_sim_t *sim, const char *cmd)
+{
+    unsigned int us = sim->conf.resp_delay_us, jitter = sim->conf.resp_jitter_us;
+    int i;
+    for (i = 0; i < sim->latency_count; i++)
+    {
+        if (starts_with(cmd, sim->latency[i].prefix))
+        {
+            if ((unsigned int)(rand_r(&sim->seed) % 1000) < sim->latency[i].drop_permille)
+                return -1;
+            us = sim->latency[i].delay_us;
+            jitter = sim->latency[i].jitter_us;
+            break;
+        }
+    }
+    if (jitter)
+        us += rand_r(&sim->seed) % jitter;
+    if (us)
+        sleep_until(mono_us() + us);
+    return 0;
+}
+
+/**
+ * @brief  Built-in command handling of the EC800M.
+ */
+static void sim_builtin(at_sim_t *sim, const char *cmd)
+{
+    sim_dlc_t *dlc = &sim->dlc[sim->cur];
+    unsigned int delay = sim->conf.result_delay_ms;
+    if (strcasecmp(cmd, "AT") == 0)
+        sim_printf(sim, "\r\nOK\r\n");
+    else if (strcasecmp(cmd, "ATE0") == 0 || strcasecmp(cmd, "ATE1") == 0)
+    {
+        dlc->echo = cmd[3] == '1';
+        sim_printf(sim, "\r\nOK\r\n");
+    }
+    else if (starts_with(cmd, "AT+CMUX=") && !sim->mux && sim_param(cmd, 0) == 0)
+    {
+        sim_printf(sim, "\r\nOK\r\n");
+        pthread_mutex_lock(&sim->tx_lock);
+        memset(sim->dlc, 0, sizeof(sim->dlc));
+        sim->mux_state = 0;
+        sim->mux = 1;
+        pthread_mutex_unlock(&sim->tx_lock);
+    }
+    else if (strcasecmp(cmd, "AT+CIMI") == 0)
+        sim_printf(sim, "\r\n460040123456789\r\n\r\nOK\r\n");
+    else if (strcasecmp(cmd, "AT+CSQ") == 0)
+        sim_printf(sim, "\r\n+CSQ: 24,99\r\n\r\nOK\r\n");
+    else if (strcasecmp(cmd, "AT+CREG?") == 0)
+        sim_printf(sim, "\r\n+CREG: %d,1\r\n\r\nOK\r\n", sim->creg_mode);
+    else if (starts_with(cmd, "AT+CREG="))
+    {
+        sim->creg_mode = sim_param(cmd, 0);
+        sim_printf(sim, "\r\nOK\r\n");
+        if (sim->creg_mode)
+            sim_schedule(sim, delay, "\r\n+CREG: 1\r\n");
+    }
+    else if (strcasecmp(cmd, "AT+CGATT?") == 0)
+        sim_printf(sim, "\r\n+CGATT: 1\r\n\r\nOK\r\n");
+    else if (starts_with(cmd, "AT+CGDCONT=") || starts_with(cmd, "AT+CGACT=") ||
+             starts_with(cmd, "AT+QMTCFG="))
+        sim_printf(sim, "\r\nOK\r\n");
+    else if (strcasecmp(cmd, "AT+QMTOPEN=?") == 0)
+        sim_printf(sim, "\r\n+QMTOPEN: (0-5),\"hostname\",(1-65535)\r\n\r\nOK\r\n");
+    else if (strcasecmp(cmd, "AT+QMTOPEN?") == 0)
+    {
+        if (sim->mqtt_open)
+            sim_printf(sim, "\r\n+QMTOPEN: 0,\"iot.example.com\",1883\r\n");
+        sim_printf(sim, "\r\nOK\r\n");
+    }
+    else if (starts_with(cmd, "AT+QMTOPEN="))
+    {
+        sim->mqtt_open = 1;
+        sim->mqtt_ready = mono_us() + delay * 1000ull;
+        sim_printf(sim, "\r\nOK\r\n");
+        sim_schedule(sim, delay, "\r\n+QMTOPEN: %d,0\r\n", sim_param(cmd, 0));
+    }
+    else if (starts_with(cmd, "AT+QMTCONN=") && (!sim->mqtt_open || mono_us() < sim->mqtt_ready))
+        sim_printf(sim, "\r\nERROR\r\n"); // The network is not open yet.
+    else if (starts_with(cmd, "AT+QMTCONN="))
+    {
+        sim_printf(sim, "\r\nOK\r\n");
+        sim_schedule(sim, delay, "\r\n+QMTCONN: %d,0,0\r\n", sim_param(cmd, 0));
+    }
+    else if (starts_with(cmd, "AT+QMTSUB="))
+    {
+        sim_printf(sim, "\r\nOK\r\n");
+        sim_schedule(sim, delay, "\r\n+QMTSUB: %d,%d,0,0\r\n", sim_param(cmd, 0), sim_param(cmd, 1));
+    }
+    else if (starts_with(cmd, "AT+QMTPUBEX="))
+    {
+        dlc->payload_remain = sim_last_param(cmd);
+        snprintf(dlc->payload_result, sizeof(dlc->payload_result), "\r\n+QMTPUBEX: %d,%d,0\r\n",
+                 sim_param(cmd, 0), sim_param(cmd, 1));
+        sim_printf(sim, "\r\n> ");
+    }
+    else if (starts_with(cmd, "AT+QPOWD"))
+        sim_printf(sim, "\r\nOK\r\n\r\nPOWERED DOWN\r\n");
+    else
+        sim_printf(sim, "\r\nERROR\r\n");
+}
+
+static void sim_handle_line(at_sim_t *sim, const char *cmd)
+{
+    int i;
+    if (*cmd == '\0')
+        return;
+    sim->stat.commands++;
+    if (sim_latency(sim, cmd) != 0)
+    {
+        sim->stat.dropped++;
+        return;
+    }
+    for (i = 0; i < sim->rule_count; i++)
+    {
+        if (starts_with(cmd, sim->rules[i].prefix))
+        {
+            sim_send(sim, sim->rules[i].response, strlen(sim->rules[i].response));
+            return;
+        }
+    }
+    sim_builtin(sim, cmd);
+}
+
+static void sim_mux_input(at_sim_t *sim, const unsigned char *buf, size_t len);
+
+/**
+ * @brief  Command line input of a channel.
+ */
+static void sim_dlc_input(at_sim_t *sim, int dlci, const unsigned char *buf, size_t len)
+{
+    sim_dlc_t *dlc = &sim->dlc[dlci];
+    size_t i;
+    sim->cur = dlci;
+    for (i = 0; i < len; i++)
+    {
+        if (dlc->skip_lf)
+        { // The "\r\n" ending a command line, the payload starts after it.
+            dlc->skip_lf = 0;
+            if (buf[i] == '\n')
+            {
+                if (dlc->echo)
+                    sim_send(sim, &buf[i], 1);
+                continue;
+            }
+        }
+        if (dlc->payload_remain > 0)
+        { // Payload after the '>' prompt.
+            if (--dlc->payload_remain == 0)
+            {
+                sim_printf(sim, "\r\nOK\r\n");
+                sim_schedule(sim, sim->conf.result_delay_ms, "%s", dlc->payload_result);
+            }
+            continue;
+        }
+        if (dlc->echo)
+            sim_send(sim, &buf[i], 1);
+        if (buf[i] == '\r')
+        {
+            dlc->line[dlc->line_len] = '\0';
+            sim_handle_line(sim, dlc->line);
+            dlc->line_len = 0;
+            dlc->skip_lf = 1;
+            if (dlci == 0 && sim->mux)
+            { // AT+CMUX: the rest is framed.
+                sim_mux_input(sim, &buf[i + 1], len - i - 1);
+                return;
+            }
+        }
+        else if (buf[i] != '\n' && dlc->line_len < SIM_LINE_MAX - 1)
+        {
+            dlc->line[dlc->line_len++] = buf[i];
+        }
+    }
+}
+
+/**
+ * @brief  Leave CMUX mode, the module returns to plain AT commands.
+ */
+static void sim_mux_exit(at_sim_t *sim)
+{
+    pthread_mutex_lock(&sim->tx_lock);
+    sim->mux = 0;
+    memset(sim->dlc, 0, sizeof(sim->dlc));
+    sim->dlc[0].echo = sim->conf.echo;
+    pthread_mutex_unlock(&sim->tx_lock);
+}
+
+/**
+ * @brief  Reply to a control channel message.
+ */
+static void sim_mux_reply(at_sim_t *sim, unsigned char type, const unsigned char *value, size_t len)
+{
+    unsigned char msg[2 + 8];
+    msg[0] = type | MUX_EA; // Response: C/R cleared.
+    msg[1] = (len << 1) | MUX_EA;
+    if (len > 0)
+        memcpy(&msg[2], value, len);
+    pthread_mutex_lock(&sim->tx_lock);
+    mux_write_frame(sim, 0, 0, MUX_UIH, msg, len + 2);
+    pthread_mutex_unlock(&sim->tx_lock);
+}
+
+/**
+ * @brief  Control channel messages (DLCI 0).
+ */
+static void sim_mux_control(at_sim_t *sim, const unsigned char *msg, size_t len)
+{
+    unsigned char type;
+    size_t vlen;
+    if (len < 2 || !(msg[0] & MUX_CR)) // Responses are ignored.
+        return;
+    type = msg[0] & ~(MUX_CR | MUX_EA);
+    vlen = msg[1] >> 1;
+    if (vlen + 2 > len || vlen > 8)
+        return;
+    if (type == MUX_MSG_CLD)
+    {
+        sim_mux_reply(sim, type, NULL, 0);
+        sim_mux_exit(sim);
+    }
+    else if (type == MUX_MSG_MSC || type == MUX_MSG_TEST)
+        sim_mux_reply(sim, type, &msg[2], vlen);
+    else
+        sim_mux_reply(sim, MUX_MSG_NSC, msg, 1);
+}
+
+/**
+ * @brief  Received frame processing.
+ */
+static void sim_mux_frame(at_sim_t *sim)
+{
+    int dlci = sim->mux_hdr[0] >> 2;
+    unsigned char ctrl = sim->mux_hdr[1] & ~MUX_PF, reply = 0;
+    if (dlci >= SIM_DLC_MAX)
+        reply = MUX_DM;
+    else if (ctrl == MUX_SABM)
+    {
+        memset(&sim->dlc[dlci], 0, sizeof(sim_dlc_t));
+        sim->dlc[dlci].echo = sim->conf.echo;
+        sim->dlc[dlci].open = 1;
+        reply = MUX_UA;
+    }
+    else if (ctrl == MUX_DISC)
+    {
+        reply = sim->dlc[dlci].open ? MUX_UA : MUX_DM;
+        sim->dlc[dlci].open = 0;
+    }
+    else if ((ctrl == MUX_UIH || ctrl == MUX_UI) && sim->dlc[dlci].open)
+    {
+        if (dlci == 0)
+            sim_mux_control(sim, sim->mux_frame, sim->mux_len);
+        else
+            sim_dlc_input(sim, dlci, sim->mux_frame, sim->mux_len);
+    }
+    else
+        reply = MUX_DM;
+    if (reply != 0 && sim->mux)
+    {
+        pthread_mutex_lock(&sim->tx_lock);
+        mux_write_frame(sim, dlci, 1, reply | MUX_PF, NULL, 0);
+        pthread_mutex_unlock(&sim->tx_lock);
+    }
+    if (dlci == 0 && ctrl == MUX_DISC)
+        sim_mux_exit(sim);
+}
+
+/**
+ * @brief  CMUX frame decoding.
+ */
+static void sim_mux_input(at_sim_t *sim, const unsigned char *buf, size_t len)
+{
+    unsigned char fcs, b;
+    size_t i;
+    for (i = 0; i < len; i++)
+    {
+        if (!sim->mux)
+        { // Closed down: the rest is plain input.
+            sim_dlc_input(sim, 0, &buf[i], len - i);
+            return;
+        }
+        b = buf[i];
+        switch (sim->mux_state)
+        {
+        case 0: // Opening flag
+            if (b == MUX_FLAG)
+                sim->mux_state = 1;
+            break;
+        case 1: // Address
+            if (b != MUX_FLAG)
+            {
+                sim->mux_hdr[0] = b;
+                sim->mux_state = 2;
+            }
+            break;
+        case 2: // Control
+            sim->mux_hdr[1] = b;
+            sim->mux_state = 3;
+            break;
+        case 3: // Length
+        case 4:
+            sim->mux_hdr[sim->mux_state - 1] = b;
+            sim->mux_hlen = sim->mux_state;
+            if (sim->mux_state == 3)
+                sim->mux_len = b >> 1;
+            else
+                sim->mux_len |= b << 7;
+            if (sim->mux_state == 3 && !(b & MUX_EA))
+                sim->mux_state = 4;
+            else if (sim->mux_len > SIM_MUX_FRAME_MAX)
+            {
+                sim->stat.bad_frames++;
+                sim->mux_state = 0;
+            }
+            else
+            {
+                sim->mux_cnt = 0;
+                sim->mux_state = sim->mux_len > 0 ? 5 : 6;
+            }
+            break;
+        case 5: // Information
+            sim->mux_frame[sim->mux_cnt++] = b;
+            if (sim->mux_cnt == sim->mux_len)
+                sim->mux_state = 6;
+            break;
+        case 6: // FCS
+            fcs = mux_crc(0xFF, sim->mux_hdr, sim->mux_hlen);
+            if ((sim->mux_hdr[1] & ~MUX_PF) == MUX_UI)
+                fcs = mux_crc(fcs, sim->mux_frame, sim->mux_len);
+            if (mux_crc(fcs, &b, 1) == 0xCF)
+                sim->mux_state = 7;
+            else
+            {
+                sim->stat.bad_frames++;
+                sim->mux_state = 0;
+            }
+            break;
+        default: // Closing flag
+            if (b == MUX_FLAG)
+            {
+                sim->mux_state = 1;
+                sim_mux_frame(sim);
+            }
+            else
+            {
+                sim->stat.bad_frames++;
+                sim->mux_state = 0;
+            }
+            break;
+        }
+    }
+}
+
+static void sim_input(at_sim_t *sim, const unsigned char *buf, size_t len)
+{
+    sim->stat.rx_bytes += len;
+    if (sim->mux)
+        sim_mux_input(sim, buf, len);
+    else
+        sim_dlc_input(sim, 0, buf, len);
+}
+
+static void *sim_thread(void *arg)
+{
+    at_sim_t *sim = arg;
+    struct pollfd pfd;
+    unsigned char buf[256];
+    ssize_t len;
+    int timeout;
+    while (sim->running)
+    {
+        timeout = sim_run_events(sim);
+        pfd.fd = sim->master;
+        pfd.events = POLLIN;
+        // Wake up periodically to check the running flag.
+        if (poll(&pfd, 1, timeout < 0 || timeout > 100 ? 100 : timeout) <= 0)
+            continue;
+        len = read(sim->master, buf, sizeof(buf));
+        if (len > 0)
+            sim_input(sim, buf, len);
+    }
+    return NULL;
+}
+
+/**
+ * @brief  Create a simulated modem on a new pseudo-terminal.
+ * @param  conf Configuration, NULL to use the default (unpaced, no latency, echo on).
+ * @return Simulator, NULL on failure.
+ */
+at_sim_t *at_sim_create(const at_sim_conf_t *conf)
+{
+    struct termios tio;
+    at_sim_t *sim = calloc(1, sizeof(at_sim_t));
+    if (sim == NULL)
+        return NULL;
+    if (conf != NULL)
+        sim->conf = *conf;
+    else
+        sim->conf.echo = 1;
+    sim->dlc[0].echo = sim->conf.echo;
+    sim->seed = (unsigned int)mono_us();
+    pthread_mutex_init(&sim->tx_lock, NULL);
+    sim->master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (sim->master < 0 || grantpt(sim->master) != 0 || unlockpt(sim->master) != 0 ||
+        ptsname_r(sim->master, sim->path, sizeof(sim->path)) != 0)
+        goto fail;
+    // Keep a slave descriptor open, so that the pty survives the host reopening it, and
+    // switch it to raw mode before the host connects (no echo, no line discipline).
+    sim->slave = open(sim->path, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (sim->slave < 0)
+        goto fail;
+    if (tcgetattr(sim->slave, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(sim->slave, TCSANOW, &tio);
+    }
+    sim->running = 1;
+    if (pthread_create(&sim->thread, NULL, sim_thread, sim) != 0)
+        goto fail;
+    return sim;
+fail:
+    if (sim->master >= 0)
+        close(sim->master);
+    free(sim);
+    return NULL;
+}
+
+/**
+ * @brief  Stop and destroy the simulator.
+ */
+void at_sim_destroy(at_sim_t *sim)
+{
+    int i;
+    sim->running = 0;
+    pthread_join(sim->thread, NULL);
+    close(sim->slave);
+    close(sim->master);
+    for (i = 0; i < sim->rule_count; i++)
+    {
+        free(sim->rules[i].prefix);
+        free(sim->rules[i].response);
+    }
+    for (i = 0; i < sim->latency_count; i++)
+        free(sim->latency[i].prefix);
+    pthread_mutex_destroy(&sim->tx_lock);
+    free(sim);
+}
+
+/**
+ * @brief  Get the path of the serial device (pty slave) the host should open.
+ */
+const char *at_sim_path(at_sim_t *sim)
+{
+    return sim->path;
+}
+
+/**
+ * @brief  Add a scripted response, it takes precedence over the built-in commands.
+ * @param  prefix   Command prefix (case insensitive)
+ * @param  response Raw response text (including "\r\n"), "" for no response
+ * @return 0 - success, -1 - the rule table is full.
+ * @note   Rules must be added before the host starts sending commands.
+ */
+int at_sim_add_rule(at_sim_t *sim, const char *prefix, const char *response)
+{
+    if (sim->rule_count >= SIM_RULE_MAX)
+        return -1;
+    sim->rules[sim->rule_count].prefix = strdup(prefix);
+    sim->rules[sim->rule_count].response = strdup(response);
+    sim->rule_count++;
+    return 0;
+}
+
+/**
+ * @brief  Set the response latency of a command, it replaces the configured latency.
+ * @param  prefix        Command prefix (case insensitive)
+ * @param  delay_us      Response latency
+ * @param  jitter_us     Additional random response latency (0 ~ jitter)
+ * @param  drop_permille Commands left unanswered (per mille)
+ * @return 0 - success, -1 - the profile table is full.
+ * @note   Profiles must be added before the host starts sending commands.
+ */
+int at_sim_set_latency(at_sim_t *sim, const char *prefix, unsigned int delay_us, unsigned int jitter_us,
+                       unsigned int drop_permille)
+{
+    sim_latency_t *l;
+    if (sim->latency_count >= SIM_LATENCY_MAX)
+        return -1;
+    l = &sim->latency[sim->latency_count++];
+    l->prefix = strdup(prefix);
+    l->delay_us = delay_us;
+    l->jitter_us = jitter_us;
+    l->drop_permille = drop_permille;
+    return 0;
+}
+
+/**
+ * @brief  Convert the escapes \r \n \t \\ in place.
+ */
+static void unescape(char *s)
+{
+    char *d = s;
+    for (; *s; s++)
+    {
+        if (*s == '\\' && s[1] != '\0')
+        {
+            s++;
+            *d++ = *s == 'r' ? '\r' : *s == 'n' ? '\n' : *s == 't' ? '\t' : *s;
+        }
+        else
+        {
+            *d++ = *s;
+        }
+    }
+    *d = '\0';
+}
+
+/**
+ * @brief  Load scripted responses from a file.
+ *         Each line: <command prefix><TAB><response>, the response supports the escapes
+ *         \r \n \t \\, lines starting with '#' are comments.
+ * @return Number of rules loaded, -1 if the file cannot be opened.
+ */
+int at_sim_load_script(at_sim_t *sim, const char *path)
+{
+    char line[SIM_LINE_MAX], *tab;
+    int count = 0;
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+        return -1;
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '#' || (tab = strchr(line, '\t')) == NULL)
+            continue;
+        *tab = '\0';
+        unescape(tab + 1);
+        if (at_sim_add_rule(sim, line, tab + 1) == 0)
+            count++;
+    }
+    fclose(fp);
+    return count;
+}
+
+/**
+ * @brief  Emit a burst of URCs (blocking, called from the caller's thread).
+ * @param  urc         URC text (including "\r\n")
+ * @param  count       Number of URCs
+ * @param  interval_us Interval between two URCs, 0 for back to back (limited only by the
+ *                     serial rate)
+ */
+void at_sim_urc_storm(at_sim_t *sim, const char *urc, unsigned int count, unsigned int interval_us)
+{
+    size_t len = strlen(urc);
+    unsigned long long next = mono_us();
+    while (count--)
+    {
+        sim_send_urc(sim, urc, len);
+        __atomic_add_fetch(&sim->stat.urcs, 1, __ATOMIC_RELAXED);
+        if (interval_us)
+        {
+            next += interval_us;
+            sleep_until(next);
+        }
+    }
+}
+
+/**
+ * @brief  Send raw data to the host (such as a URC with a binary payload), on the URC
+ *         channel in CMUX mode.
+ */
+void at_sim_inject(at_sim_t *sim, const void *data, unsigned int len)
+{
+    sim_send_urc(sim, data, len);
+}
+
+/**
+ * @brief  Get the simulator statistics.
+ */
+void at_sim_get_stat(at_sim_t *sim, at_sim_stat_t *stat)
+{
+    pthread_mutex_lock(&sim->tx_lock);
+    *stat = sim->stat;
+    pthread_mutex_unlock(&sim->tx_lock);
+}
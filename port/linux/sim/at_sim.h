@@ -0,0 +1,69 @@
+/******************************************************************************
+ * @brief        Simulated EC800M modem over a pseudo-terminal
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#ifndef __AT_SIM_H__
+#define __AT_SIM_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Simulator configuration.
+ */
+typedef struct
+{
+    unsigned int baudrate;       /* Serial rate used to pace the modem output (0: no pacing)*/
+    unsigned int resp_delay_us;  /* Response latency of every command*/
+    unsigned int resp_jitter_us; /* Additional random response latency (0 ~ jitter)*/
+    unsigned int result_delay_ms;/* Delay of result URCs such as +QMTOPEN/+QMTCONN*/
+    int echo;                    /* Initial command echo state (ATE0/ATE1)*/
+    int urc_dlci;                /* Channel of the URCs in CMUX mode (0: DLCI 1)*/
+} at_sim_conf_t;
+
+/**
+ * @brief Simulator statistics.
+ */
+typedef struct
+{
+    unsigned long commands;      /* Command lines received*/
+    unsigned long rx_bytes;      /* Bytes received from the host*/
+    unsigned long tx_bytes;      /* Bytes sent to the host*/
+    unsigned long urcs;          /* URCs emitted by at_sim_urc_storm*/
+    unsigned long bad_frames;    /* CMUX frames discarded (bad FCS or length)*/
+    unsigned long dropped;       /* Commands left unanswered (latency profile drop rate)*/
+} at_sim_stat_t;
+
+typedef struct at_sim at_sim_t;
+
+at_sim_t *at_sim_create(const at_sim_conf_t *conf);
+
+void at_sim_destroy(at_sim_t *sim);
+
+const char *at_sim_path(at_sim_t *sim);
+
+int at_sim_add_rule(at_sim_t *sim, const char *prefix, const char *response);
+
+int at_sim_load_script(at_sim_t *sim, const char *path);
+
+int at_sim_set_latency(at_sim_t *sim, const char *prefix, unsigned int delay_us, unsigned int jitter_us,
+                       unsigned int drop_permille);
+
+void at_sim_urc_storm(at_sim_t *sim, const char *urc, unsigned int count, unsigned int interval_us);
+
+void at_sim_inject(at_sim_t *sim, const void *data, unsigned int len);
+
+void at_sim_get_stat(at_sim_t *sim, at_sim_stat_t *stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
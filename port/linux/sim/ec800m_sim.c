@@ -0,0 +1,114 @@
+/******************************************************************************
+ * @brief        Standalone EC800M simulator, prints the pty path to connect to
+ *
+ * Usage: ec800m_sim [-b baudrate] [-d delay_us] [-j jitter_us] [-r result_delay_ms]
+ *                   [-s script] [-u urc -n count -i interval_us] [-c urc_dlci]
+ *
+ * SPDX-License-Identifier: Apathe-2.0
+ *
+ * Change Logs:
+ * Date           Author        Notes
+ * 2026-10-16     missing-shell Initial version
+ ******************************************************************************/
+#include "at_sim.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t quit;
+
+static void on_signal(int sig)
+{
+    quit = 1;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-b baudrate] [-d delay_us] [-j jitter_us] [-r result_delay_ms]\n"
+            "          [-s script] [-u urc -n count -i interval_us] [-c urc_dlci]\n"
+            "  -b  Serial rate used to pace the output (default 115200, 0: no pacing)\n"
+            "  -d  Response latency of every command\n"
+            "  -j  Additional random response latency\n"
+            "  -r  Delay of result URCs such as +QMTOPEN (default 100)\n"
+            "  -s  Script file, each line: <command prefix><TAB><response>\n"
+            "  -u  URC emitted periodically (such as \"+QMTRECV: 0,1,\\\"t\\\",\\\"x\\\"\")\n"
+            "  -n  Number of URCs per burst (default 1)\n"
+            "  -i  Interval between two bursts (us, default 1000000)\n"
+            "  -c  Channel of the URCs after AT+CMUX=0 (default DLCI 1)\n",
+            name);
+}
+
+int main(int argc, char *argv[])
+{
+    at_sim_conf_t conf = {115200, 0, 0, 100, 1, 1};
+    const char *script = NULL, *urc = NULL;
+    unsigned int count = 1, interval = 1000000;
+    char urcline[256];
+    at_sim_t *sim;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:d:j:r:s:u:n:i:c:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            conf.baudrate = strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            conf.resp_delay_us = strtoul(optarg, NULL, 0);
+            break;
+        case 'j':
+            conf.resp_jitter_us = strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            conf.result_delay_ms = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            script = optarg;
+            break;
+        case 'u':
+            urc = optarg;
+            break;
+        case 'n':
+            count = strtoul(optarg, NULL, 0);
+            break;
+        case 'i':
+            interval = strtoul(optarg, NULL, 0);
+            break;
+        case 'c':
+            conf.urc_dlci = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    sim = at_sim_create(&conf);
+    if (sim == NULL)
+    {
+        perror("at_sim_create");
+        return 1;
+    }
+    if (script != NULL && at_sim_load_script(sim, script) < 0)
+    {
+        perror(script);
+        at_sim_destroy(sim);
+        return 1;
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    printf("%s\n", at_sim_path(sim));
+    fflush(stdout);
+    if (urc != NULL)
+        snprintf(urcline, sizeof(urcline), "\r\n%s\r\n", urc);
+    while (!quit)
+    {
+        if (urc != NULL)
+            at_sim_urc_storm(sim, urcline, count, 0);
+        usleep(urc != NULL ? interval : 100000);
+    }
+    at_sim_destroy(sim);
+    return 0;
+}